@@ -0,0 +1,587 @@
+/*
+ * Copyright (c) 2011, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ * Written by: Derek Kulinski <takeda@takeda.tk>
+ *             Jeff Burke <jburke@ucla.edu>
+ */
+
+/*
+ * archive.c - append only Data store with a sorted name index
+ *
+ * An archive is two files: <path> holds encoded ContentObjects back to back
+ * and <path>.idx an index_header followed by archive_entry records sorted
+ * by name, in native byte order. Names are compared where they sit in the
+ * data file, which is mapped read only, so lookups don't copy anything and
+ * a matching packet can be handed to ndn_put() straight from the mapping.
+ *
+ * The index is rewritten (through a temporary file and rename()) by
+ * archive_flush(). Data appended after the last flush is found again when
+ * the archive is opened, a partially written packet at the end of the data
+ * file is cut off. An index whose entries don't fit the data file or aren't
+ * sorted is thrown away and rebuilt from the data file.
+ */
+
+#include <ndn/ndn.h>
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "archive.h"
+
+#define INDEX_MAGIC "NDNAIDX1"
+#define MAP_MIN_SIZE (1 << 20)
+
+struct index_header {
+	char magic[8];
+	uint32_t entry_size;            /* sizeof(struct archive_entry) */
+	uint32_t reserved;
+	uint64_t count;
+	uint64_t data_size;             /* bytes of the data file indexed */
+};
+
+struct archive_entry {
+	uint64_t offset;                /* of the ContentObject */
+	uint32_t size;
+	uint16_t name_start;            /* Name element, relative to offset */
+	uint16_t name_size;
+};
+
+struct archive {
+	char *path, *index_path;
+	int fd;
+	uint64_t data_size;
+
+	/*
+	 * The mapping is larger than the file, so appended packets become
+	 * visible without mapping again; nothing past data_size is touched
+	 */
+	const unsigned char *map;
+	size_t map_size;
+
+	struct archive_entry *entries;
+	size_t n, limit;
+	int dirty;
+};
+
+static inline const unsigned char *
+entry_name(const struct archive *a, const struct archive_entry *e,
+		size_t *size)
+{
+	*size = e->name_size;
+	return a->map + e->offset + e->name_start;
+}
+
+/* first entry whose name doesn't sort before name (after it if upper) */
+static size_t
+bound(const struct archive *a, const unsigned char *name, size_t size,
+		int upper)
+{
+	const unsigned char *ename;
+	size_t lo = 0, hi = a->n, mid, esize;
+	int r;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		ename = entry_name(a, &a->entries[mid], &esize);
+
+		r = ndn_compare_names(ename, esize, name, size);
+		if (r < 0 || (upper && r == 0))
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/* see content_index.c, the closing tag of the prefix is left out */
+static inline int
+has_prefix(const unsigned char *name, size_t size,
+		const unsigned char *prefix, size_t prefix_size)
+{
+	assert(prefix_size > 0);
+
+	return size >= prefix_size &&
+			!memcmp(name, prefix, prefix_size - 1);
+}
+
+/* makes sure the first data_size bytes of the data file are mapped */
+static int
+map_data(struct archive *a)
+{
+	size_t size;
+	void *p;
+
+	if (a->data_size <= a->map_size)
+		return 0;
+
+	for (size = MAP_MIN_SIZE; size < a->data_size; size *= 2)
+		;
+
+	p = mmap(NULL, size, PROT_READ, MAP_SHARED, a->fd, 0);
+	if (p == MAP_FAILED)
+		return -1;
+
+	if (a->map)
+		munmap((void *) a->map, a->map_size);
+
+	a->map = p;
+	a->map_size = size;
+
+	return 0;
+}
+
+/* name is the Name element of the entry, wherever it currently is */
+static int
+index_insert(struct archive *a, const struct archive_entry *entry,
+		const unsigned char *name)
+{
+	struct archive_entry *p;
+	size_t i;
+
+	if (a->n == a->limit) {
+		size_t limit = a->limit ? a->limit * 2 : 64;
+
+		p = realloc(a->entries, limit * sizeof(*p));
+		if (!p)
+			return -1;
+
+		a->entries = p;
+		a->limit = limit;
+	}
+
+	/* equal names keep their insertion order */
+	i = bound(a, name, entry->name_size, 1);
+
+	memmove(&a->entries[i + 1], &a->entries[i],
+			(a->n - i) * sizeof(*a->entries));
+	a->entries[i] = *entry;
+	a->n++;
+	a->dirty = 1;
+
+	return 0;
+}
+
+/*
+ * Returns 0, -1 if co isn't a ContentObject and -2 if it is too large for
+ * archive_entry to describe
+ */
+static int
+make_entry(const unsigned char *co, size_t size, uint64_t offset,
+		struct archive_entry *entry)
+{
+	struct ndn_parsed_ContentObject pco;
+	size_t name_start, name_size;
+	int r;
+
+	r = ndn_parse_ContentObject(co, size, &pco, NULL);
+	if (r < 0)
+		return -1;
+
+	name_start = pco.offset[NDN_PCO_B_Name];
+	name_size = pco.offset[NDN_PCO_E_Name] - pco.offset[NDN_PCO_B_Name];
+	if (size > UINT32_MAX || name_start > UINT16_MAX ||
+			name_size > UINT16_MAX)
+		return -2;
+
+	entry->offset = offset;
+	entry->size = size;
+	entry->name_start = name_start;
+	entry->name_size = name_size;
+
+	return 0;
+}
+
+/* whether an entry read from the index fits in data_size bytes of data */
+static int
+entry_valid(const struct archive_entry *e, uint64_t data_size)
+{
+	return e->offset < data_size && e->size <= data_size - e->offset &&
+			e->name_size >= 2 &&
+			(uint32_t) e->name_start + e->name_size <= e->size;
+}
+
+/*
+ * Indexes whatever follows data_size in the data file, cutting off the
+ * first thing which isn't a complete ContentObject
+ */
+static int
+recover(struct archive *a, uint64_t file_size)
+{
+	struct ndn_skeleton_decoder d;
+	struct archive_entry entry;
+	const unsigned char *p;
+	uint64_t start;
+	int r;
+
+	if (file_size == a->data_size)
+		return 0;
+
+	start = a->data_size;
+	a->data_size = file_size;
+	r = map_data(a);
+	if (r < 0)
+		return -1;
+
+	p = a->map + start;
+	memset(&d, 0, sizeof(d));
+
+	while (start + d.index < file_size) {
+		ndn_skeleton_decode(&d, p + d.index, file_size - start - d.index);
+		if (d.state < 0 || !NDN_FINAL_DSTATE(d.state))
+			break;
+
+		/* a packet too large to index is kept, it's just never matched */
+		r = make_entry(p, d.index, start, &entry);
+		if (r == -1)
+			break;
+
+		if (r == 0) {
+			r = index_insert(a, &entry, p + entry.name_start);
+			if (r < 0)
+				return -1;
+		}
+
+		start += d.index;
+		p += d.index;
+		memset(&d, 0, sizeof(d));
+	}
+
+	a->data_size = start;
+	if (start < file_size) {
+		r = ftruncate(a->fd, start);
+		if (r < 0)
+			return -1;
+	}
+	a->dirty = 1;
+
+	return 0;
+}
+
+/* loads the index, a missing or damaged one is rebuilt by recover() */
+static void
+load_index(struct archive *a, uint64_t file_size)
+{
+	struct index_header header;
+	struct archive_entry *entries = NULL;
+	uint64_t i;
+	FILE *f;
+
+	f = fopen(a->index_path, "rb");
+	if (!f)
+		return;
+
+	if (fread(&header, sizeof(header), 1, f) != 1 ||
+			memcmp(header.magic, INDEX_MAGIC, sizeof(header.magic)) ||
+			header.entry_size != sizeof(struct archive_entry) ||
+			header.data_size > file_size)
+		goto out;
+
+	/* every entry is at least a byte of the data file */
+	if (header.count > header.data_size ||
+			header.count > SIZE_MAX / sizeof(*entries))
+		goto out;
+
+	if (header.count) {
+		entries = malloc(header.count * sizeof(*entries));
+		if (!entries)
+			goto out;
+
+		if (fread(entries, sizeof(*entries), header.count, f) !=
+				header.count)
+			goto out;
+
+		for (i = 0; i < header.count; i++)
+			if (!entry_valid(&entries[i], header.data_size))
+				goto out;
+	}
+
+	a->entries = entries;
+	a->n = a->limit = header.count;
+	a->data_size = header.data_size;
+	entries = NULL;
+
+out:
+	free(entries);
+	fclose(f);
+}
+
+/* an index in the wrong order is dropped, recover() then rebuilds it */
+static void
+check_order(struct archive *a)
+{
+	const unsigned char *name, *prev;
+	size_t i, size, prev_size;
+
+	for (i = 1; i < a->n; i++) {
+		prev = entry_name(a, &a->entries[i - 1], &prev_size);
+		name = entry_name(a, &a->entries[i], &size);
+		if (ndn_compare_names(prev, prev_size, name, size) > 0)
+			break;
+	}
+	if (i >= a->n)
+		return;
+
+	free(a->entries);
+	a->entries = NULL;
+	a->n = a->limit = 0;
+	a->data_size = 0;
+}
+
+struct archive *
+archive_open(const char *path)
+{
+	struct archive *a;
+	struct stat st;
+	int r, err;
+
+	a = calloc(1, sizeof(*a));
+	if (!a)
+		return NULL;
+	a->fd = -1;
+
+	a->path = strdup(path);
+	a->index_path = malloc(strlen(path) + sizeof(".idx"));
+	if (!a->path || !a->index_path)
+		goto error;
+	sprintf(a->index_path, "%s.idx", path);
+
+	a->fd = open(path, O_RDWR | O_CREAT | O_APPEND, 0644);
+	if (a->fd < 0)
+		goto error;
+
+	r = fstat(a->fd, &st);
+	if (r < 0)
+		goto error;
+
+	load_index(a, st.st_size);
+
+	r = map_data(a);
+	if (r < 0)
+		goto error;
+
+	check_order(a);
+
+	r = recover(a, st.st_size);
+	if (r < 0)
+		goto error;
+
+	return a;
+
+error:
+	err = errno;
+	a->dirty = 0;
+	archive_close(&a);
+	errno = err;
+	return NULL;
+}
+
+void
+archive_close(struct archive **ap)
+{
+	struct archive *a = *ap;
+
+	if (!a)
+		return;
+
+	archive_flush(a);
+
+	if (a->map)
+		munmap((void *) a->map, a->map_size);
+	if (a->fd >= 0)
+		close(a->fd);
+
+	free(a->entries);
+	free(a->path);
+	free(a->index_path);
+	free(a);
+	*ap = NULL;
+}
+
+/*
+ * Returns 0, -1 on I/O errors (errno is set), -2 if co isn't a Data and -3
+ * if it is too large for the index
+ */
+int
+archive_append(struct archive *a, const unsigned char *co, size_t size)
+{
+	struct archive_entry entry;
+	size_t written = 0;
+	ssize_t w;
+	int r, err;
+
+	r = make_entry(co, size, a->data_size, &entry);
+	if (r < 0)
+		return r == -2 ? -3 : -2;
+
+	while (written < size) {
+		w = write(a->fd, co + written, size - written);
+		if (w < 0) {
+			if (errno == EINTR)
+				continue;
+
+			/* don't leave half a packet behind */
+			err = errno;
+			r = ftruncate(a->fd, a->data_size);
+			errno = err;
+			return -1;
+		}
+		written += w;
+	}
+
+	/* index_insert() compares names where they sit in the mapping */
+	a->data_size += size;
+	r = map_data(a);
+	if (r < 0)
+		goto rollback;
+
+	r = index_insert(a, &entry, co + entry.name_start);
+	if (r < 0) {
+		errno = ENOMEM;
+		goto rollback;
+	}
+
+	return 0;
+
+rollback:
+	a->data_size -= size;
+	err = errno;
+	r = ftruncate(a->fd, a->data_size);
+	errno = err;
+	return -1;
+}
+
+/* Writes the index if it changed, -1 with errno set on failure */
+int
+archive_flush(struct archive *a)
+{
+	struct index_header header;
+	char *tmp_path;
+	FILE *f;
+	int r, err;
+
+	if (!a->dirty)
+		return 0;
+
+	/* the index must never point past what's on the disk */
+	r = fsync(a->fd);
+	if (r < 0)
+		return -1;
+
+	tmp_path = malloc(strlen(a->index_path) + sizeof(".tmp"));
+	if (!tmp_path)
+		return -1;
+	sprintf(tmp_path, "%s.tmp", a->index_path);
+
+	f = fopen(tmp_path, "wb");
+	if (!f)
+		goto error;
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, INDEX_MAGIC, sizeof(header.magic));
+	header.entry_size = sizeof(struct archive_entry);
+	header.count = a->n;
+	header.data_size = a->data_size;
+
+	if (fwrite(&header, sizeof(header), 1, f) != 1 ||
+			fwrite(a->entries, sizeof(*a->entries), a->n, f) != a->n ||
+			fflush(f) || fsync(fileno(f))) {
+		err = errno;
+		fclose(f);
+		errno = err;
+		goto error;
+	}
+
+	r = fclose(f);
+	if (r)
+		goto error;
+
+	r = rename(tmp_path, a->index_path);
+	if (r < 0)
+		goto error;
+
+	free(tmp_path);
+	a->dirty = 0;
+
+	return 0;
+
+error:
+	err = errno;
+	unlink(tmp_path);
+	free(tmp_path);
+	errno = err;
+	return -1;
+}
+
+size_t
+archive_count(const struct archive *a)
+{
+	return a->n;
+}
+
+size_t
+archive_bytes(const struct archive *a)
+{
+	return a->data_size;
+}
+
+/*
+ * The Data satisfying the interest, following its child selector, NULL if
+ * there's none. The returned pointer is into the mapping and stays valid
+ * until the next append.
+ */
+const unsigned char *
+archive_match(struct archive *a, const unsigned char *interest, size_t size,
+		const struct ndn_parsed_interest *pi, size_t *co_size)
+{
+	struct ndn_parsed_ContentObject pco;
+	const unsigned char *prefix, *name, *co;
+	size_t prefix_size, name_size, lo, hi, i;
+	const struct archive_entry *e;
+	int r, rightmost;
+
+	r = map_data(a);
+	if (r < 0)
+		return NULL;
+
+	prefix = interest + pi->offset[NDN_PI_B_Name];
+	prefix_size = pi->offset[NDN_PI_E_Name] - pi->offset[NDN_PI_B_Name];
+
+	lo = bound(a, prefix, prefix_size, 0);
+	for (hi = lo; hi < a->n; hi++) {
+		name = entry_name(a, &a->entries[hi], &name_size);
+		if (!has_prefix(name, name_size, prefix, prefix_size))
+			break;
+	}
+
+	/*
+	 * Walking the range from the end finds the greatest matching name,
+	 * which is under the rightmost child that has a match
+	 */
+	rightmost = pi->orderpref & 1;
+
+	for (i = 0; i < hi - lo; i++) {
+		e = &a->entries[rightmost ? hi - 1 - i : lo + i];
+		co = a->map + e->offset;
+
+		r = ndn_parse_ContentObject(co, e->size, &pco, NULL);
+		if (r < 0)
+			continue;
+
+		if (ndn_content_matches_interest(co, e->size, 1, &pco, interest,
+				size, pi)) {
+			*co_size = e->size;
+			return co;
+		}
+	}
+
+	return NULL;
+}
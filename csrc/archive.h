@@ -0,0 +1,24 @@
+/*
+ * Copyright (c) 2011, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ * Written by: Derek Kulinski <takeda@takeda.tk>
+ *             Jeff Burke <jburke@ucla.edu>
+ */
+
+#ifndef ARCHIVE_H
+#  define	ARCHIVE_H
+
+struct archive;
+
+struct archive *archive_open(const char *path);
+void archive_close(struct archive **archive);
+int archive_append(struct archive *archive, const unsigned char *co,
+		size_t size);
+int archive_flush(struct archive *archive);
+size_t archive_count(const struct archive *archive);
+size_t archive_bytes(const struct archive *archive);
+const unsigned char *archive_match(struct archive *archive,
+		const unsigned char *interest, size_t size,
+		const struct ndn_parsed_interest *pi, size_t *co_size);
+
+#endif	/* ARCHIVE_H */
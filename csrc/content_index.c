@@ -0,0 +1,349 @@
+/*
+ * Copyright (c) 2011, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ * Written by: Derek Kulinski <takeda@takeda.tk>
+ *             Jeff Burke <jburke@ucla.edu>
+ */
+
+/*
+ * content_index.c - Data packets kept sorted by name
+ *
+ * Lookups for an interest binary search the first entry not sorting before
+ * the interest name, and only the entries under that prefix are checked
+ * with ndn_content_matches_interest(). Serving a segment this way costs
+ * O(log N) instead of a scan over everything pending.
+ *
+ * Entries may also have an expiry time; those are kept in a binary heap
+ * as well, soonest first, so dropping what expired doesn't look at the
+ * rest.
+ */
+
+#include <ndn/ndn.h>
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "content_index.h"
+
+struct content_entry {
+	struct ndn_charbuf *co;
+	struct ndn_parsed_ContentObject pco;
+	long long expires;              /* 0 for never */
+	size_t heap_pos;                /* in heap, when it expires */
+};
+
+struct content_index {
+	struct content_entry **entries; /* sorted by name */
+	size_t n, limit;
+	size_t bytes;
+	struct content_entry **heap;    /* the ones expiring, soonest first */
+	size_t heap_n, heap_limit;
+};
+
+static inline const unsigned char *
+entry_name(const struct content_entry *e, size_t *size)
+{
+	*size = e->pco.offset[NDN_PCO_E_Name] - e->pco.offset[NDN_PCO_B_Name];
+	return e->co->buf + e->pco.offset[NDN_PCO_B_Name];
+}
+
+/* first entry whose name doesn't sort before name (after it if upper) */
+static size_t
+bound(const struct content_index *ci, const unsigned char *name,
+		size_t size, int upper)
+{
+	const unsigned char *ename;
+	size_t lo = 0, hi = ci->n, mid, esize;
+	int r;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		ename = entry_name(ci->entries[mid], &esize);
+
+		r = ndn_compare_names(ename, esize, name, size);
+		if (r < 0 || (upper && r == 0))
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/*
+ * Components are self delimiting, so a name is under a prefix when the
+ * prefix without its closing tag is a byte prefix of the name
+ */
+static inline int
+has_prefix(const unsigned char *name, size_t size,
+		const unsigned char *prefix, size_t prefix_size)
+{
+	assert(prefix_size > 0);
+
+	return size >= prefix_size &&
+			!memcmp(name, prefix, prefix_size - 1);
+}
+
+static int
+grow(struct content_entry ***array, size_t *limit)
+{
+	struct content_entry **p;
+	size_t new_limit = *limit ? *limit * 2 : 16;
+
+	p = realloc(*array, new_limit * sizeof(*p));
+	if (!p)
+		return -1;
+
+	*array = p;
+	*limit = new_limit;
+
+	return 0;
+}
+
+static inline void
+heap_set(struct content_index *ci, size_t pos, struct content_entry *e)
+{
+	ci->heap[pos] = e;
+	e->heap_pos = pos;
+}
+
+static void
+heap_sift_up(struct content_index *ci, size_t pos)
+{
+	struct content_entry *e = ci->heap[pos];
+	size_t parent;
+
+	while (pos > 0) {
+		parent = (pos - 1) / 2;
+		if (ci->heap[parent]->expires <= e->expires)
+			break;
+
+		heap_set(ci, pos, ci->heap[parent]);
+		pos = parent;
+	}
+	heap_set(ci, pos, e);
+}
+
+static void
+heap_sift_down(struct content_index *ci, size_t pos)
+{
+	struct content_entry *e = ci->heap[pos];
+	size_t child;
+
+	while ((child = 2 * pos + 1) < ci->heap_n) {
+		if (child + 1 < ci->heap_n &&
+				ci->heap[child + 1]->expires < ci->heap[child]->expires)
+			child++;
+		if (e->expires <= ci->heap[child]->expires)
+			break;
+
+		heap_set(ci, pos, ci->heap[child]);
+		pos = child;
+	}
+	heap_set(ci, pos, e);
+}
+
+static void
+heap_remove(struct content_index *ci, struct content_entry *e)
+{
+	struct content_entry *last;
+	size_t pos = e->heap_pos;
+
+	assert(pos < ci->heap_n && ci->heap[pos] == e);
+
+	if (--ci->heap_n == pos)
+		return;
+
+	last = ci->heap[ci->heap_n];
+	heap_set(ci, pos, last);
+	heap_sift_down(ci, pos);
+	heap_sift_up(ci, last->heap_pos);
+}
+
+struct content_index *
+content_index_create(void)
+{
+	return calloc(1, sizeof(struct content_index));
+}
+
+void
+content_index_destroy(struct content_index **cip)
+{
+	struct content_index *ci = *cip;
+
+	if (!ci)
+		return;
+
+	for (size_t i = 0; i < ci->n; i++) {
+		ndn_charbuf_destroy(&ci->entries[i]->co);
+		free(ci->entries[i]);
+	}
+
+	free(ci->entries);
+	free(ci->heap);
+	free(ci);
+	*cip = NULL;
+}
+
+size_t
+content_index_count(const struct content_index *ci)
+{
+	return ci->n;
+}
+
+size_t
+content_index_bytes(const struct content_index *ci)
+{
+	return ci->bytes;
+}
+
+/*
+ * Returns 0 when the Data was added, -1 when out of memory and -2 when it
+ * can't be parsed
+ */
+int
+content_index_add(struct content_index *ci, const unsigned char *co,
+		size_t size)
+{
+	return content_index_add_expiring(ci, co, size, 0);
+}
+
+/* Same as content_index_add(), the Data is dropped at expires unless 0 */
+int
+content_index_add_expiring(struct content_index *ci, const unsigned char *co,
+		size_t size, long long expires)
+{
+	struct content_entry *entry;
+	const unsigned char *name;
+	size_t name_size, i;
+	int r;
+
+	if (ci->n == ci->limit && grow(&ci->entries, &ci->limit) < 0)
+		return -1;
+
+	if (expires && ci->heap_n == ci->heap_limit &&
+			grow(&ci->heap, &ci->heap_limit) < 0)
+		return -1;
+
+	entry = calloc(1, sizeof(*entry));
+	if (!entry)
+		return -1;
+
+	r = ndn_parse_ContentObject(co, size, &entry->pco, NULL);
+	if (r < 0) {
+		free(entry);
+		return -2;
+	}
+
+	entry->co = ndn_charbuf_create();
+	if (!entry->co || ndn_charbuf_append(entry->co, co, size) < 0) {
+		ndn_charbuf_destroy(&entry->co);
+		free(entry);
+		return -1;
+	}
+
+	/* equal names keep their insertion order */
+	name = entry_name(entry, &name_size);
+	i = bound(ci, name, name_size, 1);
+
+	memmove(&ci->entries[i + 1], &ci->entries[i],
+			(ci->n - i) * sizeof(*ci->entries));
+	ci->entries[i] = entry;
+	ci->n++;
+	ci->bytes += size;
+
+	entry->expires = expires;
+	if (expires) {
+		ci->heap[ci->heap_n] = entry;
+		heap_sift_up(ci, ci->heap_n++);
+	}
+
+	return 0;
+}
+
+/* Index of the first Data satisfying the interest, -1 if there's none */
+int
+content_index_match(const struct content_index *ci,
+		const unsigned char *interest, size_t size,
+		const struct ndn_parsed_interest *pi)
+{
+	const unsigned char *prefix, *name;
+	size_t prefix_size, name_size, i;
+	struct content_entry *e;
+
+	prefix = interest + pi->offset[NDN_PI_B_Name];
+	prefix_size = pi->offset[NDN_PI_E_Name] - pi->offset[NDN_PI_B_Name];
+
+	for (i = bound(ci, prefix, prefix_size, 0); i < ci->n; i++) {
+		e = ci->entries[i];
+
+		name = entry_name(e, &name_size);
+		if (!has_prefix(name, name_size, prefix, prefix_size))
+			break;
+
+		if (ndn_content_matches_interest(e->co->buf, e->co->length, 1,
+				&e->pco, interest, size, pi))
+			return i;
+	}
+
+	return -1;
+}
+
+const struct ndn_charbuf *
+content_index_get(const struct content_index *ci, size_t i)
+{
+	assert(i < ci->n);
+
+	return ci->entries[i]->co;
+}
+
+void
+content_index_remove(struct content_index *ci, size_t i)
+{
+	struct content_entry *e;
+
+	assert(i < ci->n);
+	e = ci->entries[i];
+
+	if (e->expires)
+		heap_remove(ci, e);
+
+	ci->bytes -= e->co->length;
+	ndn_charbuf_destroy(&e->co);
+	free(e);
+
+	ci->n--;
+	memmove(&ci->entries[i], &ci->entries[i + 1],
+			(ci->n - i) * sizeof(*ci->entries));
+}
+
+/* Expiry time of the Data expiring first, 0 when nothing expires */
+long long
+content_index_next_expiry(const struct content_index *ci)
+{
+	return ci->heap_n ? ci->heap[0]->expires : 0;
+}
+
+/* Drops the Data that expired by now, returns how many */
+size_t
+content_index_expire(struct content_index *ci, long long now)
+{
+	struct content_entry *e;
+	const unsigned char *name;
+	size_t name_size, i, count = 0;
+
+	while (ci->heap_n && ci->heap[0]->expires <= now) {
+		e = ci->heap[0];
+
+		/* among the entries with its name */
+		name = entry_name(e, &name_size);
+		for (i = bound(ci, name, name_size, 0); ci->entries[i] != e; i++)
+			assert(i + 1 < ci->n);
+
+		content_index_remove(ci, i);
+		count++;
+	}
+
+	return count;
+}
@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) 2011, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ * Written by: Derek Kulinski <takeda@takeda.tk>
+ *             Jeff Burke <jburke@ucla.edu>
+ */
+
+#ifndef CONTENT_INDEX_H
+#  define	CONTENT_INDEX_H
+
+struct content_index;
+
+struct content_index *content_index_create(void);
+void content_index_destroy(struct content_index **ci);
+size_t content_index_count(const struct content_index *ci);
+size_t content_index_bytes(const struct content_index *ci);
+int content_index_add(struct content_index *ci, const unsigned char *co,
+		size_t size);
+int content_index_add_expiring(struct content_index *ci, const unsigned char *co,
+		size_t size, long long expires);
+int content_index_match(const struct content_index *ci,
+		const unsigned char *interest, size_t size,
+		const struct ndn_parsed_interest *pi);
+const struct ndn_charbuf *content_index_get(const struct content_index *ci,
+		size_t i);
+void content_index_remove(struct content_index *ci, size_t i);
+long long content_index_next_expiry(const struct content_index *ci);
+size_t content_index_expire(struct content_index *ci, long long now);
+
+#endif	/* CONTENT_INDEX_H */
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2011, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ * Written by: Derek Kulinski <takeda@takeda.tk>
+ *             Jeff Burke <jburke@ucla.edu>
+ */
+
+/*
+ * histogram.c - log-linear latency histograms, values in microseconds
+ */
+
+#include "python_hdr.h"
+
+#include <string.h>
+
+#include "histogram.h"
+
+static inline int
+bucket_index(unsigned long long value)
+{
+	int msb, shift;
+
+	if (value < HISTOGRAM_SUB_BUCKETS)
+		return value;
+
+	msb = 63 - __builtin_clzll(value);
+	shift = msb - HISTOGRAM_SUB_BITS;
+
+	/* value >> shift is in [SUB_BUCKETS, 2 * SUB_BUCKETS) */
+	return (shift + 1) * HISTOGRAM_SUB_BUCKETS +
+			(value >> shift) - HISTOGRAM_SUB_BUCKETS;
+}
+
+/* largest value which lands in the bucket */
+static inline unsigned long long
+bucket_highest(int i)
+{
+	int shift;
+
+	if (i < HISTOGRAM_SUB_BUCKETS)
+		return i;
+
+	shift = i / HISTOGRAM_SUB_BUCKETS - 1;
+
+	return ((unsigned long long) (i % HISTOGRAM_SUB_BUCKETS +
+			HISTOGRAM_SUB_BUCKETS) << shift) + (1ULL << shift) - 1;
+}
+
+void
+histogram_reset(struct histogram *h)
+{
+	memset(h, 0, sizeof(*h));
+}
+
+void
+histogram_record(struct histogram *h, unsigned long long value)
+{
+	if (value > HISTOGRAM_MAX)
+		value = HISTOGRAM_MAX;
+
+	if (!h->count || value < h->min)
+		h->min = value;
+	if (value > h->max)
+		h->max = value;
+
+	h->count++;
+	h->sum += value;
+	h->buckets[bucket_index(value)]++;
+}
+
+/* percentile in [0, 100], the result never exceeds the largest value seen */
+unsigned long long
+histogram_percentile(const struct histogram *h, double percentile)
+{
+	unsigned long long wanted, seen = 0, value;
+	int i;
+
+	if (!h->count)
+		return 0;
+
+	wanted = percentile / 100.0 * h->count + 0.5;
+	if (wanted < 1)
+		wanted = 1;
+
+	for (i = 0; i < HISTOGRAM_BUCKETS; i++) {
+		seen += h->buckets[i];
+		if (seen >= wanted)
+			break;
+	}
+
+	value = bucket_highest(i);
+
+	return value < h->max ? value : h->max;
+}
+
+/* values are converted to seconds, like the rest of the stats */
+PyObject *
+histogram_to_python(const struct histogram *h)
+{
+	return Py_BuildValue("{s:K,s:d,s:d,s:d,s:d,s:d,s:d,s:d}",
+			"count", h->count,
+			"min", h->min / 1e6,
+			"max", h->max / 1e6,
+			"mean", h->count ? (double) h->sum / h->count / 1e6 : 0.0,
+			"p50", histogram_percentile(h, 50.0) / 1e6,
+			"p90", histogram_percentile(h, 90.0) / 1e6,
+			"p99", histogram_percentile(h, 99.0) / 1e6,
+			"p999", histogram_percentile(h, 99.9) / 1e6);
+}
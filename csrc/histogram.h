@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2011, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ * Written by: Derek Kulinski <takeda@takeda.tk>
+ *             Jeff Burke <jburke@ucla.edu>
+ */
+
+#ifndef HISTOGRAM_H
+#  define	HISTOGRAM_H
+
+/*
+ * HDR style latency histogram: every power of two is split into
+ * HISTOGRAM_SUB_BUCKETS linear buckets, so any recorded value is known
+ * within ~3% while the whole range up to HISTOGRAM_MAX microseconds (about
+ * 19 hours) takes a fixed 8kB. Recording is a couple of shifts and an
+ * increment.
+ */
+#define HISTOGRAM_SUB_BITS 5
+#define HISTOGRAM_SUB_BUCKETS (1 << HISTOGRAM_SUB_BITS)
+#define HISTOGRAM_MAX_BITS 36
+#define HISTOGRAM_MAX ((1ULL << HISTOGRAM_MAX_BITS) - 1)
+#define HISTOGRAM_BUCKETS (HISTOGRAM_SUB_BUCKETS + \
+		(HISTOGRAM_MAX_BITS - HISTOGRAM_SUB_BITS) * HISTOGRAM_SUB_BUCKETS)
+
+struct histogram {
+	unsigned long long count;
+	unsigned long long sum, min, max;
+	unsigned long long buckets[HISTOGRAM_BUCKETS];
+};
+
+void histogram_reset(struct histogram *h);
+void histogram_record(struct histogram *h, unsigned long long value);
+unsigned long long histogram_percentile(const struct histogram *h,
+		double percentile);
+PyObject *histogram_to_python(const struct histogram *h);
+
+#endif	/* HISTOGRAM_H */
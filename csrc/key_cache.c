@@ -0,0 +1,328 @@
+/*
+ * Copyright (c) 2011, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ * Written by: Derek Kulinski <takeda@takeda.tk>
+ *             Jeff Burke <jburke@ucla.edu>
+ */
+
+/*
+ * key_cache.c - keys read from keystore files, kept for the process
+ *
+ * Opening a keystore reads the file and decrypts its PKCS#12 container,
+ * and finding the default key name needs a whole ndn handle, which loads
+ * the keystore once more. Both are done once per keystore path here. An
+ * entry remembers the file's mtime (in nanoseconds where the system keeps
+ * them), size and inode and is reloaded when any of them changes, so a
+ * regenerated keystore is picked up on the next call. A keystore holds a
+ * single key, so the path and the file's identity say which key the entry
+ * is; its digest is only known once the file is loaded.
+ *
+ * Every caller gets its own Key object, but the key capsules and the
+ * digest are shared; nothing modifies them in place.
+ */
+
+#include "python_hdr.h"
+#include <ndn/ndn.h>
+#include <ndn/hashtb.h>
+#include <ndn/keystore.h>
+
+#include <sys/stat.h>
+#include <assert.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "pyndn.h"
+#include "util.h"
+#include "key_cache.h"
+#include "key_utils.h"
+#include "methods_key.h"
+#include "methods_name.h"
+#include "objects.h"
+
+/*
+ * st_mtim is POSIX.1-2008, OS X calls it st_mtimespec and elsewhere only
+ * the seconds may be there; size and inode still catch most rewrites then
+ */
+#if defined(__APPLE__)
+#  define STAT_MTIME_SEC(st)	((st)->st_mtimespec.tv_sec)
+#  define STAT_MTIME_NSEC(st)	((st)->st_mtimespec.tv_nsec)
+#elif defined(_POSIX_VERSION) && _POSIX_VERSION >= 200809L
+#  define STAT_MTIME_SEC(st)	((st)->st_mtim.tv_sec)
+#  define STAT_MTIME_NSEC(st)	((st)->st_mtim.tv_nsec)
+#else
+#  define STAT_MTIME_SEC(st)	((st)->st_mtime)
+#  define STAT_MTIME_NSEC(st)	0L
+#endif
+
+struct key_cache_entry {
+	struct timespec mtime;
+	off_t size;
+	ino_t ino;
+	PyObject *py_key;               /* Key the copies are made from */
+	struct ndn_charbuf *key_name;   /* default key name, or NULL */
+};
+
+static void
+key_cache_finalize(struct hashtb_enumerator *e)
+{
+	struct key_cache_entry *entry = e->data;
+
+	Py_CLEAR(entry->py_key);
+	ndn_charbuf_destroy(&entry->key_name);
+}
+
+static struct hashtb *
+key_cache(void)
+{
+	struct pyndn_state *state = GETSTATE(_pyndn_module);
+	struct hashtb_param param = {0};
+
+	if (!state->key_cache) {
+		param.finalize = key_cache_finalize;
+		state->key_cache = hashtb_create(sizeof(struct key_cache_entry),
+				&param);
+	}
+
+	return state->key_cache;
+}
+
+/*
+ * The entry for path, emptied when the file changed since it was filled.
+ * NULL when the file can't be examined, errno tells why
+ */
+static struct key_cache_entry *
+key_cache_entry(const char *path)
+{
+	struct hashtb *cache;
+	struct hashtb_enumerator ee, *e = &ee;
+	struct key_cache_entry *entry = NULL;
+	struct stat st;
+	int r;
+
+	if (stat(path, &st) < 0)
+		return NULL;
+
+	cache = key_cache();
+	if (!cache) {
+		errno = ENOMEM;
+		return NULL;
+	}
+
+	hashtb_start(cache, e);
+
+	r = hashtb_seek(e, path, strlen(path), 0);
+	if (r < 0) {
+		errno = ENOMEM;
+		goto out;
+	}
+
+	/* to the nanosecond, a keystore rewritten within a second is reloaded */
+	entry = e->data;
+	if (entry->mtime.tv_sec != STAT_MTIME_SEC(&st) ||
+			entry->mtime.tv_nsec != STAT_MTIME_NSEC(&st) ||
+			entry->size != st.st_size || entry->ino != st.st_ino) {
+		Py_CLEAR(entry->py_key);
+		ndn_charbuf_destroy(&entry->key_name);
+
+		entry->mtime.tv_sec = STAT_MTIME_SEC(&st);
+		entry->mtime.tv_nsec = STAT_MTIME_NSEC(&st);
+		entry->size = st.st_size;
+		entry->ino = st.st_ino;
+	}
+
+out:
+	hashtb_end(e);
+	return entry;
+}
+
+// Fresh Key sharing the template's key material
+
+static PyObject *
+key_copy(PyObject *py_template)
+{
+	static const char *attrs[] = {"type", "publicKeyID", "ndn_data_private",
+			"ndn_data_public", NULL};
+	const char **attr;
+	PyObject *py_key, *py_o;
+	int r;
+
+	py_key = PyObject_CallObject(g_type_Key, NULL);
+	JUMP_IF_NULL(py_key, error);
+
+	for (attr = attrs; *attr; attr++) {
+		py_o = PyObject_GetAttrString(py_template, *attr);
+		JUMP_IF_NULL(py_o, error);
+
+		r = PyObject_SetAttrString(py_key, *attr, py_o);
+		Py_DECREF(py_o);
+		JUMP_IF_NEG(r, error);
+	}
+
+	return py_key;
+
+error:
+	Py_XDECREF(py_key);
+	return NULL;
+}
+
+static PyObject *
+key_load(const char *path, const char *password)
+{
+	struct ndn_keystore *keystore;
+	const struct ndn_pkey *key;
+	PyObject *py_ndn_key, *py_key = NULL;
+	int r;
+
+	keystore = ndn_keystore_create();
+	JUMP_IF_NULL_MEM(keystore, error);
+
+	r = ndn_keystore_init(keystore, (char *) path, (char *) password);
+	if (r < 0) {
+		PyErr_Format(g_PyExc_NDNError, "Failed to initialize keystore (%d)", r);
+		goto error;
+	}
+
+	key = ndn_keystore_private_key(keystore);
+	assert(key);
+
+	py_ndn_key = _pyndn_privatekey_dup(key);
+	JUMP_IF_NULL(py_ndn_key, error);
+
+	py_key = Key_obj_from_ndn(py_ndn_key);
+	Py_DECREF(py_ndn_key);
+
+error:
+	ndn_keystore_destroy(&keystore);
+	return py_key;
+}
+
+/*
+ * Where the library keeps the user's keystore, $NDNX_DIR or ~/.ndnx.
+ * Returns 0, or -1 with a Python exception set
+ */
+int
+key_cache_default_path(struct ndn_charbuf *path)
+{
+	const char *dir;
+	int r;
+
+	dir = getenv("NDNX_DIR");
+	if (dir && *dir)
+		r = ndn_charbuf_putf(path, "%s/.ndnx_keystore", dir);
+	else
+		r = ndn_charbuf_putf(path, "%s/.ndnx/.ndnx_keystore", getenv("HOME"));
+
+	if (r < 0) {
+		PyErr_NoMemory();
+		return -1;
+	}
+
+	return 0;
+}
+
+PyObject *
+key_cache_get_key(const char *path, const char *password)
+{
+	struct key_cache_entry *entry;
+	PyObject *py_key;
+
+	entry = key_cache_entry(path);
+	if (!entry)
+		return key_load(path, password);
+
+	if (!entry->py_key) {
+		py_key = key_load(path, password);
+		if (!py_key)
+			return NULL;
+
+		/* loading runs Python code, look the entry up again */
+		entry = key_cache_entry(path);
+		if (!entry)
+			return py_key;
+
+		Py_XDECREF(entry->py_key);
+		entry->py_key = py_key;
+	}
+
+	return key_copy(entry->py_key);
+}
+
+static int
+key_name_load(struct ndn_charbuf *key_name)
+{
+	struct ndn_signing_params sp = NDN_SIGNING_PARAMS_INIT;
+	struct ndn *handle;
+	int r;
+
+	handle = ndn_create();
+	if (!handle) {
+		PyErr_NoMemory();
+		return -1;
+	}
+
+	r = ndn_get_public_key_and_name(handle, &sp, NULL, NULL, key_name);
+	ndn_destroy(&handle);
+	if (r < 0) {
+		PyErr_SetString(g_PyExc_NDNKeyError, "Unable to obtain the default"
+				" key name");
+		return -1;
+	}
+
+	return 0;
+}
+
+// Name of the default key, the library decides which keystore that is
+
+PyObject *
+key_cache_get_key_name(const char *path)
+{
+	struct key_cache_entry *entry;
+	struct ndn_charbuf *key_name;
+	PyObject *py_cname, *py_name;
+	int r;
+
+	key_name = ndn_charbuf_create();
+	JUMP_IF_NULL_MEM(key_name, error);
+
+	entry = key_cache_entry(path);
+	if (entry && entry->key_name)
+		r = ndn_charbuf_append_charbuf(key_name, entry->key_name);
+	else {
+		r = key_name_load(key_name);
+		if (r < 0)
+			goto error;
+
+		/* the library may have just created the keystore */
+		entry = key_cache_entry(path);
+		if (entry && !entry->key_name) {
+			entry->key_name = ndn_charbuf_create();
+			if (entry->key_name && ndn_charbuf_append_charbuf(
+					entry->key_name, key_name) < 0)
+				ndn_charbuf_destroy(&entry->key_name);
+		}
+	}
+	JUMP_IF_NEG_MEM(r, error);
+
+	py_cname = NDNObject_New(NAME, key_name);
+	JUMP_IF_NULL(py_cname, error);
+
+	py_name = Name_obj_from_ndn(py_cname);
+	Py_DECREF(py_cname);
+
+	return py_name;
+
+error:
+	ndn_charbuf_destroy(&key_name);
+	return NULL;
+}
+
+void
+key_cache_clear(void)
+{
+	struct pyndn_state *state = GETSTATE(_pyndn_module);
+
+	if (state->key_cache)
+		hashtb_destroy(&state->key_cache);
+}
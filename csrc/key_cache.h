@@ -0,0 +1,16 @@
+/*
+ * Copyright (c) 2011, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ * Written by: Derek Kulinski <takeda@takeda.tk>
+ *             Jeff Burke <jburke@ucla.edu>
+ */
+
+#ifndef KEY_CACHE_H
+#  define	KEY_CACHE_H
+
+int key_cache_default_path(struct ndn_charbuf *path);
+PyObject *key_cache_get_key(const char *path, const char *password);
+PyObject *key_cache_get_key_name(const char *path);
+void key_cache_clear(void);
+
+#endif	/* KEY_CACHE_H */
@@ -16,6 +16,8 @@
 // On MacOS X, need to have the latest version from MacPorts
 // and add /opt/local/include as an include path
 #include <openssl/rsa.h>
+#include <openssl/ec.h>
+#include <openssl/objects.h>
 #include <openssl/pem.h>
 #include <openssl/evp.h>
 #include <openssl/sha.h>
@@ -178,6 +180,50 @@ error:
 	return -1;
 }
 
+/*
+ * Copies a key through its DER form, which works for every key type.
+ * With public_only set the copy holds just the public part
+ */
+static struct ndn_pkey *
+key_dup(const struct ndn_pkey *key, int public_only)
+{
+	unsigned char *der = NULL;
+	const unsigned char *p;
+	EVP_PKEY *copy;
+	int der_len;
+
+	if (public_only)
+		der_len = i2d_PUBKEY((EVP_PKEY *) key, &der);
+	else
+		der_len = i2d_PrivateKey((EVP_PKEY *) key, &der);
+	if (der_len < 0)
+		return NULL;
+
+	p = der;
+	if (public_only)
+		copy = d2i_PUBKEY(NULL, &p, der_len);
+	else
+		copy = d2i_AutoPrivateKey(NULL, &p, der_len);
+
+	OPENSSL_cleanse(der, der_len);
+	OPENSSL_free(der);
+
+	return (struct ndn_pkey *) copy;
+}
+
+const char *
+key_type_name(const struct ndn_pkey *key)
+{
+	switch (EVP_PKEY_base_id((const EVP_PKEY *) key)) {
+	case EVP_PKEY_RSA:
+		return "RSA";
+	case EVP_PKEY_EC:
+		return "EC";
+	default:
+		return "unknown";
+	}
+}
+
 int
 ndn_keypair(int public_only, struct ndn_pkey *private_key,
             PyObject **py_private_key_ndn, PyObject **py_public_key_ndn)
@@ -186,42 +232,24 @@ ndn_keypair(int public_only, struct ndn_pkey *private_key,
 	struct ndn_pkey *private_key_copy = NULL;
 	PyObject *py_private_key = NULL, *py_public_key = NULL;
 	unsigned int err;
-	int r;
 
 	if (!public_only && py_private_key_ndn) {
-                private_key_copy = (struct ndn_pkey *) EVP_PKEY_new();
-                JUMP_IF_NULL(private_key_copy, openssl_error);
-
-                py_private_key = NDNObject_New(PKEY_PRIV, private_key_copy);
-		JUMP_IF_NULL(py_private_key, error);
-                
-                RSA *private_key_rsa = EVP_PKEY_get1_RSA ((EVP_PKEY *)private_key);
-                JUMP_IF_NULL(private_key_rsa, openssl_error);
-                
-                RSA* private_key_rsa_copy = RSAPrivateKey_dup (private_key_rsa);
-                JUMP_IF_NULL(private_key_rsa_copy, openssl_error);
-                
-		r = EVP_PKEY_set1_RSA((EVP_PKEY *) private_key_copy, private_key_rsa_copy);
-		RSA_free(private_key_rsa_copy);
-		JUMP_IF_NULL(r, error);
+		private_key_copy = key_dup(private_key, 0);
+		JUMP_IF_NULL(private_key_copy, openssl_error);
+
+		py_private_key = NDNObject_New(PKEY_PRIV, private_key_copy);
+		if (!py_private_key) {
+			EVP_PKEY_free((EVP_PKEY *) private_key_copy);
+			goto error;
+		}
 	}
 
 	if (py_public_key_ndn) {
-		public_key = (struct ndn_pkey *) EVP_PKEY_new();
+		public_key = key_dup(private_key, 1);
 		JUMP_IF_NULL(public_key, openssl_error);
 
 		py_public_key = NDNObject_New(PKEY_PUB, public_key);
 		JUMP_IF_NULL(py_public_key, error);
-
-                RSA *private_key_rsa = EVP_PKEY_get1_RSA ((EVP_PKEY *)private_key);
-                JUMP_IF_NULL(private_key_rsa, openssl_error);
-                
-                RSA* public_key_rsa = RSAPublicKey_dup (private_key_rsa);
-                JUMP_IF_NULL(public_key_rsa, openssl_error);
-
-		r = EVP_PKEY_set1_RSA((EVP_PKEY *) public_key, public_key_rsa);
-		RSA_free(public_key_rsa);
-		JUMP_IF_NULL(r, error);
 	}
 
 	if (py_private_key_ndn) {
@@ -249,13 +277,11 @@ error:
 PyObject *
 _pyndn_privatekey_dup(const struct ndn_pkey *key)
 {
-	RSA *private_key_rsa;
 	PyObject *py_private_key = NULL;
 	struct ndn_pkey *private_key;
 	unsigned int err;
-	int r;
 
-	private_key = (struct ndn_pkey *) EVP_PKEY_new();
+	private_key = key_dup(key, 0);
 	JUMP_IF_NULL(private_key, openssl_error);
 
 	py_private_key = NDNObject_New(PKEY_PRIV, private_key);
@@ -264,13 +290,6 @@ _pyndn_privatekey_dup(const struct ndn_pkey *key)
 		goto error;
 	}
 
-	private_key_rsa = EVP_PKEY_get1_RSA((EVP_PKEY *) key);
-	JUMP_IF_NULL(private_key_rsa, openssl_error);
-
-	r = EVP_PKEY_set1_RSA((EVP_PKEY*) private_key, private_key_rsa);
-	RSA_free(private_key_rsa);
-	JUMP_IF_NEG(r, openssl_error);
-
 	return py_private_key;
 
 openssl_error:
@@ -278,10 +297,34 @@ openssl_error:
 	PyErr_Format(g_PyExc_NDNKeyError, "Unable to generate keypair from the key:"
 			" %s", ERR_reason_error_string(err));
 error:
-	Py_XDECREF(py_private_key);
 	return NULL;
 }
 
+// Hands a freshly generated key over to Python, consumes private_key
+
+static int
+export_generated_key(struct ndn_pkey *private_key,
+		PyObject **py_private_key_ndn, PyObject **py_public_key_ndn,
+		PyObject **py_public_key_digest, int *public_key_digest_len)
+{
+	int r;
+
+	r = ndn_keypair(0, private_key, py_private_key_ndn, py_public_key_ndn);
+	if (r < 0)
+		goto out;
+
+	r = create_public_key_digest(private_key, py_public_key_digest,
+			public_key_digest_len);
+	if (r < 0) {
+		Py_CLEAR(*py_private_key_ndn);
+		Py_CLEAR(*py_public_key_ndn);
+	}
+
+out:
+	EVP_PKEY_free((EVP_PKEY *) private_key);
+	return r;
+}
+
 //
 // Caller must free
 //
@@ -293,12 +336,12 @@ generate_key(int length, PyObject **py_private_key_ndn,
 {
 	RSA *private_key_rsa;
         struct ndn_pkey *private_key = NULL;
-	int r;
 
 	seed_prng();
 	private_key_rsa = RSA_generate_key(length, 65537, NULL, NULL);
         private_key = (struct ndn_pkey *)EVP_PKEY_new();
-        EVP_PKEY_assign_RSA ((EVP_PKEY *)private_key, private_key_rsa);
+        if (private_key && private_key_rsa)
+		EVP_PKEY_assign_RSA ((EVP_PKEY *)private_key, private_key_rsa);
 	save_seed ();
 
 	if (!private_key_rsa || !private_key) {
@@ -307,22 +350,65 @@ generate_key(int length, PyObject **py_private_key_ndn,
 		err = ERR_get_error();
 		PyErr_Format(g_PyExc_NDNKeyError, "Unable to generate the"
                              " key: %s", ERR_reason_error_string(err));
+		RSA_free(private_key_rsa);
+		EVP_PKEY_free((EVP_PKEY *) private_key);
 		return -1;
 	}
 
-	r = ndn_keypair(0, private_key, py_private_key_ndn,
-                        py_public_key_ndn);
-	if (r < 0)
-		return -1;
+	return export_generated_key(private_key, py_private_key_ndn,
+			py_public_key_ndn, py_public_key_digest, public_key_digest_len);
+}
 
-	r = create_public_key_digest(private_key, py_public_key_digest,
-                                     public_key_digest_len);
-	if (r < 0)
+//
+// ECDSA key on a named curve (e.g. "prime256v1", which is NIST P-256),
+// signing goes through the same EVP calls RSA keys use. Caller must free
+//
+
+int
+generate_ec_key(const char *curve, PyObject **py_private_key_ndn,
+		PyObject **py_public_key_ndn, PyObject **py_public_key_digest,
+		int *public_key_digest_len)
+{
+	EC_KEY *private_key_ec = NULL;
+	struct ndn_pkey *private_key = NULL;
+	unsigned int err;
+	int nid;
+
+	nid = OBJ_sn2nid(curve);
+	if (nid == NID_undef)
+		nid = EC_curve_nist2nid(curve);
+	if (nid == NID_undef) {
+		PyErr_Format(PyExc_ValueError, "unknown curve: %s", curve);
 		return -1;
+	}
 
-        EVP_PKEY_free ((EVP_PKEY*)private_key);
-        
-	return 0;
+	private_key_ec = EC_KEY_new_by_curve_name(nid);
+	JUMP_IF_NULL(private_key_ec, openssl_error);
+
+	/* keep the curve's name, not its parameters, in exported keys */
+	EC_KEY_set_asn1_flag(private_key_ec, OPENSSL_EC_NAMED_CURVE);
+
+	seed_prng();
+	if (!EC_KEY_generate_key(private_key_ec))
+		goto openssl_error;
+	save_seed();
+
+	private_key = (struct ndn_pkey *) EVP_PKEY_new();
+	JUMP_IF_NULL(private_key, openssl_error);
+
+	if (!EVP_PKEY_assign_EC_KEY((EVP_PKEY *) private_key, private_key_ec))
+		goto openssl_error;
+
+	return export_generated_key(private_key, py_private_key_ndn,
+			py_public_key_ndn, py_public_key_digest, public_key_digest_len);
+
+openssl_error:
+	err = ERR_get_error();
+	PyErr_Format(g_PyExc_NDNKeyError, "Unable to generate the key: %s",
+			ERR_reason_error_string(err));
+	EVP_PKEY_free((EVP_PKEY *) private_key);
+	EC_KEY_free(private_key_ec);
+	return -1;
 }
 
 //
@@ -621,7 +707,13 @@ put_key_der(int is_public_only, PyObject *py_key_der,
 	if (is_public_only)
           key = (struct ndn_pkey*)d2i_PUBKEY(NULL, &key_der, der_len);
 	else
-          key = (struct ndn_pkey*)d2i_PrivateKey(EVP_PKEY_RSA, NULL, &key_der, der_len);
+          key = (struct ndn_pkey*)d2i_AutoPrivateKey(NULL, &key_der, der_len);
+	if (!key) {
+		err = ERR_get_error();
+		PyErr_Format(g_PyExc_NDNKeyError, "Unable to parse key: %s",
+				ERR_reason_error_string(err));
+		goto error;
+	}
 
 	r = ndn_keypair(is_public_only, key, py_private_key_ndn, py_public_key_ndn);
 	JUMP_IF_NEG(r, error);
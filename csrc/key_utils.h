@@ -44,6 +44,10 @@ PyObject *_pyndn_privatekey_dup(const struct ndn_pkey *key);
 int generate_key(int length, PyObject **private_key_ndn,
 		PyObject **public_key_ndn, PyObject ** public_key_digest,
 		int *public_key_digest_len);
+int generate_ec_key(const char *curve, PyObject **private_key_ndn,
+		PyObject **public_key_ndn, PyObject **public_key_digest,
+		int *public_key_digest_len);
+const char *key_type_name(const struct ndn_pkey *key);
 //int generate_keypair(int length, struct keypair** KP);
 
 // We use "PEM" to make things "readable" for now
@@ -22,10 +22,47 @@
 
 // Registering callbacks
 
+// Stores a generated key in a Key object, steals the references
+
+static PyObject *
+set_generated_key(PyObject *py_key, PyObject *py_private_key,
+		PyObject *py_public_key, PyObject *py_public_key_digest,
+		const char *type)
+{
+	PyObject *py_o;
+	int r;
+
+	r = PyObject_SetAttrString(py_key, "ndn_data_private", py_private_key);
+	Py_CLEAR(py_private_key);
+	JUMP_IF_NEG(r, error);
+
+	r = PyObject_SetAttrString(py_key, "ndn_data_public", py_public_key);
+	Py_CLEAR(py_public_key);
+	JUMP_IF_NEG(r, error);
+
+	py_o = PyUnicode_FromString(type);
+	JUMP_IF_NULL(py_o, error);
+	r = PyObject_SetAttrString(py_key, "type", py_o);
+	Py_DECREF(py_o);
+	JUMP_IF_NEG(r, error);
+
+	r = PyObject_SetAttrString(py_key, "publicKeyID", py_public_key_digest);
+	Py_CLEAR(py_public_key_digest);
+	JUMP_IF_NEG(r, error);
+
+	Py_RETURN_NONE;
+
+error:
+	Py_XDECREF(py_public_key_digest);
+	Py_XDECREF(py_public_key);
+	Py_XDECREF(py_private_key);
+	return NULL;
+}
+
 PyObject *
 _pyndn_cmd_generate_RSA_key(PyObject *UNUSED(self), PyObject *args)
 {
-	PyObject *py_key, *py_o;
+	PyObject *py_key;
 	long keylen;
 	PyObject *py_private_key = NULL, *py_public_key = NULL,
 			*py_public_key_digest = NULL;
@@ -46,33 +83,38 @@ _pyndn_cmd_generate_RSA_key(PyObject *UNUSED(self), PyObject *args)
 		return NULL;
 	}
 
-	r = PyObject_SetAttrString(py_key, "ndn_data_private", py_private_key);
-	Py_CLEAR(py_private_key);
-	JUMP_IF_NEG(r, error);
+	return set_generated_key(py_key, py_private_key, py_public_key,
+			py_public_key_digest, "RSA");
+}
 
-	r = PyObject_SetAttrString(py_key, "ndn_data_public", py_public_key);
-	Py_CLEAR(py_public_key);
-	JUMP_IF_NEG(r, error);
+// arguments: Key, [curve name, prime256v1 (NIST P-256) by default]
+// returns:   None, the Key holds the new key pair
 
-	py_o = PyUnicode_FromString("RSA");
-	JUMP_IF_NULL(py_o, error);
-	r = PyObject_SetAttrString(py_key, "type", py_o);
-	Py_DECREF(py_o);
-	JUMP_IF_NEG(r, error);
+PyObject *
+_pyndn_cmd_generate_EC_key(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_key;
+	const char *curve = "prime256v1";
+	PyObject *py_private_key = NULL, *py_public_key = NULL,
+			*py_public_key_digest = NULL;
+	int public_key_digest_len, r;
 
-	r = PyObject_SetAttrString(py_key, "publicKeyID", py_public_key_digest);
-	Py_DECREF(py_public_key_digest);
-	JUMP_IF_NEG(r, error);
-        
-	Py_RETURN_NONE;
+	if (!PyArg_ParseTuple(args, "O|s", &py_key, &curve))
+		return NULL;
 
-error:
-	Py_XDECREF(py_public_key_digest);
-	Py_XDECREF(py_public_key);
-	Py_XDECREF(py_private_key);
-	return NULL;
-}
+	if (strcmp(py_key->ob_type->tp_name, "Key")) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a Key");
+		return NULL;
+	}
 
+	r = generate_ec_key(curve, &py_private_key, &py_public_key,
+			&py_public_key_digest, &public_key_digest_len);
+	if (r < 0)
+		return NULL;
+
+	return set_generated_key(py_key, py_private_key, py_public_key,
+			py_public_key_digest, "EC");
+}
 
 // ** Methods of SignedInfo
 //
@@ -219,7 +261,6 @@ _pyndn_cmd_dump_charbuf(PyObject *UNUSED(self), PyObject *py_charbuf)
 	const struct ndn_charbuf *charbuf;
 	static const enum _pyndn_capsules types[] = {
 		CONTENT_OBJECT,
-		EXCLUSION_FILTER,
 		INTEREST,
 		KEY_LOCATOR,
 		NAME,
@@ -9,6 +9,7 @@
 #  define	METHODS_H
 
 PyObject *_pyndn_cmd_generate_RSA_key(PyObject *UNUSED(self), PyObject *args);
+PyObject *_pyndn_cmd_generate_EC_key(PyObject *UNUSED(self), PyObject *args);
 PyObject *_pyndn_cmd_dump_charbuf(PyObject *self, PyObject *py_charbuf);
 PyObject *_pyndn_cmd_new_charbuf(PyObject *self, PyObject *args);
 
@@ -0,0 +1,305 @@
+/*
+ * Copyright (c) 2011, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ * Written by: Derek Kulinski <takeda@takeda.tk>
+ *             Jeff Burke <jburke@ucla.edu>
+ */
+
+#include "python_hdr.h"
+#include <ndn/ndn.h>
+
+#include <errno.h>
+#include <stdlib.h>
+
+#include "pyndn.h"
+#include "util.h"
+#include "archive.h"
+#include "methods_archive.h"
+#include "methods_contentobject.h"
+#include "methods_interest.h"
+#include "objects.h"
+#include "stats.h"
+
+// Packet archive
+//
+// Python side of archive.c. Besides lookups from Python, an archive can be
+// attached to a face with archive_serve(): interests under the prefix are
+// then answered in C, straight from the mapped data file.
+
+struct archive_server {
+	struct ndn_closure closure;
+	PyObject *py_archive;
+};
+
+static PyObject *
+archive_error(void)
+{
+	if (errno == ENOMEM)
+		return PyErr_NoMemory();
+
+	return PyErr_SetFromErrno(PyExc_IOError);
+}
+
+// arguments: path of the data file, the index is kept in <path>.idx
+// returns:   archive
+
+PyObject *
+_pyndn_cmd_archive_open(PyObject *UNUSED(self), PyObject *args)
+{
+	struct archive *archive;
+	PyObject *py_archive;
+	const char *path;
+
+	if (!PyArg_ParseTuple(args, "s", &path))
+		return NULL;
+
+	Py_BEGIN_ALLOW_THREADS
+	archive = archive_open(path);
+	Py_END_ALLOW_THREADS
+
+	if (!archive)
+		return PyErr_SetFromErrnoWithFilename(PyExc_IOError, path);
+
+	py_archive = NDNObject_New(ARCHIVE, archive);
+	if (!py_archive)
+		archive_close(&archive);
+
+	return py_archive;
+}
+
+// arguments: archive, Data's ndn_data or buffer with an encoded Data
+// returns:   None
+
+PyObject *
+_pyndn_cmd_archive_append(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_archive, *py_data;
+	struct archive *archive;
+	struct ndn_charbuf *co;
+	Py_buffer buffer;
+	int r;
+
+	if (!PyArg_ParseTuple(args, "OO", &py_archive, &py_data))
+		return NULL;
+
+	if (!NDNObject_IsValid(ARCHIVE, py_archive)) {
+		PyErr_SetString(PyExc_TypeError, "Must pass an archive as arg 1");
+		return NULL;
+	}
+	archive = NDNObject_Get(ARCHIVE, py_archive);
+
+	if (NDNObject_IsValid(CONTENT_OBJECT, py_data)) {
+		co = NDNObject_Get(CONTENT_OBJECT, py_data);
+		r = archive_append(archive, co->buf, co->length);
+	} else {
+		r = PyObject_GetBuffer(py_data, &buffer, PyBUF_SIMPLE);
+		if (r < 0)
+			return NULL;
+
+		r = archive_append(archive, buffer.buf, buffer.len);
+		PyBuffer_Release(&buffer);
+	}
+
+	if (r == -2) {
+		PyErr_SetString(g_PyExc_NDNDataError, "Unable to parse the Data");
+		return NULL;
+	}
+	if (r == -3) {
+		PyErr_SetString(PyExc_ValueError, "Data is too large for the"
+				" archive index");
+		return NULL;
+	}
+	if (r < 0)
+		return archive_error();
+
+	Py_RETURN_NONE;
+}
+
+// arguments: archive, Interest's ndn_data
+// returns:   Data satisfying the interest or None
+
+PyObject *
+_pyndn_cmd_archive_lookup(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_archive, *py_interest;
+	struct ndn_parsed_interest *pi;
+	struct ndn_charbuf *interest;
+	const unsigned char *co;
+	size_t size;
+
+	if (!PyArg_ParseTuple(args, "OO", &py_archive, &py_interest))
+		return NULL;
+
+	if (!NDNObject_IsValid(ARCHIVE, py_archive)) {
+		PyErr_SetString(PyExc_TypeError, "Must pass an archive as arg 1");
+		return NULL;
+	}
+	if (!NDNObject_IsValid(INTEREST, py_interest)) {
+		PyErr_SetString(PyExc_TypeError, "Must pass an Interest as arg 2");
+		return NULL;
+	}
+
+	interest = NDNObject_Get(INTEREST, py_interest);
+	pi = _pyndn_interest_get_pi(py_interest);
+	if (!pi)
+		return NULL;
+
+	errno = 0;
+	co = archive_match(NDNObject_Get(ARCHIVE, py_archive), interest->buf,
+			interest->length, pi, &size);
+	if (!co) {
+		if (errno)
+			return archive_error();
+		Py_RETURN_NONE;
+	}
+
+	return Data_obj_from_ndnb(co, size);
+}
+
+// arguments: archive
+// returns:   None, the index is written out
+
+PyObject *
+_pyndn_cmd_archive_flush(PyObject *UNUSED(self), PyObject *py_archive)
+{
+	struct archive *archive;
+	int r;
+
+	if (!NDNObject_IsValid(ARCHIVE, py_archive)) {
+		PyErr_SetString(PyExc_TypeError, "Must pass an archive");
+		return NULL;
+	}
+	archive = NDNObject_Get(ARCHIVE, py_archive);
+
+	Py_BEGIN_ALLOW_THREADS
+	r = archive_flush(archive);
+	Py_END_ALLOW_THREADS
+
+	if (r < 0)
+		return archive_error();
+
+	Py_RETURN_NONE;
+}
+
+// arguments: archive
+// returns:   dictionary with the number of packets and bytes stored
+
+PyObject *
+_pyndn_cmd_archive_info(PyObject *UNUSED(self), PyObject *py_archive)
+{
+	struct archive *archive;
+
+	if (!NDNObject_IsValid(ARCHIVE, py_archive)) {
+		PyErr_SetString(PyExc_TypeError, "Must pass an archive");
+		return NULL;
+	}
+	archive = NDNObject_Get(ARCHIVE, py_archive);
+
+	return Py_BuildValue("{s:n,s:n}",
+			"count", (Py_ssize_t) archive_count(archive),
+			"bytes", (Py_ssize_t) archive_bytes(archive));
+}
+
+static enum ndn_upcall_res
+archive_server_upcall(struct ndn_closure *selfp,
+		enum ndn_upcall_kind upcall_kind, struct ndn_upcall_info *info)
+{
+	struct archive_server *server = selfp->data;
+	struct handle_stats *stats = (struct handle_stats *) selfp->intdata;
+	enum ndn_upcall_res res = NDN_UPCALL_RESULT_OK;
+	const unsigned char *co;
+	PyGILState_STATE gstate;
+	long long entered;
+	size_t size;
+	int r;
+
+	debug("archive_server_upcall dispatched kind %d\n", upcall_kind);
+
+	assert(server);
+
+	/* appends from Python can move the mapping, so the GIL is needed */
+	entered = handle_stats_upcall_enter(selfp, upcall_kind, info, &gstate);
+
+	switch (upcall_kind) {
+	case NDN_UPCALL_FINAL:
+		Py_DECREF(server->py_archive);
+		free(server);
+		break;
+	case NDN_UPCALL_INTEREST:
+		co = archive_match(NDNObject_Get(ARCHIVE, server->py_archive),
+				info->interest_ndnb, info->pi->offset[NDN_PI_E],
+				info->pi, &size);
+		if (!co)
+			break;
+
+		r = ndn_put(info->h, co, size);
+		if (r < 0) {
+			debug("Unable to put archived Data\n");
+			break;
+		}
+		handle_stats_put(stats, size);
+		res = NDN_UPCALL_RESULT_INTEREST_CONSUMED;
+		break;
+	default:
+		break;
+	}
+
+	handle_stats_upcall_leave(stats, entered, upcall_kind, info,
+			"ArchiveServer", gstate);
+
+	return res;
+}
+
+// arguments: NDN handle, archive, Name
+// returns:   None, interests under the name are answered from the archive
+//            until the filter is cleared
+
+PyObject *
+_pyndn_cmd_archive_serve(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_handle, *py_archive, *py_name;
+	struct archive_server *server;
+	struct ndn *handle;
+	int r;
+
+	if (!PyArg_ParseTuple(args, "OOO", &py_handle, &py_archive, &py_name))
+		return NULL;
+
+	if (!NDNObject_IsValid(HANDLE, py_handle)) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a NDN handle as arg 1");
+		return NULL;
+	}
+	if (!NDNObject_IsValid(ARCHIVE, py_archive)) {
+		PyErr_SetString(PyExc_TypeError, "Must pass an archive as arg 2");
+		return NULL;
+	}
+	if (!NDNObject_IsValid(NAME, py_name)) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a NDN Name as arg 3");
+		return NULL;
+	}
+
+	handle = NDNObject_Get(HANDLE, py_handle);
+
+	server = calloc(1, sizeof(*server));
+	if (!server)
+		return PyErr_NoMemory();
+
+	server->closure.p = archive_server_upcall;
+	server->closure.data = server;
+	server->closure.intdata = (intptr_t) _pyndn_handle_get_stats(py_handle);
+	Py_INCREF(py_archive);
+	server->py_archive = py_archive;
+
+	r = ndn_set_interest_filter(handle, NDNObject_Get(NAME, py_name),
+			&server->closure);
+	if (r < 0) {
+		int err = ndn_geterror(handle);
+
+		Py_DECREF(py_archive);
+		free(server);
+		return PyErr_Format(PyExc_IOError, "Unable to set an interest"
+				" filter: %s [%d]", strerror(err), err);
+	}
+
+	Py_RETURN_NONE;
+}
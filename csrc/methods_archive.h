@@ -0,0 +1,18 @@
+/*
+ * Copyright (c) 2011, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ * Written by: Derek Kulinski <takeda@takeda.tk>
+ *             Jeff Burke <jburke@ucla.edu>
+ */
+
+#ifndef METHODS_ARCHIVE_H
+#  define	METHODS_ARCHIVE_H
+
+PyObject *_pyndn_cmd_archive_open(PyObject *self, PyObject *args);
+PyObject *_pyndn_cmd_archive_append(PyObject *self, PyObject *args);
+PyObject *_pyndn_cmd_archive_lookup(PyObject *self, PyObject *args);
+PyObject *_pyndn_cmd_archive_flush(PyObject *self, PyObject *py_archive);
+PyObject *_pyndn_cmd_archive_info(PyObject *self, PyObject *py_archive);
+PyObject *_pyndn_cmd_archive_serve(PyObject *self, PyObject *args);
+
+#endif	/* METHODS_ARCHIVE_H */
@@ -9,6 +9,9 @@
 #include <ndn/ndn.h>
 #include <ndn/signing.h>
 
+#include <stdlib.h>
+#include <string.h>
+
 #include "pyndn.h"
 #include "util.h"
 #include "methods_contentobject.h"
@@ -18,6 +21,8 @@
 #include "methods_signature.h"
 #include "methods_signedinfo.h"
 #include "objects.h"
+#include "sign_symmetric.h"
+#include "signing_cache.h"
 
 static PyObject *
 Content_from_ndn_parsed(struct ndn_charbuf *content_object,
@@ -262,17 +267,109 @@ error:
   return NULL;
 }
 
+/* Data object from raw ndnb bytes, e.g. content received in an upcall */
+PyObject *
+Data_obj_from_ndnb(const unsigned char *buf, size_t size)
+{
+	PyObject *py_data, *py_o;
+	struct ndn_charbuf *data;
+	int r;
+
+	py_data = NDNObject_New_charbuf(CONTENT_OBJECT, &data);
+	if (!py_data)
+		return NULL;
+
+	r = ndn_charbuf_append(data, buf, size);
+	if (r < 0) {
+		Py_DECREF(py_data);
+		return PyErr_NoMemory();
+	}
+
+	py_o = Data_obj_from_ndn(py_data);
+	Py_DECREF(py_data);
+
+	return py_o;
+}
+
+/*
+ * Signature and SignedInfo are rarely looked at on received Data, so
+ * Data.__getattr__ decodes them from the stored offsets on first access
+ */
+static PyObject *
+Signature_obj_from_ndn_parsed(PyObject *py_content_object)
+{
+	struct ndn_charbuf *content_object, *signature;
+	struct ndn_parsed_Data *pco;
+	PyObject *py_signature, *py_o;
+	int r;
+
+	assert(NDNObject_IsValid(CONTENT_OBJECT, py_content_object));
+
+	content_object = NDNObject_Get(CONTENT_OBJECT, py_content_object);
+	pco = _pyndn_content_object_get_pco(py_content_object);
+	if (!pco)
+		return NULL;
+
+	py_signature = NDNObject_New_charbuf(SIGNATURE, &signature);
+	if (!py_signature)
+		return NULL;
+
+	r = ndn_charbuf_append(signature,
+			&content_object->buf[pco->offset[NDN_PCO_B_Signature]],
+			(size_t) (pco->offset[NDN_PCO_E_Signature]
+			- pco->offset[NDN_PCO_B_Signature]));
+	if (r < 0) {
+		Py_DECREF(py_signature);
+		return PyErr_NoMemory();
+	}
+
+	py_o = Signature_obj_from_ndn(py_signature);
+	Py_DECREF(py_signature);
+
+	return py_o;
+}
+
+static PyObject *
+SignedInfo_obj_from_ndn_parsed(PyObject *py_content_object)
+{
+	struct ndn_charbuf *content_object, *signed_info;
+	struct ndn_parsed_Data *pco;
+	PyObject *py_signed_info, *py_o;
+	int r;
+
+	assert(NDNObject_IsValid(CONTENT_OBJECT, py_content_object));
+
+	content_object = NDNObject_Get(CONTENT_OBJECT, py_content_object);
+	pco = _pyndn_content_object_get_pco(py_content_object);
+	if (!pco)
+		return NULL;
+
+	py_signed_info = NDNObject_New_charbuf(SIGNED_INFO, &signed_info);
+	if (!py_signed_info)
+		return NULL;
+
+	r = ndn_charbuf_append(signed_info,
+			&content_object->buf[pco->offset[NDN_PCO_B_SignedInfo]],
+			(size_t) (pco->offset[NDN_PCO_E_SignedInfo]
+			- pco->offset[NDN_PCO_B_SignedInfo]));
+	if (r < 0) {
+		Py_DECREF(py_signed_info);
+		return PyErr_NoMemory();
+	}
+
+	py_o = SignedInfo_obj_from_ndn(py_signed_info);
+	Py_DECREF(py_signed_info);
+
+	return py_o;
+}
+
 PyObject *
 Data_obj_from_ndn(PyObject *py_content_object)
 {
 	struct ndn_charbuf *content_object;
 	struct ndn_parsed_Data *parsed_content_object;
-	PyObject *py_obj_Data, *py_o;
+	PyObject *py_type, *py_obj_Data, *py_o;
 	int r;
-	struct ndn_charbuf *signature;
-	PyObject *py_signature;
-	struct ndn_charbuf *signed_info;
-	PyObject *py_signed_info;
 
 	if (!NDNObject_ReqType(CONTENT_OBJECT, py_content_object))
 		return NULL;
@@ -285,7 +382,16 @@ Data_obj_from_ndn(PyObject *py_content_object)
 	debug("Data_from_ndn_parsed content_object->length=%zd\n",
 			content_object->length);
 
-	py_obj_Data = PyObject_CallObject(g_type_Data, NULL);
+	/*
+	 * Data.__init__() is skipped, it would only build a Name and a
+	 * SignedInfo which get replaced; signedInfo and signature are left
+	 * unset and decoded by Data.__getattr__() when they're first read
+	 */
+	py_type = g_type_Data;
+	if (!py_type)
+		return NULL;
+
+	py_obj_Data = PyType_GenericNew((PyTypeObject *) py_type, NULL, NULL);
 	if (!py_obj_Data)
 		return NULL;
 
@@ -303,54 +409,26 @@ Data_obj_from_ndn(PyObject *py_content_object)
 	Py_DECREF(py_o);
 	JUMP_IF_NEG(r, error);
 
-	/* Signature */
-	debug("Data_from_ndn_parsed Signature\n");
-	py_signature = NDNObject_New_charbuf(SIGNATURE, &signature);
-	JUMP_IF_NULL(py_signature, error);
-	r = ndn_charbuf_append(signature,
-			&content_object->buf[parsed_content_object->offset[NDN_PCO_B_Signature]],
-			(size_t) (parsed_content_object->offset[NDN_PCO_E_Signature]
-			- parsed_content_object->offset[NDN_PCO_B_Signature]));
-	if (r < 0) {
-		PyErr_NoMemory();
-		Py_DECREF(py_signature);
-		goto error;
-	}
-
-	py_o = Signature_obj_from_ndn(py_signature);
-	Py_DECREF(py_signature);
-	JUMP_IF_NULL(py_o, error);
-	r = PyObject_SetAttrString(py_obj_Data, "signature", py_o);
-	Py_DECREF(py_o);
-	JUMP_IF_NEG(r, error);
-
-	debug("Data_from_ndn_parsed SignedInfo\n");
-
-	py_signed_info = NDNObject_New_charbuf(SIGNED_INFO, &signed_info);
-	JUMP_IF_NULL(py_signed_info, error);
-
-	r = ndn_charbuf_append(signed_info,
-			&content_object->buf[parsed_content_object->offset[NDN_PCO_B_SignedInfo]],
-			(size_t) (parsed_content_object->offset[NDN_PCO_E_SignedInfo]
-			- parsed_content_object->offset[NDN_PCO_B_SignedInfo]));
-	if (r < 0) {
-		PyErr_NoMemory();
-		Py_DECREF(py_signed_info);
-		goto error;
+	debug("Data_from_ndn_parsed DigestAlgorithm\n");
+	// None for public key signatures, even ones naming SHA-256 as their
+	// digest (Signature.digestAlgorithm has whatever the packet says)
+	switch (sign_symmetric_packet_alg(content_object->buf,
+			parsed_content_object)) {
+	case SIGN_SYMMETRIC_DIGEST:
+		py_o = PyUnicode_FromString(SIGN_SYMMETRIC_SHA256);
+		break;
+	case SIGN_SYMMETRIC_HMAC:
+		py_o = PyUnicode_FromString(SIGN_SYMMETRIC_HMAC_SHA256);
+		break;
+	default:
+		py_o = Py_None;
+		Py_INCREF(py_o);
 	}
-
-	py_o = SignedInfo_obj_from_ndn(py_signed_info);
-	Py_DECREF(py_signed_info);
 	JUMP_IF_NULL(py_o, error);
-	r = PyObject_SetAttrString(py_obj_Data, "signedInfo", py_o);
+	r = PyObject_SetAttrString(py_obj_Data, "digestAlgorithm", py_o);
 	Py_DECREF(py_o);
 	JUMP_IF_NEG(r, error);
 
-	debug("Data_from_ndn_parsed DigestAlgorithm\n");
-	// TODO...  Note this seems to default to nothing in the library...?
-	r = PyObject_SetAttrString(py_obj_Data, "digestAlgorithm", Py_None);
-	JUMP_IF_NEG(r, error);
-
 	/* Original data  */
 	debug("Data_from_ndn_parsed ndn_data\n");
 	r = PyObject_SetAttrString(py_obj_Data, "ndn_data", py_content_object);
@@ -430,6 +508,133 @@ _pyndn_cmd_content_to_bytes(PyObject *UNUSED(self), PyObject *arg)
 	return PyObject_Bytes(arg);
 }
 
+static struct signing_cache *
+signing_cache(void)
+{
+	struct pyndn_state *state = GETSTATE(_pyndn_module);
+
+	if (!state->signing_cache)
+		state->signing_cache = signing_cache_create(
+				SIGNING_CACHE_DEFAULT_BUDGET);
+
+	return state->signing_cache;
+}
+
+// Looks up a packet signed earlier from the same inputs, see
+// signing_cache.c. Returns 1 and fills key when the result should be
+// stored after signing, 0 when the cache isn't used.
+
+static int
+signing_cache_prepare(struct signing_cache *cache, unsigned char *key,
+		const struct ndn_charbuf *name, const char *content,
+		Py_ssize_t content_len, const struct ndn_charbuf *signed_info,
+		PyObject *py_key)
+{
+	PyObject *py_key_id;
+	int r;
+
+	if (!cache || !signing_cache_enabled(cache))
+		return 0;
+
+	py_key_id = PyObject_GetAttrString(py_key, "publicKeyID");
+	if (!py_key_id)
+		return -1;
+
+	if (!PyBytes_Check(py_key_id)) {
+		Py_DECREF(py_key_id);
+		return 0;
+	}
+
+	r = signing_cache_key(cache, key, name, content, content_len,
+			signed_info, PyBytes_AS_STRING(py_key_id),
+			PyBytes_GET_SIZE(py_key_id));
+	Py_DECREF(py_key_id);
+
+	return r < 0 ? 0 : 1;
+}
+
+// DigestAlgorithm set on the Data, SIGN_SYMMETRIC_NONE when it's signed
+// with a key pair
+
+static int
+Data_signing_alg(PyObject *py_content_object, enum sign_symmetric_alg *alg)
+{
+	PyObject *py_digest_alg, *py_o;
+	char *str;
+	Py_ssize_t str_len;
+
+	*alg = SIGN_SYMMETRIC_NONE;
+
+	if (!PyObject_HasAttrString(py_content_object, "digestAlgorithm"))
+		return 0;
+
+	py_digest_alg = PyObject_GetAttrString(py_content_object,
+			"digestAlgorithm");
+	if (!py_digest_alg)
+		return -1;
+
+	if (py_digest_alg == Py_None) {
+		Py_DECREF(py_digest_alg);
+		return 0;
+	}
+
+	py_o = _pyndn_unicode_to_utf8(py_digest_alg, &str, &str_len);
+	Py_DECREF(py_digest_alg);
+	if (!py_o)
+		return -1;
+
+	*alg = sign_symmetric_alg(str, str_len);
+	if (*alg == SIGN_SYMMETRIC_NONE)
+		PyErr_Format(PyExc_NotImplementedError, "digest algorithm %s is"
+				" not supported", str);
+	Py_DECREF(py_o);
+
+	return *alg == SIGN_SYMMETRIC_NONE ? -1 : 0;
+}
+
+static PyObject *
+encode_Data_symmetric(const struct ndn_charbuf *name,
+		const struct ndn_charbuf *signed_info, const char *content,
+		Py_ssize_t content_len, enum sign_symmetric_alg alg,
+		PyObject *py_secret)
+{
+	struct ndn_charbuf *content_object;
+	const char *secret = NULL;
+	Py_ssize_t secret_len = 0;
+	int r;
+
+	if (alg == SIGN_SYMMETRIC_HMAC) {
+		secret = PyBytes_AS_STRING(py_secret);
+		secret_len = PyBytes_GET_SIZE(py_secret);
+	}
+
+	content_object = ndn_charbuf_create();
+	JUMP_IF_NULL_MEM(content_object, error);
+
+	r = sign_symmetric_encode(content_object, name, signed_info, content,
+			content_len, alg, secret, secret_len);
+	if (r == -2) {
+		ndn_charbuf_destroy(&content_object);
+		PyErr_SetString(PyExc_ValueError, "Data signed with a digest or"
+				" HMAC can't have a KeyLocator");
+		goto error;
+	} else if (r < 0) {
+		ndn_charbuf_destroy(&content_object);
+		PyErr_SetString(g_PyExc_NDNError, "Unable to encode Data");
+		goto error;
+	}
+
+	return NDNObject_New(CONTENT_OBJECT, content_object);
+
+error:
+	return NULL;
+}
+
+// arguments: Data, Name's ndn_data, content (bytes or None),
+//            SignedInfo's ndn_data, Key (the secret as bytes for HMAC,
+//            ignored for a digest), [use the signing cache, off by default]
+// returns:   encoded ContentObject
+
 PyObject *
 _pyndn_cmd_encode_Data(PyObject *UNUSED(self), PyObject *args)
 {
@@ -437,14 +642,18 @@ _pyndn_cmd_encode_Data(PyObject *UNUSED(self), PyObject *args)
 			*py_key;
 	PyObject *py_o = NULL, *ret = NULL;
 	struct ndn_charbuf *name, *signed_info, *content_object = NULL;
+	const struct ndn_charbuf *cached;
+	struct signing_cache *cache = NULL;
+	enum sign_symmetric_alg alg;
+	unsigned char cache_key[SIGNING_CACHE_KEY_SIZE];
 	struct ndn_pkey *private_key;
 	const char *digest_alg = NULL;
 	char *content;
 	Py_ssize_t content_len;
-	int r;
+	int use_cache = 0, r;
 
-	if (!PyArg_ParseTuple(args, "OOOOO", &py_content_object, &py_name,
-			&py_content, &py_signed_info, &py_key))
+	if (!PyArg_ParseTuple(args, "OOOOO|i", &py_content_object, &py_name,
+			&py_content, &py_signed_info, &py_key, &use_cache))
 		return NULL;
 
 	if (strcmp(py_content_object->ob_type->tp_name, "Data")) {
@@ -476,19 +685,50 @@ _pyndn_cmd_encode_Data(PyObject *UNUSED(self), PyObject *args)
 	} else
 		signed_info = NDNObject_Get(SIGNED_INFO, py_signed_info);
 
-	if (strcmp(py_key->ob_type->tp_name, "Key")) {
-		PyErr_SetString(PyExc_TypeError, "Must pass a Key as arg 4");
+	// DigestAlgorithm
+	r = Data_signing_alg(py_content_object, &alg);
+	if (r < 0)
 		return NULL;
+
+	if (alg == SIGN_SYMMETRIC_HMAC && !PyBytes_Check(py_key)) {
+		PyErr_SetString(PyExc_TypeError, "Must pass the HMAC secret as"
+				" bytes as arg 5");
+		return NULL;
+	} else if (alg == SIGN_SYMMETRIC_NONE &&
+			strcmp(py_key->ob_type->tp_name, "Key")) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a Key as arg 5");
+		return NULL;
+	}
+
+	if (alg != SIGN_SYMMETRIC_NONE)
+		return encode_Data_symmetric(name, signed_info, content,
+				content_len, alg, py_key);
+
+	if (use_cache) {
+		cache = signing_cache();
+		r = signing_cache_prepare(cache, cache_key, name, content,
+				content_len, signed_info, py_key);
+		JUMP_IF_NEG(r, error);
+		if (!r)
+			cache = NULL;
 	}
 
-	// // DigestAlgorithm
-	// py_o = PyObject_GetAttrString(py_content_object, "digestAlgorithm");
-	// if (py_o != Py_None) {
-	// 	PyErr_SetString(PyExc_NotImplementedError, "non-default digest"
-	// 			" algorithm not yet supported");
-	// 	goto error;
-	// }
-	// Py_CLEAR(py_o);
+	if (cache) {
+		cached = signing_cache_lookup(cache, cache_key);
+		if (cached) {
+			content_object = ndn_charbuf_create();
+			JUMP_IF_NULL_MEM(content_object, error);
+
+			r = ndn_charbuf_append_charbuf(content_object, cached);
+			if (r < 0) {
+				ndn_charbuf_destroy(&content_object);
+				PyErr_NoMemory();
+				goto error;
+			}
+
+			return NDNObject_New(CONTENT_OBJECT, content_object);
+		}
+	}
 
 	// Key
 	private_key = Key_to_ndn_private(py_key);
@@ -514,6 +754,10 @@ _pyndn_cmd_encode_Data(PyObject *UNUSED(self), PyObject *args)
 		goto error;
 	}
 
+	// a packet the cache can't keep is still a valid result
+	if (cache)
+		signing_cache_store(cache, cache_key, content_object);
+
 	ret = NDNObject_New(CONTENT_OBJECT, content_object);
 
 error:
@@ -521,18 +765,395 @@ error:
 	return ret;
 }
 
+// arguments: [budget in bytes, 0 disables the cache]
+// returns:   dict with hits, misses, evictions, entries, bytes and budget
+
+PyObject *
+_pyndn_cmd_signing_cache(PyObject *UNUSED(self), PyObject *args)
+{
+	struct signing_cache *cache;
+	struct signing_cache_stats stats;
+	PyObject *py_budget = Py_None;
+	long long budget;
+
+	if (!PyArg_ParseTuple(args, "|O", &py_budget))
+		return NULL;
+
+	cache = signing_cache();
+	JUMP_IF_NULL_MEM(cache, error);
+
+	if (py_budget != Py_None) {
+		budget = PyLong_AsLongLong(py_budget);
+		if (budget == -1 && PyErr_Occurred())
+			return NULL;
+
+		if (budget < 0) {
+			PyErr_SetString(PyExc_ValueError, "budget can't be negative");
+			return NULL;
+		}
+
+		signing_cache_set_budget(cache, (size_t) budget);
+	}
+
+	signing_cache_get_stats(cache, &stats);
+
+	return Py_BuildValue("{s:K,s:K,s:K,s:n,s:n,s:n}",
+			"hits", stats.hits,
+			"misses", stats.misses,
+			"evictions", stats.evictions,
+			"entries", (Py_ssize_t) stats.entries,
+			"bytes", (Py_ssize_t) stats.bytes,
+			"budget", (Py_ssize_t) stats.budget);
+
+error:
+	return NULL;
+}
+
 PyObject *
 _pyndn_cmd_Data_obj_from_ndn(PyObject *UNUSED(self), PyObject *py_co)
 {
 	return Data_obj_from_ndn(py_co);
 }
 
+// arguments: Data's ndn_data
+// returns:   Signature decoded from the stored offsets
+
+PyObject *
+_pyndn_cmd_Data_signature(PyObject *UNUSED(self), PyObject *py_co)
+{
+	if (!NDNObject_ReqType(CONTENT_OBJECT, py_co))
+		return NULL;
+
+	return Signature_obj_from_ndn_parsed(py_co);
+}
+
+// arguments: Data's ndn_data
+// returns:   SignedInfo decoded from the stored offsets
+
+PyObject *
+_pyndn_cmd_Data_signed_info(PyObject *UNUSED(self), PyObject *py_co)
+{
+	if (!NDNObject_ReqType(CONTENT_OBJECT, py_co))
+		return NULL;
+
+	return SignedInfo_obj_from_ndn_parsed(py_co);
+}
+
 PyObject *
 _pyndn_cmd_Data_obj_from_ndn_buffer(PyObject *UNUSED(self), PyObject *py_buffer)
 {
 	return Data_obj_from_ndn_buffer(py_buffer);
 }
 
+// Data headers
+//
+// peek_data() is for code which only routes Data: the packet is parsed
+// once into a stack allocated ndn_parsed_Data and what's returned are
+// offsets into the caller's buffer plus the few small SignedInfo fields,
+// no charbufs are copied and no Name, SignedInfo or Signature objects are
+// created.
+
+static PyStructSequence_Field g_data_header_fields[] = {
+	{"size", "length of the encoded Data"},
+	{"name_start", "offset of the Name element"},
+	{"name_end", "offset past the Name element"},
+	{"name_components", "number of name components"},
+	{"content_start", "offset of the content value"},
+	{"content_end", "offset past the content value"},
+	{"type", "content type (CONTENT_DATA, CONTENT_KEY, ...)"},
+	{"freshness", "FreshnessSeconds, None if not present"},
+	{"final_block_id", "FinalBlockID, None if not present"},
+	{NULL, NULL}
+};
+
+static PyStructSequence_Desc g_data_header_desc = {
+	"ndn._pyndn.DataHeader",
+	"Offsets and header fields of an encoded Data",
+	g_data_header_fields,
+	9
+};
+
+static PyTypeObject g_DataHeaderType;
+
+int
+_pyndn_init_data_header(PyObject *module)
+{
+#if PY_MAJOR_VERSION >= 3
+	if (PyStructSequence_InitType2(&g_DataHeaderType,
+			&g_data_header_desc) < 0)
+		return -1;
+#else
+	PyStructSequence_InitType(&g_DataHeaderType, &g_data_header_desc);
+#endif
+
+	Py_INCREF(&g_DataHeaderType);
+	return PyModule_AddObject(module, "DataHeader",
+			(PyObject *) &g_DataHeaderType);
+}
+
+static PyObject *
+optional_freshness(const unsigned char *buf,
+		const struct ndn_parsed_Data *pco)
+{
+	int r;
+
+	r = ndn_fetch_tagged_nonNegativeInteger(NDN_DTAG_FreshnessSeconds, buf,
+			pco->offset[NDN_PCO_B_FreshnessSeconds],
+			pco->offset[NDN_PCO_E_FreshnessSeconds]);
+	if (r < 0)
+		Py_RETURN_NONE;
+
+	return _pyndn_Int_FromLong(r);
+}
+
+static PyObject *
+optional_final_block_id(const unsigned char *buf,
+		const struct ndn_parsed_Data *pco)
+{
+	const unsigned char *ptr;
+	size_t size;
+	int r;
+
+	r = ndn_ref_tagged_BLOB(NDN_DTAG_FinalBlockID, buf,
+			pco->offset[NDN_PCO_B_FinalBlockID],
+			pco->offset[NDN_PCO_E_FinalBlockID], &ptr, &size);
+	if (r < 0)
+		Py_RETURN_NONE;
+
+	return PyBytes_FromStringAndSize((const char *) ptr, size);
+}
+
+/* offsets in the header are shifted by base, the packet's position */
+static PyObject *
+DataHeader_from_parsed(const unsigned char *buf, size_t size, size_t base,
+		const struct ndn_parsed_Data *pco)
+{
+	const unsigned char *value;
+	size_t value_size;
+	PyObject *py_header;
+	int r;
+
+	r = ndn_content_get_value(buf, size, pco, &value, &value_size);
+	if (r < 0)
+		return PyErr_Format(g_PyExc_NDNError, "ndn_content_get_value()"
+				" returned %d", r);
+
+	py_header = PyStructSequence_New(&g_DataHeaderType);
+	if (!py_header)
+		return NULL;
+
+	PyStructSequence_SET_ITEM(py_header, 0,
+			_pyndn_Int_FromLong(pco->offset[NDN_PCO_E]));
+	PyStructSequence_SET_ITEM(py_header, 1,
+			_pyndn_Int_FromLong(base + pco->offset[NDN_PCO_B_Name]));
+	PyStructSequence_SET_ITEM(py_header, 2,
+			_pyndn_Int_FromLong(base + pco->offset[NDN_PCO_E_Name]));
+	PyStructSequence_SET_ITEM(py_header, 3,
+			_pyndn_Int_FromLong(pco->name_ncomps));
+	PyStructSequence_SET_ITEM(py_header, 4,
+			_pyndn_Int_FromLong(base + (value - buf)));
+	PyStructSequence_SET_ITEM(py_header, 5,
+			_pyndn_Int_FromLong(base + (value - buf) + value_size));
+	PyStructSequence_SET_ITEM(py_header, 6, _pyndn_Int_FromLong(pco->type));
+	PyStructSequence_SET_ITEM(py_header, 7, optional_freshness(buf, pco));
+	PyStructSequence_SET_ITEM(py_header, 8,
+			optional_final_block_id(buf, pco));
+
+	/* unset items are NULL, which the struct sequence can deallocate */
+	if (PyErr_Occurred())
+		Py_CLEAR(py_header);
+
+	return py_header;
+}
+
+// arguments: object supporting the buffer protocol with an encoded Data
+// returns:   DataHeader
+
+PyObject *
+_pyndn_cmd_peek_data(PyObject *UNUSED(self), PyObject *py_buffer)
+{
+	struct ndn_parsed_Data pco;
+	Py_buffer buffer;
+	PyObject *py_header = NULL;
+	int r;
+
+	r = PyObject_GetBuffer(py_buffer, &buffer, PyBUF_SIMPLE);
+	if (r < 0)
+		return NULL;
+
+	r = ndn_parse_Data(buffer.buf, buffer.len, &pco, NULL);
+	if (r < 0)
+		PyErr_SetString(g_PyExc_NDNDataError, "Unable to parse the Data");
+	else
+		py_header = DataHeader_from_parsed(buffer.buf, buffer.len, 0,
+				&pco);
+
+	PyBuffer_Release(&buffer);
+	return py_header;
+}
+
+// Data streams
+//
+// Log and repository files are plain concatenations of ndnb Data. The
+// framing pass only runs the skeleton decoder over the buffer, so it can
+// run without the GIL; packets are then parsed one by one into the same
+// ndn_parsed_Data.
+
+/*
+ * Ends of the complete top level elements in buf, returns their count or
+ * -1 when the stream is malformed (*bad is the offset of the bad element)
+ * or out of memory (*bad is -1). Called without the GIL.
+ */
+static ssize_t
+frame_stream(const unsigned char *buf, size_t size, size_t **endsp,
+		ssize_t *bad)
+{
+	struct ndn_skeleton_decoder d;
+	size_t *ends = NULL, *p, limit = 0, start = 0;
+	ssize_t n = 0;
+
+	memset(&d, 0, sizeof(d));
+
+	while ((size_t) d.index < size) {
+		ndn_skeleton_decode(&d, buf + d.index, size - d.index);
+		if (d.state < 0) {
+			*bad = start;
+			goto error;
+		}
+
+		/* the rest is a partial element */
+		if (!NDN_FINAL_DSTATE(d.state))
+			break;
+
+		if ((size_t) n == limit) {
+			limit = limit ? limit * 2 : 64;
+			p = realloc(ends, limit * sizeof(*ends));
+			if (!p) {
+				*bad = -1;
+				goto error;
+			}
+			ends = p;
+		}
+
+		ends[n++] = start = d.index;
+	}
+
+	*endsp = ends;
+	return n;
+
+error:
+	free(ends);
+	return -1;
+}
+
+/* Data object which takes over the parsed offsets instead of parsing again */
+static PyObject *
+Data_obj_from_parsed(const unsigned char *buf, size_t size,
+		const struct ndn_parsed_Data *pco)
+{
+	struct ndn_parsed_Data *copy;
+	struct ndn_charbuf *data;
+	PyObject *py_data, *py_o;
+	int r;
+
+	py_data = NDNObject_New_charbuf(CONTENT_OBJECT, &data);
+	if (!py_data)
+		return NULL;
+
+	r = ndn_charbuf_append(data, buf, size);
+	JUMP_IF_NEG_MEM(r, error);
+
+	copy = malloc(sizeof(*copy));
+	JUMP_IF_NULL_MEM(copy, error);
+	memcpy(copy, pco, sizeof(*copy));
+	_pyndn_content_object_set_pco(py_data, copy);
+
+	py_o = Data_obj_from_ndn(py_data);
+	Py_DECREF(py_data);
+
+	return py_o;
+
+error:
+	Py_DECREF(py_data);
+	return NULL;
+}
+
+// arguments: buffer with concatenated Data, [return Data objects (default)
+//            or DataHeaders with offsets into the buffer], [release the GIL
+//            while framing]
+// returns:   (list, number of bytes decoded), a partial packet at the end
+//            is left for the next call
+
+PyObject *
+_pyndn_cmd_decode_data_stream(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_buffer, *py_list = NULL, *py_o, *py_res = NULL;
+	int objects = 1, nogil = 0;
+	struct ndn_parsed_Data pco;
+	const unsigned char *buf;
+	Py_buffer buffer;
+	size_t *ends = NULL, start;
+	ssize_t n, bad = 0, i;
+	int r;
+
+	if (!PyArg_ParseTuple(args, "O|ii", &py_buffer, &objects, &nogil))
+		return NULL;
+
+	r = PyObject_GetBuffer(py_buffer, &buffer, PyBUF_SIMPLE);
+	if (r < 0)
+		return NULL;
+	buf = buffer.buf;
+
+	if (nogil) {
+		Py_BEGIN_ALLOW_THREADS
+		n = frame_stream(buf, buffer.len, &ends, &bad);
+		Py_END_ALLOW_THREADS
+	} else
+		n = frame_stream(buf, buffer.len, &ends, &bad);
+
+	if (n < 0) {
+		if (bad < 0)
+			PyErr_NoMemory();
+		else
+			PyErr_Format(g_PyExc_NDNDataError, "Malformed element at"
+					" offset %zd", bad);
+		goto out;
+	}
+
+	py_list = PyList_New(n);
+	if (!py_list)
+		goto out;
+
+	for (i = 0, start = 0; i < n; start = ends[i++]) {
+		r = ndn_parse_Data(buf + start, ends[i] - start, &pco, NULL);
+		if (r < 0) {
+			PyErr_Format(g_PyExc_NDNDataError, "Unable to parse the"
+					" Data at offset %zu", start);
+			goto out;
+		}
+
+		if (objects)
+			py_o = Data_obj_from_parsed(buf + start, ends[i] - start,
+					&pco);
+		else
+			py_o = DataHeader_from_parsed(buf + start,
+					ends[i] - start, start, &pco);
+		if (!py_o)
+			goto out;
+
+		PyList_SET_ITEM(py_list, i, py_o);
+	}
+
+	py_res = Py_BuildValue("(On)", py_list,
+			(Py_ssize_t) (n ? ends[n - 1] : 0));
+
+out:
+	Py_XDECREF(py_list);
+	free(ends);
+	PyBuffer_Release(&buffer);
+	return py_res;
+}
+
 PyObject *
 _pyndn_cmd_digest_contentobject(PyObject *UNUSED(self), PyObject *args)
 {
@@ -697,3 +1318,53 @@ _pyndn_cmd_verify_signature(PyObject *UNUSED(self), PyObject *args)
 
 	return Py_INCREF(res), res;
 }
+
+// arguments: Data's ndn_data, [HMAC secret]
+// returns:   whether the digest or HMAC in the Data matches
+
+PyObject *
+_pyndn_cmd_verify_symmetric(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_content_object, *py_secret = Py_None;
+	PyObject *res;
+	struct ndn_charbuf *content_object;
+	struct ndn_parsed_Data *pco;
+	const char *secret = NULL;
+	Py_ssize_t secret_len = 0;
+	int r;
+
+	if (!PyArg_ParseTuple(args, "O|O", &py_content_object, &py_secret))
+		return NULL;
+
+	if (!NDNObject_IsValid(CONTENT_OBJECT, py_content_object)) {
+		PyErr_SetString(PyExc_TypeError, "argument 1 must be NDN"
+				" Data");
+		return NULL;
+	}
+
+	if (py_secret != Py_None) {
+		if (!PyBytes_Check(py_secret)) {
+			PyErr_SetString(PyExc_TypeError, "argument 2 must be bytes");
+			return NULL;
+		}
+		secret = PyBytes_AS_STRING(py_secret);
+		secret_len = PyBytes_GET_SIZE(py_secret);
+	}
+
+	content_object = NDNObject_Get(CONTENT_OBJECT, py_content_object);
+	pco = _pyndn_content_object_get_pco(py_content_object);
+	if (!pco)
+		return NULL;
+
+	r = sign_symmetric_verify(content_object->buf, content_object->length,
+			pco, secret, secret_len);
+	if (r < 0) {
+		PyErr_SetString(g_PyExc_NDNSignatureError, "Data isn't signed with"
+				" a digest or HMAC");
+		return NULL;
+	}
+
+	res = r ? Py_True : Py_False;
+
+	return Py_INCREF(res), res;
+}
@@ -21,16 +21,24 @@ void _pyndn_content_object_set_comps(PyObject *py_content_object,
 		struct ndn_indexbuf *comps);
 PyObject *Data_obj_from_ndn(PyObject *py_content_object);
 PyObject *Data_obj_from_ndn_buffer (PyObject *py_buffer);
+PyObject *Data_obj_from_ndnb(const unsigned char *buf, size_t size);
 
 PyObject *_pyndn_cmd_content_to_bytes(PyObject *self, PyObject *arg);
 PyObject *_pyndn_cmd_content_to_bytearray(PyObject *self, PyObject *arg);
 PyObject *_pyndn_cmd_encode_Data(PyObject *self, PyObject *args);
+PyObject *_pyndn_cmd_signing_cache(PyObject *self, PyObject *args);
 PyObject *_pyndn_cmd_Data_obj_from_ndn(PyObject *self, PyObject *py_co);
 PyObject *_pyndn_cmd_Data_obj_from_ndn_buffer(PyObject *self, PyObject *py_co);
+PyObject *_pyndn_cmd_Data_signature(PyObject *self, PyObject *py_co);
+PyObject *_pyndn_cmd_Data_signed_info(PyObject *self, PyObject *py_co);
+int _pyndn_init_data_header(PyObject *module);
+PyObject *_pyndn_cmd_peek_data(PyObject *self, PyObject *py_buffer);
+PyObject *_pyndn_cmd_decode_data_stream(PyObject *self, PyObject *args);
 PyObject *_pyndn_cmd_digest_contentobject(PyObject *self, PyObject *args);
 PyObject *_pyndn_cmd_content_matches_interest(PyObject *self, PyObject *args);
 PyObject *_pyndn_cmd_verify_content(PyObject *self, PyObject *args);
 PyObject *_pyndn_cmd_verify_signature(PyObject *self, PyObject *args);
+PyObject *_pyndn_cmd_verify_symmetric(PyObject *self, PyObject *args);
 
 #endif	/* MEDHODS_CONTENTOBJECT_H */
 
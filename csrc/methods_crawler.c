@@ -0,0 +1,455 @@
+/*
+ * Copyright (c) 2011, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ * Written by: Derek Kulinski <takeda@takeda.tk>
+ *             Jeff Burke <jburke@ucla.edu>
+ */
+
+#include "python_hdr.h"
+#include <ndn/ndn.h>
+
+#include <stdlib.h>
+
+#include "pyndn.h"
+#include "util.h"
+#include "methods_contentobject.h"
+#include "methods_crawler.h"
+#include "methods_exclusionfilter.h"
+#include "methods_interest.h"
+#include "methods_name.h"
+#include "objects.h"
+#include "stats.h"
+
+// Namespace enumeration
+//
+// Every node of the namespace is probed with interests excluding the
+// children found under it so far, with one interest outstanding per node.
+// Nodes wait in per-depth FIFO queues and at most max_in_flight nodes of a
+// depth are probed at the same time. Shallower levels are always served
+// first, so the walk is breadth first. Every newly discovered name is handed
+// to Python as soon as it arrives.
+
+struct crawler;
+
+struct crawl_node {
+	struct ndn_closure closure;
+	struct crawler *crawler;
+	struct crawl_node *next;          /* in the level queue */
+	struct ndn_charbuf *prefix;
+	struct exclusion_filter *children;
+	int depth;
+};
+
+struct crawl_level {
+	struct crawl_node *head, *tail;   /* waiting to be probed */
+	int in_flight;
+};
+
+struct crawler {
+	struct ndn *handle;
+	struct handle_stats *stats;
+	struct ndn_charbuf *templ;
+	struct crawl_level *levels;
+	int n_levels;
+	int max_in_flight;                /* per level */
+	int active;                       /* nodes with an interest out */
+	unsigned long lifetime;           /* in 1/4096 s, 0 for the default */
+	long n_names;
+	PyObject *py_face;                /* keeps the handle alive */
+	PyObject *py_on_name;
+	PyObject *py_on_done;
+};
+
+static void
+crawl_node_destroy(struct crawl_node **nodep)
+{
+	struct crawl_node *node = *nodep;
+
+	if (!node)
+		return;
+
+	ndn_charbuf_destroy(&node->prefix);
+	exclusion_filter_destroy(&node->children);
+	free(node);
+	*nodep = NULL;
+}
+
+static void
+crawler_destroy(struct crawler **cp)
+{
+	struct crawler *c = *cp;
+	struct crawl_node *node;
+
+	if (!c)
+		return;
+
+	for (int i = 0; i < c->n_levels; i++)
+		while ((node = c->levels[i].head)) {
+			c->levels[i].head = node->next;
+			crawl_node_destroy(&node);
+		}
+
+	free(c->levels);
+	ndn_charbuf_destroy(&c->templ);
+
+	Py_XDECREF(c->py_face);
+	Py_XDECREF(c->py_on_name);
+	Py_XDECREF(c->py_on_done);
+
+	free(c);
+	*cp = NULL;
+}
+
+static enum ndn_upcall_res crawl_upcall(struct ndn_closure *selfp,
+		enum ndn_upcall_kind upcall_kind, struct ndn_upcall_info *info);
+
+static int
+crawler_enqueue(struct crawler *c, const struct ndn_charbuf *prefix,
+		int depth)
+{
+	struct crawl_level *level;
+	struct crawl_node *node;
+	int r;
+
+	if (depth >= c->n_levels) {
+		level = realloc(c->levels, (depth + 1) * sizeof(*level));
+		if (!level)
+			return -1;
+
+		memset(level + c->n_levels, 0,
+				(depth + 1 - c->n_levels) * sizeof(*level));
+		c->levels = level;
+		c->n_levels = depth + 1;
+	}
+
+	node = calloc(1, sizeof(*node));
+	if (!node)
+		return -1;
+
+	node->closure.p = crawl_upcall;
+	node->closure.data = node;
+	node->closure.intdata = (intptr_t) c->stats;
+	node->crawler = c;
+	node->depth = depth;
+
+	node->prefix = ndn_charbuf_create();
+	node->children = exclusion_filter_create();
+	if (!node->prefix || !node->children)
+		goto error;
+
+	r = ndn_charbuf_append_charbuf(node->prefix, prefix);
+	if (r < 0)
+		goto error;
+
+	level = &c->levels[depth];
+	if (level->tail)
+		level->tail->next = node;
+	else
+		level->head = node;
+	level->tail = node;
+
+	return 0;
+
+error:
+	crawl_node_destroy(&node);
+	return -1;
+}
+
+static int
+crawl_node_express(struct crawl_node *node)
+{
+	struct crawler *c = node->crawler;
+	const struct ndn_charbuf *exclude;
+	int r;
+
+	exclude = exclusion_filter_encode(node->children);
+	if (!exclude)
+		return -1;
+
+	r = _pyndn_interest_probe_template(c->templ, exclude, -1, c->lifetime);
+	if (r < 0)
+		return r;
+
+	r = ndn_express_interest(c->handle, node->prefix, &node->closure,
+			c->templ);
+	if (r >= 0)
+		handle_stats_expressed(c->stats);
+
+	return r;
+}
+
+static void
+crawler_pump(struct crawler *c)
+{
+	struct crawl_level *level;
+	struct crawl_node *node;
+
+	for (int i = 0; i < c->n_levels; i++) {
+		level = &c->levels[i];
+
+		while (level->head && level->in_flight < c->max_in_flight) {
+			node = level->head;
+			level->head = node->next;
+			if (!level->head)
+				level->tail = NULL;
+			node->next = NULL;
+
+			if (crawl_node_express(node) < 0) {
+				debug("Unable to express interest, skipping node\n");
+				crawl_node_destroy(&node);
+				continue;
+			}
+
+			level->in_flight++;
+			c->active++;
+		}
+	}
+}
+
+static void
+crawler_done(struct crawler **cp)
+{
+	struct crawler *c = *cp;
+	PyObject *py_res;
+
+	if (c->py_on_done != Py_None) {
+		py_res = PyObject_CallFunction(c->py_on_done, "l", c->n_names);
+		if (py_res)
+			Py_DECREF(py_res);
+		else
+			PyErr_Print();
+	}
+
+	crawler_destroy(cp);
+}
+
+/*
+ * Passes the new name to Python, and queues it for crawling when the Data
+ * shows there is more below it, unless the callback returned False
+ */
+static void
+crawl_report(struct crawl_node *node, enum ndn_upcall_kind kind,
+		struct ndn_upcall_info *info, const unsigned char *comp,
+		size_t size)
+{
+	struct crawler *c = node->crawler;
+	PyObject *py_cname, *py_name = NULL, *py_data = NULL, *py_res;
+	struct ndn_charbuf *name;
+	int ncomps, r;
+
+	ncomps = info->content_comps->n - 1;
+
+	py_cname = NDNObject_New_charbuf(NAME, &name);
+	JUMP_IF_NULL(py_cname, error);
+
+	r = ndn_charbuf_append_charbuf(name, node->prefix);
+	JUMP_IF_NEG_MEM(r, error);
+
+	if (ncomps > info->pi->prefix_comps) {
+		r = ndn_name_append(name, comp, size);
+		JUMP_IF_NEG_MEM(r, error);
+	}
+
+	py_name = Name_obj_from_ndn(py_cname);
+	JUMP_IF_NULL(py_name, error);
+
+	py_data = Data_obj_from_ndnb(info->content_ndnb,
+			info->pco->offset[NDN_PCO_E]);
+	JUMP_IF_NULL(py_data, error);
+
+	c->n_names++;
+
+	py_res = PyObject_CallFunction(c->py_on_name, "OOi", py_name, py_data,
+			kind);
+	JUMP_IF_NULL(py_res, error);
+
+	if (py_res != Py_False && ncomps > info->pi->prefix_comps + 1) {
+		r = crawler_enqueue(c, name, node->depth + 1);
+		if (r < 0)
+			PyErr_NoMemory();
+	}
+	Py_DECREF(py_res);
+
+error:
+	if (PyErr_Occurred())
+		PyErr_Print();
+	Py_XDECREF(py_data);
+	Py_XDECREF(py_name);
+	Py_XDECREF(py_cname);
+}
+
+static enum ndn_upcall_res
+crawl_content(struct crawl_node *node, enum ndn_upcall_kind kind,
+		struct ndn_upcall_info *info)
+{
+	const unsigned char *comp;
+	size_t size;
+	int ncomps, r;
+
+	ncomps = info->content_comps->n - 1;
+
+	if (ncomps <= info->pi->prefix_comps) {
+		/* the prefix itself is a Data packet, exclude it by its digest */
+		ndn_digest_ContentObject(info->content_ndnb, info->pco);
+		comp = info->pco->digest;
+		size = info->pco->digest_bytes;
+	} else {
+		r = ndn_name_comp_get(info->content_ndnb, info->content_comps,
+				info->pi->prefix_comps, &comp, &size);
+		if (r < 0)
+			return NDN_UPCALL_RESULT_OK;
+	}
+
+	r = exclusion_filter_add(node->children, comp, size);
+	if (r < 0)
+		return NDN_UPCALL_RESULT_OK;
+	if (r > 0)
+		crawl_report(node, kind, info, comp, size);
+
+	/*
+	 * Keep the level slot and look for the next sibling right away, if
+	 * that fails the node is finished by NDN_UPCALL_FINAL as usual
+	 */
+	crawl_node_express(node);
+
+	/* a newly queued child might fit into its level already */
+	crawler_pump(node->crawler);
+
+	return NDN_UPCALL_RESULT_OK;
+}
+
+static enum ndn_upcall_res
+crawl_upcall(struct ndn_closure *selfp, enum ndn_upcall_kind upcall_kind,
+		struct ndn_upcall_info *info)
+{
+	struct crawl_node *node = selfp->data;
+	struct crawler *c;
+	enum ndn_upcall_res res = NDN_UPCALL_RESULT_OK;
+	struct handle_stats *stats = (struct handle_stats *) selfp->intdata;
+	PyGILState_STATE gstate;
+	long long entered;
+
+	debug("crawl_upcall dispatched kind %d\n", upcall_kind);
+
+	assert(node);
+	c = node->crawler;
+
+	entered = handle_stats_upcall_enter(selfp, upcall_kind, info, &gstate);
+
+	switch (upcall_kind) {
+	case NDN_UPCALL_FINAL:
+		c->levels[node->depth].in_flight--;
+		c->active--;
+		crawl_node_destroy(&node);
+
+		crawler_pump(c);
+		if (!c->active)
+			crawler_done(&c);
+		break;
+	case NDN_UPCALL_CONTENT:
+	case NDN_UPCALL_CONTENT_UNVERIFIED:
+	case NDN_UPCALL_CONTENT_BAD:
+	case NDN_UPCALL_CONTENT_KEYMISSING:
+	case NDN_UPCALL_CONTENT_RAW:
+		res = crawl_content(node, upcall_kind, info);
+		break;
+	default:
+		/* timeout, nothing more under this node */
+		break;
+	}
+
+	handle_stats_upcall_leave(stats, entered, upcall_kind, info,
+			"NamespaceCrawler", gstate);
+
+	return res;
+}
+
+// arguments: Face, Name, onName callable, [onDone callable or None,
+//            interests in flight per level, interest lifetime in seconds]
+// returns:   None, onName(name, data, kind) is called from ndn_run() for
+//            every name found and onDone(count) once the walk is over
+
+PyObject *
+_pyndn_cmd_enumerate_namespace(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_face, *py_name, *py_on_name, *py_on_done = Py_None;
+	PyObject *py_o;
+	int max_in_flight = 4;
+	double lifetime = 0.0;
+	struct crawler *c = NULL;
+	struct ndn_charbuf *name;
+	int r;
+
+	if (!PyArg_ParseTuple(args, "OOO|Oid", &py_face, &py_name, &py_on_name,
+			&py_on_done, &max_in_flight, &lifetime))
+		return NULL;
+
+	if (!PyObject_IsInstance(py_face, g_type_Face)) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a Face as arg 1");
+		return NULL;
+	}
+	if (strcmp(py_name->ob_type->tp_name, "Name")) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a Name as arg 2");
+		return NULL;
+	}
+	if (!PyCallable_Check(py_on_name)) {
+		PyErr_SetString(PyExc_TypeError, "onName must be callable");
+		return NULL;
+	}
+	if (py_on_done != Py_None && !PyCallable_Check(py_on_done)) {
+		PyErr_SetString(PyExc_TypeError, "onDone must be callable or None");
+		return NULL;
+	}
+	if (max_in_flight < 1) {
+		PyErr_SetString(PyExc_ValueError, "At least one interest per level"
+				" has to be allowed");
+		return NULL;
+	}
+
+	c = calloc(1, sizeof(*c));
+	JUMP_IF_NULL_MEM(c, error);
+
+	py_o = PyObject_GetAttrString(py_face, "ndn_data");
+	JUMP_IF_NULL(py_o, error);
+	c->handle = NDNObject_Get(HANDLE, py_o);
+	c->stats = _pyndn_handle_get_stats(py_o);
+	Py_DECREF(py_o);
+
+	py_o = PyObject_GetAttrString(py_name, "ndn_data");
+	JUMP_IF_NULL(py_o, error);
+	name = NDNObject_Get(NAME, py_o);
+	Py_DECREF(py_o);
+
+	c->templ = ndn_charbuf_create();
+	JUMP_IF_NULL_MEM(c->templ, error);
+
+	c->max_in_flight = max_in_flight;
+	c->lifetime = lifetime > 0 ? lifetime * 4096 : 0;
+
+	Py_INCREF(py_face);
+	c->py_face = py_face;
+	Py_INCREF(py_on_name);
+	c->py_on_name = py_on_name;
+	Py_INCREF(py_on_done);
+	c->py_on_done = py_on_done;
+
+	r = crawler_enqueue(c, name, 0);
+	JUMP_IF_NEG_MEM(r, error);
+
+	crawler_pump(c);
+	if (!c->active) {
+		int err = ndn_geterror(c->handle);
+
+		PyErr_Format(PyExc_IOError, "Unable to issue an interest: %s [%d]",
+				strerror(err), err);
+		goto error;
+	}
+
+	/* c is released once the last node gets NDN_UPCALL_FINAL */
+
+	Py_RETURN_NONE;
+
+error:
+	crawler_destroy(&c);
+	return NULL;
+}
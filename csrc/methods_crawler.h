@@ -0,0 +1,13 @@
+/*
+ * Copyright (c) 2011, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ * Written by: Derek Kulinski <takeda@takeda.tk>
+ *             Jeff Burke <jburke@ucla.edu>
+ */
+
+#ifndef METHODS_CRAWLER_H
+#  define	METHODS_CRAWLER_H
+
+PyObject *_pyndn_cmd_enumerate_namespace(PyObject *self, PyObject *args);
+
+#endif	/* METHODS_CRAWLER_H */
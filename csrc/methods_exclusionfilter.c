@@ -0,0 +1,770 @@
+/*
+ * Copyright (c) 2011, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ * Written by: Derek Kulinski <takeda@takeda.tk>
+ *             Jeff Burke <jburke@ucla.edu>
+ */
+
+#include "python_hdr.h"
+#include <ndn/ndn.h>
+
+#include <stdlib.h>
+
+#include "pyndn.h"
+#include "util.h"
+#include "methods_exclusionfilter.h"
+#include "objects.h"
+
+//  Exclusion list - This uses explicit exclusion rather than
+//                   Bloom filters as Bloom will be deprecated
+//  IMPORTANT:  Exclusion component list must be sorted following
+//              "Canonical NDNx ordering"
+//              http://www.ndnx.org/releases/latest/doc/technical/CanonicalOrder.html
+//              in which shortest components go first.
+//
+// The components are kept sorted at all times (binary search on insert),
+// their values live in one arena charbuf. The encoded <Exclude> element is
+// cached, and appending a component past the current last one only patches
+// the tail of the cached encoding.
+
+struct exclusion_entry {
+	size_t offset;      /* component value in the arena */
+	size_t size;
+	int any_after;      /* <Any/> between this component and the next one */
+};
+
+struct exclusion_filter {
+	struct exclusion_entry *entries;
+	size_t n, limit;
+	int any_first;      /* <Any/> in front of the first component */
+	struct ndn_charbuf *comps;
+	size_t garbage;     /* arena bytes no longer referenced */
+	struct ndn_charbuf *encoded;
+	int encoded_valid;
+};
+
+int
+exclusion_filter_compare(const unsigned char *a, size_t asize,
+		const unsigned char *b, size_t bsize)
+{
+	if (asize != bsize)
+		return asize < bsize ? -1 : 1;
+
+	return memcmp(a, b, asize);
+}
+
+static inline const unsigned char *
+entry_value(const struct exclusion_filter *ef, const struct exclusion_entry *e)
+{
+	return ef->comps->buf + e->offset;
+}
+
+/*
+ * Returns index of the first entry that is not smaller than comp, *found is
+ * set when that entry is equal to comp
+ */
+static size_t
+lower_bound(const struct exclusion_filter *ef, const unsigned char *comp,
+		size_t size, int *found)
+{
+	size_t lo = 0, hi = ef->n;
+
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		const struct exclusion_entry *e = &ef->entries[mid];
+
+		if (exclusion_filter_compare(entry_value(ef, e), e->size, comp, size) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	*found = lo < ef->n && !exclusion_filter_compare(
+			entry_value(ef, &ef->entries[lo]), ef->entries[lo].size, comp, size);
+
+	return lo;
+}
+
+static int
+append_component(struct ndn_charbuf *c, const unsigned char *comp, size_t size,
+		int any_after)
+{
+	int r;
+
+	r = ndnb_append_tagged_blob(c, NDN_DTAG_Component, comp, size);
+	if (r < 0 || !any_after)
+		return r;
+
+	r = ndn_charbuf_append_tt(c, NDN_DTAG_Any, NDN_DTAG);
+	if (r < 0)
+		return r;
+
+	return ndn_charbuf_append_closer(c); /* </Any> */
+}
+
+static void
+compact_arena(struct exclusion_filter *ef)
+{
+	struct ndn_charbuf *comps;
+
+	if (ef->garbage < 256 || ef->garbage < ef->comps->length / 2)
+		return;
+
+	comps = ndn_charbuf_create();
+	if (!comps)
+		return; /* not fatal, we'll try next time */
+
+	for (size_t i = 0; i < ef->n; i++) {
+		struct exclusion_entry *e = &ef->entries[i];
+		size_t offset = comps->length;
+
+		if (ndn_charbuf_append(comps, entry_value(ef, e), e->size) < 0) {
+			ndn_charbuf_destroy(&comps);
+			return;
+		}
+		e->offset = offset;
+	}
+
+	ndn_charbuf_destroy(&ef->comps);
+	ef->comps = comps;
+	ef->garbage = 0;
+}
+
+/* drops entries [start, stop) */
+static void
+remove_range(struct exclusion_filter *ef, size_t start, size_t stop)
+{
+	assert(start <= stop && stop <= ef->n);
+
+	if (start == stop)
+		return;
+
+	for (size_t i = start; i < stop; i++)
+		ef->garbage += ef->entries[i].size;
+
+	memmove(&ef->entries[start], &ef->entries[stop],
+			(ef->n - stop) * sizeof(*ef->entries));
+	ef->n -= stop - start;
+	ef->encoded_valid = 0;
+
+	compact_arena(ef);
+}
+
+static int
+insert_at(struct exclusion_filter *ef, size_t i, const unsigned char *comp,
+		size_t size, int any_after)
+{
+	struct exclusion_entry *e;
+	size_t offset;
+	int r;
+
+	if (ef->n == ef->limit) {
+		size_t limit = ef->limit ? ef->limit * 2 : 16;
+
+		e = realloc(ef->entries, limit * sizeof(*ef->entries));
+		if (!e)
+			return -1;
+
+		ef->entries = e;
+		ef->limit = limit;
+	}
+
+	offset = ef->comps->length;
+	r = ndn_charbuf_append(ef->comps, comp, size);
+	if (r < 0)
+		return -1;
+
+	/* appending after the last component only touches the tail */
+	if (i == ef->n && ef->n > 0 && ef->encoded_valid) {
+		ef->encoded->length--; /* </Exclude> */
+		r = append_component(ef->encoded, comp, size, any_after);
+		if (r >= 0)
+			r = ndn_charbuf_append_closer(ef->encoded);
+		if (r < 0)
+			ef->encoded_valid = 0;
+	} else
+		ef->encoded_valid = 0;
+
+	memmove(&ef->entries[i + 1], &ef->entries[i],
+			(ef->n - i) * sizeof(*ef->entries));
+	e = &ef->entries[i];
+	e->offset = offset;
+	e->size = size;
+	e->any_after = any_after;
+	ef->n++;
+
+	return 0;
+}
+
+struct exclusion_filter *
+exclusion_filter_create(void)
+{
+	struct exclusion_filter *ef;
+
+	ef = calloc(1, sizeof(*ef));
+	if (!ef)
+		return NULL;
+
+	ef->comps = ndn_charbuf_create();
+	ef->encoded = ndn_charbuf_create();
+	if (!ef->comps || !ef->encoded) {
+		exclusion_filter_destroy(&ef);
+		return NULL;
+	}
+
+	return ef;
+}
+
+void
+exclusion_filter_destroy(struct exclusion_filter **ef)
+{
+	if (!*ef)
+		return;
+
+	ndn_charbuf_destroy(&(*ef)->comps);
+	ndn_charbuf_destroy(&(*ef)->encoded);
+	free((*ef)->entries);
+	free(*ef);
+	*ef = NULL;
+}
+
+void
+exclusion_filter_reset(struct exclusion_filter *ef)
+{
+	ef->n = 0;
+	ef->any_first = 0;
+	ef->comps->length = 0;
+	ef->garbage = 0;
+	ef->encoded_valid = 0;
+}
+
+size_t
+exclusion_filter_count(const struct exclusion_filter *ef)
+{
+	return ef->n;
+}
+
+/*
+ * Adds a single component. A component that falls into an already excluded
+ * range keeps that range excluded, so what the filter matches only grows.
+ *
+ * returns 1 if the component was added, 0 if it was already there and -1 on
+ * memory error
+ */
+int
+exclusion_filter_add(struct exclusion_filter *ef, const unsigned char *comp,
+		size_t size)
+{
+	size_t i;
+	int found, any_after, r;
+
+	i = lower_bound(ef, comp, size, &found);
+	if (found)
+		return 0;
+
+	if (i > 0)
+		any_after = ef->entries[i - 1].any_after;
+	else
+		any_after = ef->any_first;
+
+	r = insert_at(ef, i, comp, size, any_after);
+
+	return r < 0 ? r : 1;
+}
+
+/*
+ * Excludes everything past the last component. On an empty filter that is
+ * everything, and it stays so as components get added, the way to exclude
+ * only what sorts below a component is exclusion_filter_exclude_before()
+ */
+int
+exclusion_filter_add_any(struct exclusion_filter *ef)
+{
+	struct exclusion_entry *last;
+	int r;
+
+	if (ef->n == 0) {
+		ef->any_first = 1;
+		ef->encoded_valid = 0;
+		return 0;
+	}
+
+	last = &ef->entries[ef->n - 1];
+	if (last->any_after)
+		return 0;
+	last->any_after = 1;
+
+	if (!ef->encoded_valid)
+		return 0;
+
+	ef->encoded->length--; /* </Exclude> */
+	r = ndn_charbuf_append_tt(ef->encoded, NDN_DTAG_Any, NDN_DTAG);
+	if (r >= 0)
+		r = ndn_charbuf_append_closer(ef->encoded); /* </Any> */
+	if (r >= 0)
+		r = ndn_charbuf_append_closer(ef->encoded); /* </Exclude> */
+	if (r < 0)
+		ef->encoded_valid = 0;
+
+	return 0;
+}
+
+/* Excludes comp and everything that sorts before it */
+int
+exclusion_filter_exclude_before(struct exclusion_filter *ef,
+		const unsigned char *comp, size_t size)
+{
+	size_t i;
+	int found, r;
+
+	r = exclusion_filter_add(ef, comp, size);
+	if (r < 0)
+		return r;
+
+	i = lower_bound(ef, comp, size, &found);
+	assert(found);
+
+	remove_range(ef, 0, i);
+	ef->any_first = 1;
+	ef->encoded_valid = 0;
+
+	return 0;
+}
+
+/* Excludes comp and everything that sorts after it */
+int
+exclusion_filter_exclude_after(struct exclusion_filter *ef,
+		const unsigned char *comp, size_t size)
+{
+	size_t i;
+	int found, r;
+
+	i = lower_bound(ef, comp, size, &found);
+	if (!found) {
+		r = insert_at(ef, i, comp, size, 0);
+		if (r < 0)
+			return r;
+	}
+
+	remove_range(ef, i + 1, ef->n);
+	ef->entries[i].any_after = 1;
+	ef->encoded_valid = 0;
+
+	return 0;
+}
+
+int
+exclusion_filter_matches(const struct exclusion_filter *ef,
+		const unsigned char *comp, size_t size)
+{
+	size_t i;
+	int found;
+
+	i = lower_bound(ef, comp, size, &found);
+	if (found)
+		return 1;
+
+	return i > 0 ? ef->entries[i - 1].any_after : ef->any_first;
+}
+
+/*
+ * Replaces content of the filter with the <Exclude> element found in
+ * buf[start, stop), returns -1 if the element can't be parsed
+ */
+int
+exclusion_filter_parse(struct exclusion_filter *ef, const unsigned char *buf,
+		size_t start, size_t stop)
+{
+	struct ndn_buf_decoder decoder, *d;
+	const unsigned char *value;
+	size_t size;
+	int found, r;
+
+	exclusion_filter_reset(ef);
+
+	d = ndn_buf_decoder_start(&decoder, buf + start, stop - start);
+
+	if (!ndn_buf_match_dtag(d, NDN_DTAG_Exclude))
+		return -1;
+	ndn_buf_advance(d);
+
+	if (ndn_buf_match_dtag(d, NDN_DTAG_Any)) {
+		ndn_buf_advance(d);
+		ndn_buf_check_close(d);
+		ef->any_first = 1;
+	}
+
+	while (ndn_buf_match_dtag(d, NDN_DTAG_Component)) {
+		size_t i;
+
+		ndn_buf_advance(d);
+		if (ndn_buf_match_blob(d, &value, &size))
+			ndn_buf_advance(d);
+		else {
+			value = (const unsigned char *) "";
+			size = 0;
+		}
+		ndn_buf_check_close(d);
+		if (d->decoder.state < 0)
+			return -1;
+
+		/* the wire form is sorted already, so this is an append */
+		i = lower_bound(ef, value, size, &found);
+		if (!found) {
+			r = insert_at(ef, i, value, size, 0);
+			if (r < 0)
+				return -1;
+		}
+
+		if (ndn_buf_match_dtag(d, NDN_DTAG_Any)) {
+			ndn_buf_advance(d);
+			ndn_buf_check_close(d);
+			ef->entries[i].any_after = 1;
+		}
+	}
+
+	ndn_buf_check_close(d);
+	if (d->decoder.state < 0)
+		return -1;
+
+	ef->encoded_valid = 0;
+
+	return 0;
+}
+
+/*
+ * Returns the <Exclude> element, or an empty charbuf if there is nothing to
+ * exclude. The result is owned by the filter and stays valid until the next
+ * modification.
+ */
+const struct ndn_charbuf *
+exclusion_filter_encode(struct exclusion_filter *ef)
+{
+	struct ndn_charbuf *c = ef->encoded;
+	int r;
+
+	if (ef->encoded_valid)
+		return c;
+
+	c->length = 0;
+
+	if (ef->n == 0 && !ef->any_first)
+		goto done;
+
+	r = ndn_charbuf_append_tt(c, NDN_DTAG_Exclude, NDN_DTAG);
+	JUMP_IF_NEG(r, error);
+
+	if (ef->any_first) {
+		r = ndn_charbuf_append_tt(c, NDN_DTAG_Any, NDN_DTAG);
+		JUMP_IF_NEG(r, error);
+
+		r = ndn_charbuf_append_closer(c); /* </Any> */
+		JUMP_IF_NEG(r, error);
+	}
+
+	for (size_t i = 0; i < ef->n; i++) {
+		struct exclusion_entry *e = &ef->entries[i];
+
+		r = append_component(c, entry_value(ef, e), e->size, e->any_after);
+		JUMP_IF_NEG(r, error);
+	}
+
+	r = ndn_charbuf_append_closer(c); /* </Exclude> */
+	JUMP_IF_NEG(r, error);
+
+done:
+	ef->encoded_valid = 1;
+	return c;
+
+error:
+	c->length = 0;
+	return NULL;
+}
+
+// ************
+// Python interface
+//
+//
+
+static PyObject *
+ExclusionFilter_new_capsule(struct exclusion_filter **ef)
+{
+	struct exclusion_filter *p;
+	PyObject *py_o;
+
+	p = exclusion_filter_create();
+	if (!p)
+		return PyErr_NoMemory();
+
+	py_o = NDNObject_New(EXCLUSION_FILTER, p);
+	if (!py_o) {
+		exclusion_filter_destroy(&p);
+		return NULL;
+	}
+
+	if (ef)
+		*ef = p;
+
+	return py_o;
+}
+
+static int
+component_from_py(PyObject *py_comp, const unsigned char **comp, size_t *size)
+{
+	if (PyBytes_Check(py_comp)) {
+		*comp = (const unsigned char *) PyBytes_AS_STRING(py_comp);
+		*size = PyBytes_GET_SIZE(py_comp);
+	} else if (PyByteArray_Check(py_comp)) {
+		*comp = (const unsigned char *) PyByteArray_AS_STRING(py_comp);
+		*size = PyByteArray_GET_SIZE(py_comp);
+	} else {
+		PyErr_SetString(PyExc_TypeError, "Name component must be bytes or"
+				" bytearray");
+		return -1;
+	}
+
+	return 0;
+}
+
+static struct exclusion_filter *
+parse_component_args(PyObject *args, const unsigned char **comp, size_t *size)
+{
+	PyObject *py_exclusion_filter, *py_comp;
+
+	if (!PyArg_ParseTuple(args, "OO", &py_exclusion_filter, &py_comp))
+		return NULL;
+
+	if (!NDNObject_ReqType(EXCLUSION_FILTER, py_exclusion_filter))
+		return NULL;
+
+	if (component_from_py(py_comp, comp, size) < 0)
+		return NULL;
+
+	return NDNObject_Get(EXCLUSION_FILTER, py_exclusion_filter);
+}
+
+PyObject *
+ExclusionFilter_obj_from_ndn(PyObject *py_exclusion_filter)
+{
+	PyObject *py_obj_ExclusionFilter;
+	int r;
+
+	assert(g_type_ExclusionFilter);
+
+	py_obj_ExclusionFilter = PyObject_CallObject(g_type_ExclusionFilter, NULL);
+	if (!py_obj_ExclusionFilter)
+		return NULL;
+
+	r = PyObject_SetAttrString(py_obj_ExclusionFilter, "ndn_data",
+			py_exclusion_filter);
+	if (r < 0) {
+		Py_DECREF(py_obj_ExclusionFilter);
+		return NULL;
+	}
+
+	return py_obj_ExclusionFilter;
+}
+
+PyObject *
+_pyndn_cmd_exclusion_filter_new(PyObject *UNUSED(self), PyObject *UNUSED(args))
+{
+	return ExclusionFilter_new_capsule(NULL);
+}
+
+PyObject *
+_pyndn_cmd_exclusion_filter_reset(PyObject *UNUSED(self),
+		PyObject *py_exclusion_filter)
+{
+	if (!NDNObject_ReqType(EXCLUSION_FILTER, py_exclusion_filter))
+		return NULL;
+
+	exclusion_filter_reset(NDNObject_Get(EXCLUSION_FILTER, py_exclusion_filter));
+
+	Py_RETURN_NONE;
+}
+
+PyObject *
+_pyndn_cmd_exclusion_filter_add(PyObject *UNUSED(self), PyObject *args)
+{
+	struct exclusion_filter *ef;
+	const unsigned char *comp;
+	size_t size;
+	int r;
+
+	ef = parse_component_args(args, &comp, &size);
+	if (!ef)
+		return NULL;
+
+	r = exclusion_filter_add(ef, comp, size);
+	if (r < 0)
+		return PyErr_NoMemory();
+
+	return PyBool_FromLong(r);
+}
+
+PyObject *
+_pyndn_cmd_exclusion_filter_add_any(PyObject *UNUSED(self),
+		PyObject *py_exclusion_filter)
+{
+	int r;
+
+	if (!NDNObject_ReqType(EXCLUSION_FILTER, py_exclusion_filter))
+		return NULL;
+
+	r = exclusion_filter_add_any(NDNObject_Get(EXCLUSION_FILTER,
+			py_exclusion_filter));
+	if (r < 0)
+		return PyErr_NoMemory();
+
+	Py_RETURN_NONE;
+}
+
+PyObject *
+_pyndn_cmd_exclusion_filter_exclude_before(PyObject *UNUSED(self),
+		PyObject *args)
+{
+	struct exclusion_filter *ef;
+	const unsigned char *comp;
+	size_t size;
+	int r;
+
+	ef = parse_component_args(args, &comp, &size);
+	if (!ef)
+		return NULL;
+
+	r = exclusion_filter_exclude_before(ef, comp, size);
+	if (r < 0)
+		return PyErr_NoMemory();
+
+	Py_RETURN_NONE;
+}
+
+PyObject *
+_pyndn_cmd_exclusion_filter_exclude_after(PyObject *UNUSED(self),
+		PyObject *args)
+{
+	struct exclusion_filter *ef;
+	const unsigned char *comp;
+	size_t size;
+	int r;
+
+	ef = parse_component_args(args, &comp, &size);
+	if (!ef)
+		return NULL;
+
+	r = exclusion_filter_exclude_after(ef, comp, size);
+	if (r < 0)
+		return PyErr_NoMemory();
+
+	Py_RETURN_NONE;
+}
+
+PyObject *
+_pyndn_cmd_exclusion_filter_matches(PyObject *UNUSED(self), PyObject *args)
+{
+	struct exclusion_filter *ef;
+	const unsigned char *comp;
+	size_t size;
+
+	ef = parse_component_args(args, &comp, &size);
+	if (!ef)
+		return NULL;
+
+	return PyBool_FromLong(exclusion_filter_matches(ef, comp, size));
+}
+
+/*
+ * Returns list of components in canonical order, None marks <Any/>
+ */
+PyObject *
+_pyndn_cmd_exclusion_filter_components(PyObject *UNUSED(self),
+		PyObject *py_exclusion_filter)
+{
+	struct exclusion_filter *ef;
+	PyObject *py_components, *py_o;
+	int r;
+
+	if (!NDNObject_ReqType(EXCLUSION_FILTER, py_exclusion_filter))
+		return NULL;
+	ef = NDNObject_Get(EXCLUSION_FILTER, py_exclusion_filter);
+
+	py_components = PyList_New(0);
+	JUMP_IF_NULL(py_components, error);
+
+	if (ef->any_first) {
+		r = PyList_Append(py_components, Py_None);
+		JUMP_IF_NEG(r, error);
+	}
+
+	for (size_t i = 0; i < ef->n; i++) {
+		struct exclusion_entry *e = &ef->entries[i];
+
+		py_o = PyBytes_FromStringAndSize((const char *) entry_value(ef, e),
+				e->size);
+		JUMP_IF_NULL(py_o, error);
+
+		r = PyList_Append(py_components, py_o);
+		Py_DECREF(py_o);
+		JUMP_IF_NEG(r, error);
+
+		if (e->any_after) {
+			r = PyList_Append(py_components, Py_None);
+			JUMP_IF_NEG(r, error);
+		}
+	}
+
+	return py_components;
+
+error:
+	Py_XDECREF(py_components);
+	return NULL;
+}
+
+PyObject *
+_pyndn_cmd_exclusion_filter_to_ndn(PyObject *UNUSED(self),
+		PyObject *py_exclusion_filter)
+{
+	const struct ndn_charbuf *exclude;
+
+	if (!NDNObject_ReqType(EXCLUSION_FILTER, py_exclusion_filter))
+		return NULL;
+
+	exclude = exclusion_filter_encode(NDNObject_Get(EXCLUSION_FILTER,
+			py_exclusion_filter));
+	if (!exclude)
+		return PyErr_NoMemory();
+
+	return PyBytes_FromStringAndSize((const char *) exclude->buf,
+			exclude->length);
+}
+
+PyObject *
+_pyndn_cmd_exclusion_filter_from_ndn(PyObject *UNUSED(self),
+		PyObject *py_buffer)
+{
+	struct exclusion_filter *ef;
+	PyObject *py_exclusion_filter, *py_o = NULL;
+	Py_buffer buffer;
+	int r;
+
+	r = PyObject_GetBuffer(py_buffer, &buffer, PyBUF_SIMPLE);
+	if (r < 0)
+		return NULL;
+
+	py_exclusion_filter = ExclusionFilter_new_capsule(&ef);
+	JUMP_IF_NULL(py_exclusion_filter, exit);
+
+	r = exclusion_filter_parse(ef, buffer.buf, 0, buffer.len);
+	if (r < 0) {
+		PyErr_SetString(g_PyExc_NDNExclusionFilterError, "error parsing the"
+				" data");
+		goto exit;
+	}
+
+	py_o = ExclusionFilter_obj_from_ndn(py_exclusion_filter);
+
+exit:
+	Py_XDECREF(py_exclusion_filter);
+	PyBuffer_Release(&buffer);
+	return py_o;
+}
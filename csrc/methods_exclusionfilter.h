@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2011, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ * Written by: Derek Kulinski <takeda@takeda.tk>
+ *             Jeff Burke <jburke@ucla.edu>
+ */
+
+#ifndef METHODS_EXCLUSIONFILTER_H
+#  define	METHODS_EXCLUSIONFILTER_H
+
+struct exclusion_filter;
+
+int exclusion_filter_compare(const unsigned char *a, size_t asize,
+		const unsigned char *b, size_t bsize);
+struct exclusion_filter *exclusion_filter_create(void);
+void exclusion_filter_destroy(struct exclusion_filter **ef);
+void exclusion_filter_reset(struct exclusion_filter *ef);
+size_t exclusion_filter_count(const struct exclusion_filter *ef);
+int exclusion_filter_add(struct exclusion_filter *ef,
+		const unsigned char *comp, size_t size);
+int exclusion_filter_add_any(struct exclusion_filter *ef);
+int exclusion_filter_exclude_before(struct exclusion_filter *ef,
+		const unsigned char *comp, size_t size);
+int exclusion_filter_exclude_after(struct exclusion_filter *ef,
+		const unsigned char *comp, size_t size);
+int exclusion_filter_matches(const struct exclusion_filter *ef,
+		const unsigned char *comp, size_t size);
+int exclusion_filter_parse(struct exclusion_filter *ef,
+		const unsigned char *buf, size_t start, size_t stop);
+const struct ndn_charbuf *exclusion_filter_encode(struct exclusion_filter *ef);
+
+PyObject *ExclusionFilter_obj_from_ndn(PyObject *py_exclusion_filter);
+PyObject *_pyndn_cmd_exclusion_filter_new(PyObject *self, PyObject *args);
+PyObject *_pyndn_cmd_exclusion_filter_reset(PyObject *self,
+		PyObject *py_exclusion_filter);
+PyObject *_pyndn_cmd_exclusion_filter_add(PyObject *self, PyObject *args);
+PyObject *_pyndn_cmd_exclusion_filter_add_any(PyObject *self,
+		PyObject *py_exclusion_filter);
+PyObject *_pyndn_cmd_exclusion_filter_exclude_before(PyObject *self,
+		PyObject *args);
+PyObject *_pyndn_cmd_exclusion_filter_exclude_after(PyObject *self,
+		PyObject *args);
+PyObject *_pyndn_cmd_exclusion_filter_matches(PyObject *self, PyObject *args);
+PyObject *_pyndn_cmd_exclusion_filter_components(PyObject *self,
+		PyObject *py_exclusion_filter);
+PyObject *_pyndn_cmd_exclusion_filter_to_ndn(PyObject *self,
+		PyObject *py_exclusion_filter);
+PyObject *_pyndn_cmd_exclusion_filter_from_ndn(PyObject *self,
+		PyObject *py_buffer);
+
+#endif	/* METHODS_EXCLUSIONFILTER_H */
@@ -13,6 +13,7 @@
 
 #include "pyndn.h"
 #include "util.h"
+#include "key_cache.h"
 #include "key_utils.h"
 #include "methods_contentobject.h"
 #include "methods_handle.h"
@@ -20,6 +21,7 @@
 #include "methods_key.h"
 #include "methods_name.h"
 #include "objects.h"
+#include "stats.h"
 
 static PyObject *
 UpcallInfo_obj_from_ndn(enum ndn_upcall_kind upcall_kind,
@@ -102,6 +104,21 @@ error:
 	return NULL;
 }
 
+static inline int
+is_content_upcall(enum ndn_upcall_kind upcall_kind)
+{
+	switch (upcall_kind) {
+	case NDN_UPCALL_CONTENT:
+	case NDN_UPCALL_CONTENT_UNVERIFIED:
+	case NDN_UPCALL_CONTENT_BAD:
+	case NDN_UPCALL_CONTENT_KEYMISSING:
+	case NDN_UPCALL_CONTENT_RAW:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
 static enum ndn_upcall_res
 ndn_upcall_handler(struct ndn_closure *selfp,
 		enum ndn_upcall_kind upcall_kind,
@@ -109,19 +126,39 @@ ndn_upcall_handler(struct ndn_closure *selfp,
 {
 	PyObject *upcall_method = NULL, *py_upcall_info = NULL;
 	PyObject *py_selfp, *py_closure, *arglist, *result;
+	struct pyndn_closure *pc = (struct pyndn_closure *) selfp;
+	struct handle_stats *stats;
 	PyGILState_STATE gstate;
+	long long entered;
+	char type_buf[HANDLE_STATS_TYPE_LEN];
+	const char *type;
 
 	debug("upcall_handler dispatched kind %d\n", upcall_kind);
 
 	assert(selfp);
 	assert(selfp->data);
 
-	gstate = PyGILState_Ensure();
+	/* selfp is gone after FINAL */
+	stats = (struct handle_stats *) selfp->intdata;
+	entered = handle_stats_upcall_enter(selfp, upcall_kind, info, &gstate);
+
+	/* RTT of an expressed interest is up to its first Data */
+	if (pc->expressed && is_content_upcall(upcall_kind)) {
+		histogram_record(pc->rtt, entered - pc->expressed);
+		pc->expressed = 0;
+	}
 
 	/* equivalent of selfp, wrapped into PyCapsule */
 	py_selfp = selfp->data;
 	py_closure = PyCapsule_GetContext(py_selfp);
 	assert(py_closure);
+	type = Py_TYPE(py_closure)->tp_name;
+
+	/* the closure class might go away with the capsule */
+	if (upcall_kind == NDN_UPCALL_FINAL) {
+		snprintf(type_buf, sizeof(type_buf), "%s", type);
+		type = type_buf;
+	}
 
 	upcall_method = PyObject_GetAttrString(py_closure, "upcall");
 	JUMP_IF_NULL(upcall_method, error);
@@ -142,12 +179,16 @@ ndn_upcall_handler(struct ndn_closure *selfp,
 	Py_DECREF(arglist);
 	JUMP_IF_NULL(result, error);
 
+	long r = _pyndn_Int_AsLong(result);
+
+	if (r == NDN_UPCALL_RESULT_REEXPRESS && pc->rtt)
+		pc->expressed = _pyndn_monotonic_us();
+
 	if (upcall_kind == NDN_UPCALL_FINAL)
 		Py_DECREF(py_selfp);
 
-	long r = _pyndn_Int_AsLong(result);
-
-	PyGILState_Release(gstate);
+	handle_stats_upcall_leave(stats, entered, upcall_kind, info, type,
+			gstate);
 
 	return r;
 
@@ -162,7 +203,8 @@ error:
 	if (PyErr_Occurred())
 		PyErr_Print();
 
-	PyGILState_Release(gstate);
+	handle_stats_upcall_leave(stats, entered, upcall_kind, info, type,
+			gstate);
 	return NDN_UPCALL_RESULT_ERR;
 }
 
@@ -342,6 +384,7 @@ _pyndn_cmd_run(PyObject *UNUSED(self), PyObject *args)
 	PyObject *py_handle;
 	int timeoutms = -1;
 	struct ndn *handle;
+	struct handle_stats *stats;
 	void *state_slot;
 
 	if (!PyArg_ParseTuple(args, "O|i", &py_handle, &timeoutms))
@@ -353,18 +396,30 @@ _pyndn_cmd_run(PyObject *UNUSED(self), PyObject *args)
 	}
 	handle = NDNObject_Get(HANDLE, py_handle);
 
+	stats = _pyndn_handle_get_stats(py_handle);
+
 	state_slot = _pyndn_run_state_add(handle);
 	if (!state_slot)
 		return NULL;
 
+	/*
+	 * Event loops call run(0) once select() says the socket is readable,
+	 * upcalls dispatched from here measure how long they waited since
+	 */
+	if (!timeoutms)
+		stats->ready = _pyndn_monotonic_us();
+
 	Py_BEGIN_ALLOW_THREADS
 	debug("Entering ndn_run()\n");
 	r = ndn_run(handle, timeoutms);
 	debug("Exited ndn_run()\n");
 	Py_END_ALLOW_THREADS
 
+	stats->ready = 0;
 	_pyndn_run_state_clear(state_slot);
 
+	handle_stats_report(stats);
+
 	if (r < 0) {
 		int err = ndn_geterror(handle);
 		if (err == 0)
@@ -408,13 +463,15 @@ _pyndn_cmd_express_interest(PyObject *UNUSED(self), PyObject *args)
 	struct ndn *handle;
 	struct ndn_charbuf *name, *templ;
 	struct ndn_closure *cl;
+	struct pyndn_closure *pc;
+	struct handle_stats *stats;
 
 	if (!PyArg_ParseTuple(args, "OOOO", &py_ndn, &py_name, &py_closure,
 			&py_templ))
 		return NULL;
 
-	if (strcmp(py_ndn->ob_type->tp_name, "NDN")) {
-		PyErr_SetString(PyExc_TypeError, "Must pass a ndn as arg 1");
+	if (!PyObject_IsInstance(py_ndn, g_type_Face)) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a Face as arg 1");
 		return NULL;
 	}
 	if (strcmp(py_name->ob_type->tp_name, "Name")) {
@@ -428,8 +485,12 @@ _pyndn_cmd_express_interest(PyObject *UNUSED(self), PyObject *args)
 		return NULL;
 	}
 
-	if (py_templ != Py_None && strcmp(py_templ->ob_type->tp_name, "Interest")) {
-		PyErr_SetString(PyExc_TypeError, "Must pass an Interest as arg 4");
+	/* InterestTemplate carries an already compiled selector block */
+	if (py_templ != Py_None &&
+			strcmp(py_templ->ob_type->tp_name, "Interest") &&
+			strcmp(py_templ->ob_type->tp_name, "InterestTemplate")) {
+		PyErr_SetString(PyExc_TypeError, "Must pass an Interest or"
+				" InterestTemplate as arg 4");
 		return NULL;
 	}
 
@@ -439,6 +500,7 @@ _pyndn_cmd_express_interest(PyObject *UNUSED(self), PyObject *args)
 	if (!py_o)
 		return NULL;
 	handle = NDNObject_Get(HANDLE, py_o);
+	stats = _pyndn_handle_get_stats(py_o);
 	Py_DECREF(py_o);
 
 	py_o = PyObject_GetAttrString(py_name, "ndn_data");
@@ -460,7 +522,10 @@ _pyndn_cmd_express_interest(PyObject *UNUSED(self), PyObject *args)
 	py_o = NDNObject_New_Closure(&cl);
 	cl->p = ndn_upcall_handler;
 	cl->data = py_o;
+	cl->intdata = (intptr_t) stats;
 	Py_INCREF(py_closure); /* We don't want py_closure to be dealocated */
+	pc = (struct pyndn_closure *) cl;
+	pc->rtt = handle_stats_rtt_histogram(stats, name);
 	r = PyCapsule_SetContext(py_o, py_closure);
 	assert(r == 0);
 
@@ -474,6 +539,9 @@ _pyndn_cmd_express_interest(PyObject *UNUSED(self), PyObject *args)
 	PyObject_GC_Track(py_closure);
 #endif
 
+	if (pc->rtt)
+		pc->expressed = _pyndn_monotonic_us();
+
 	r = ndn_express_interest(handle, name, cl, templ);
 	if (r < 0) {
 		int err = ndn_geterror(handle);
@@ -483,6 +551,7 @@ _pyndn_cmd_express_interest(PyObject *UNUSED(self), PyObject *args)
 				strerror(err), err);
 		return NULL;
 	}
+	handle_stats_expressed(stats);
 
 	/*
 	 * We aren't decreasing reference to py_o, because we're expecting
@@ -539,6 +608,7 @@ _pyndn_cmd_set_interest_filter(PyObject *UNUSED(self), PyObject *args)
 	py_o = NDNObject_New_Closure(&closure);
 	closure->p = ndn_upcall_handler;
 	closure->data = py_o;
+	closure->intdata = (intptr_t) _pyndn_handle_get_stats(py_ndn);
 	Py_INCREF(py_closure);
 	r = PyCapsule_SetContext(py_o, py_closure);
 	assert(r == 0);
@@ -592,6 +662,123 @@ _pyndn_cmd_clear_interest_filter(PyObject *UNUSED(self), PyObject *args)
 	return Py_BuildValue("i", r);
 }
 
+// Instrumentation
+//
+// arguments: NDN handle
+// returns:   dictionary with a snapshot of the handle counters
+
+PyObject *
+_pyndn_cmd_stats(PyObject *UNUSED(self), PyObject *py_handle)
+{
+	if (!NDNObject_IsValid(HANDLE, py_handle)) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a NDN handle");
+		return NULL;
+	}
+
+	return handle_stats_snapshot(_pyndn_handle_get_stats(py_handle));
+}
+
+// arguments: NDN handle, callable or None, [period in seconds]
+// returns:   None
+
+PyObject *
+_pyndn_cmd_set_stats_callback(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_handle, *py_callback;
+	double period = 10.0;
+	int r;
+
+	if (!PyArg_ParseTuple(args, "OO|d", &py_handle, &py_callback, &period))
+		return NULL;
+
+	if (!NDNObject_IsValid(HANDLE, py_handle)) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a NDN handle as arg 1");
+		return NULL;
+	}
+
+	r = handle_stats_set_report(_pyndn_handle_get_stats(py_handle),
+			py_callback, period);
+	if (r < 0)
+		return NULL;
+
+	Py_RETURN_NONE;
+}
+
+// arguments: NDN handle, [reset]
+// returns:   dictionary with callback, dispatch and per prefix RTT
+//            histograms
+
+PyObject *
+_pyndn_cmd_latency(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_handle, *py_res;
+	struct handle_stats *stats;
+	int reset = 0;
+
+	if (!PyArg_ParseTuple(args, "O|i", &py_handle, &reset))
+		return NULL;
+
+	if (!NDNObject_IsValid(HANDLE, py_handle)) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a NDN handle as arg 1");
+		return NULL;
+	}
+
+	stats = _pyndn_handle_get_stats(py_handle);
+
+	py_res = handle_stats_latency(stats);
+	if (py_res && reset)
+		handle_stats_latency_reset(stats);
+
+	return py_res;
+}
+
+// arguments: NDN handle, RTT prefix components, slow upcall threshold in
+//            seconds (0 disables the tracer)
+// returns:   None
+
+PyObject *
+_pyndn_cmd_set_latency_options(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_handle;
+	struct handle_stats *stats;
+	int components;
+	double threshold;
+
+	if (!PyArg_ParseTuple(args, "Oid", &py_handle, &components, &threshold))
+		return NULL;
+
+	if (!NDNObject_IsValid(HANDLE, py_handle)) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a NDN handle as arg 1");
+		return NULL;
+	}
+
+	if (components < 0 || threshold < 0) {
+		PyErr_SetString(PyExc_ValueError, "Prefix components and slow"
+				" threshold can't be negative");
+		return NULL;
+	}
+
+	stats = _pyndn_handle_get_stats(py_handle);
+	stats->rtt_components = components;
+	stats->slow_threshold_us = threshold * 1e6;
+
+	Py_RETURN_NONE;
+}
+
+// arguments: NDN handle
+// returns:   list of the most recent slow upcalls, oldest first
+
+PyObject *
+_pyndn_cmd_slow_upcalls(PyObject *UNUSED(self), PyObject *py_handle)
+{
+	if (!NDNObject_IsValid(HANDLE, py_handle)) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a NDN handle");
+		return NULL;
+	}
+
+	return handle_stats_slow_upcalls(_pyndn_handle_get_stats(py_handle));
+}
+
 // Simple get/put
 
 PyObject *
@@ -605,19 +792,21 @@ _pyndn_cmd_get(PyObject *UNUSED(self), PyObject *args)
 	struct ndn_charbuf *name, *interest, *data;
 	struct ndn_parsed_Data *pco;
 	struct ndn_indexbuf *comps;
+	struct handle_stats *stats;
 
 	if (!PyArg_ParseTuple(args, "OO|Oi", &py_NDN, &py_Name, &py_Interest,
 			&timeout))
 		return NULL;
 
-	if (strcmp(py_NDN->ob_type->tp_name, "NDN")) {
-		PyErr_SetString(PyExc_TypeError, "Must pass a NDN as arg 1");
+	if (!PyObject_IsInstance(py_NDN, g_type_Face)) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a Face as arg 1");
 		return NULL;
 	} else {
 		py_o = PyObject_GetAttrString(py_NDN, "ndn_data");
 		JUMP_IF_NULL(py_o, exit);
 		handle = NDNObject_Get(HANDLE, py_o);
 		JUMP_IF_NULL(handle, exit);
+		stats = _pyndn_handle_get_stats(py_o);
 		Py_CLEAR(py_o);
 	}
 
@@ -661,6 +850,14 @@ _pyndn_cmd_get(PyObject *UNUSED(self), PyObject *args)
 
 	debug("ndn_get result=%d\n", r);
 
+	handle_stats_expressed(stats);
+	if (stats && r < 0)
+		stats->upcalls[NDN_UPCALL_INTEREST_TIMED_OUT]++;
+	else if (stats) {
+		stats->upcalls[NDN_UPCALL_CONTENT]++;
+		stats->bytes_in += data->length;
+	}
+
 	if (r < 0) {
 		//NDN doesn't clearly say when timeout happens, we're assuming
 		//it is when no error was set
@@ -684,14 +881,15 @@ _pyndn_cmd_put(PyObject *UNUSED(self), PyObject *args)
 	PyObject *py_ndn, *py_content_object;
 	PyObject *py_o;
 	struct ndn_charbuf *content_object;
+	struct handle_stats *stats;
 	struct ndn *handle;
 	int r;
 
 	if (!PyArg_ParseTuple(args, "OO", &py_ndn, &py_content_object))
 		return NULL;
 
-	if (strcmp(py_ndn->ob_type->tp_name, "NDN")) {
-		PyErr_SetString(PyExc_TypeError, "Must pass a NDN as arg 1");
+	if (!PyObject_IsInstance(py_ndn, g_type_Face)) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a Face as arg 1");
 		return NULL;
 	}
 	if (strcmp(py_content_object->ob_type->tp_name, "Data")) {
@@ -703,6 +901,7 @@ _pyndn_cmd_put(PyObject *UNUSED(self), PyObject *args)
 	JUMP_IF_NULL(py_o, error);
 
 	handle = NDNObject_Get(HANDLE, py_o);
+	stats = _pyndn_handle_get_stats(py_o);
 	Py_DECREF(py_o);
 	assert(handle);
 
@@ -718,6 +917,7 @@ _pyndn_cmd_put(PyObject *UNUSED(self), PyObject *args)
 		int err = ndn_geterror(handle);
 		return PyErr_Format(PyExc_IOError, "%s [%d]", strerror(err), err);
 	}
+	handle_stats_put(stats, content_object->length);
 
 	return Py_BuildValue("i", r);
 
@@ -725,76 +925,57 @@ error:
 	return NULL;
 }
 
+// Keys and key names come from key_cache.c, the keystore is only read
+// again after it changes on disk
+
 PyObject *
 _pyndn_cmd_get_default_key(PyObject *UNUSED(self), PyObject *UNUSED(arg))
 {
-	struct ndn_keystore *keystore = NULL;
-	struct ndn_charbuf *buf = NULL;
-	const struct ndn_pkey *key;
+	struct ndn_charbuf *path;
+	PyObject *py_key = NULL;
 	int r;
-	PyObject *py_ndn_key, *py_Key_obj;
-
-	buf = ndn_charbuf_create();
-	JUMP_IF_NULL_MEM(buf, error);
 
-	r = ndn_charbuf_putf(buf, "%s/.ndnx/.ndnx_keystore", getenv("HOME"));
-	JUMP_IF_NEG_MEM(r, error);
+	path = ndn_charbuf_create();
+	JUMP_IF_NULL_MEM(path, error);
 
-	keystore = ndn_keystore_create();
-	JUMP_IF_NULL_MEM(keystore, error);
+	r = key_cache_default_path(path);
+	JUMP_IF_NEG(r, error);
 
-	r = ndn_keystore_init(keystore, ndn_charbuf_as_string(buf),
+	py_key = key_cache_get_key(ndn_charbuf_as_string(path),
 			"Th1s1sn0t8g00dp8ssw0rd.");
-	ndn_charbuf_destroy(&buf);
-	if (r < 0) {
-		PyErr_Format(g_PyExc_NDNError, "Failed to initialize keystore (%d)", r);
-		goto error;
-	}
 
-	key = ndn_keystore_private_key(keystore);
-	assert(key);
+error:
+	ndn_charbuf_destroy(&path);
+	return py_key;
+}
+
+PyObject *
+_pyndn_cmd_get_default_key_name(PyObject *UNUSED(self), PyObject *UNUSED(arg))
+{
+	struct ndn_charbuf *path;
+	PyObject *py_name = NULL;
+	int r;
 
-	py_ndn_key = _pyndn_privatekey_dup(key);
-	JUMP_IF_NULL(py_ndn_key, error);
+	path = ndn_charbuf_create();
+	JUMP_IF_NULL_MEM(path, error);
 
-	py_Key_obj = Key_obj_from_ndn(py_ndn_key);
-	Py_DECREF(py_ndn_key);
-	ndn_keystore_destroy(&keystore);
+	r = key_cache_default_path(path);
+	JUMP_IF_NEG(r, error);
 
-	return py_Key_obj;
+	py_name = key_cache_get_key_name(ndn_charbuf_as_string(path));
 
 error:
-	ndn_keystore_destroy(&keystore);
-	ndn_charbuf_destroy(&buf);
-	return NULL;
+	ndn_charbuf_destroy(&path);
+	return py_name;
 }
 
+// arguments: none
+// returns:   None, keys are read from the keystores again on next use
+
 PyObject *
-_pyndn_cmd_get_default_key_name(PyObject *UNUSED(self), PyObject *UNUSED(arg))
+_pyndn_cmd_clear_key_cache(PyObject *UNUSED(self), PyObject *UNUSED(arg))
 {
-  PyObject *py_name, *py_cname;
-  struct ndn_charbuf *defaultKeyName;
-  int r;
-  struct ndn_signing_params sp = NDN_SIGNING_PARAMS_INIT;
-  struct ndn *handle = ndn_create ();
-
-  handle = ndn_create ();
-
-  defaultKeyName = ndn_charbuf_create ();
-  if (!defaultKeyName)
-    return PyErr_NoMemory ();
-
-  py_cname = NDNObject_New (NAME, defaultKeyName);
-  if (!py_cname) {
-    ndn_charbuf_destroy (&defaultKeyName);
-    return NULL;
-  }
-  
-  r = ndn_get_public_key_and_name (handle, &sp, NULL, NULL, defaultKeyName);
-
-  py_name = r < 0 ? PyErr_NoMemory() : Name_obj_from_ndn (py_cname);
-  Py_DECREF(py_cname);
-
-  ndn_destroy (&handle);
-  return py_name;
+	key_cache_clear();
+
+	Py_RETURN_NONE;
 }
@@ -25,9 +25,15 @@ PyObject *_pyndn_cmd_express_interest(PyObject *UNUSED(self),
 PyObject *_pyndn_cmd_set_interest_filter(PyObject *UNUSED(self),
 		PyObject *args);
 PyObject *_pyndn_cmd_clear_interest_filter(PyObject *UNUSED(self), PyObject *args);
+PyObject *_pyndn_cmd_stats(PyObject *self, PyObject *py_handle);
+PyObject *_pyndn_cmd_set_stats_callback(PyObject *self, PyObject *args);
+PyObject *_pyndn_cmd_latency(PyObject *self, PyObject *args);
+PyObject *_pyndn_cmd_set_latency_options(PyObject *self, PyObject *args);
+PyObject *_pyndn_cmd_slow_upcalls(PyObject *self, PyObject *py_handle);
 PyObject *_pyndn_cmd_get(PyObject *UNUSED(self), PyObject *args);
 PyObject *_pyndn_cmd_put(PyObject *UNUSED(self), PyObject *args);
 PyObject *_pyndn_cmd_get_default_key(PyObject *self, PyObject *arg);
 PyObject *_pyndn_cmd_get_default_key_name(PyObject *self, PyObject *arg);
+PyObject *_pyndn_cmd_clear_key_cache(PyObject *self, PyObject *arg);
 
 #endif	/* METHODS_HANDLE_H */
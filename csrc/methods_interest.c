@@ -10,6 +10,7 @@
 
 #include "pyndn.h"
 #include "util.h"
+#include "methods_exclusionfilter.h"
 #include "methods_name.h"
 #include "methods_interest.h"
 #include "objects.h"
@@ -35,263 +36,6 @@ is_attr_set(PyObject *py_obj, const char *attr, PyObject **value)
 	return 1;
 }
 
-// ************
-// ExclusionFilter
-//
-//
-
-static PyObject *
-ExclusionFilter_names_to_ndn(PyObject *py_obj_Names)
-{
-	PyObject *py_iterator = NULL, *py_item = NULL;
-	PyObject *py_exclude, *py_o;
-	struct ndn_charbuf *exclude, *name;
-	int r;
-
-	//  Build exclusion list - This uses explicit exclusion rather than
-	//                         Bloom filters as Bloom will be deprecated
-	//  IMPORTANT:  Exclusion component list must be sorted following
-	//              "Canonical NDNx ordering"
-	//              http://www.ndnx.org/releases/latest/doc/technical/CanonicalOrder.html
-	//              in which shortest components go first.
-	// This sorting is expected to be handled on the Python side, not here.
-
-	assert(py_obj_Names);
-
-	py_exclude = NDNObject_New_charbuf(EXCLUSION_FILTER, &exclude);
-	JUMP_IF_NULL(py_exclude, error);
-
-	if (py_obj_Names == Py_None)
-		return py_exclude;
-
-	r = ndn_charbuf_append_tt(exclude, NDN_DTAG_Exclude, NDN_DTAG);
-	JUMP_IF_NEG_MEM(r, error);
-
-	// This code is similar to what's used in Name;
-	// could probably be generalized.
-
-	py_iterator = PyObject_GetIter(py_obj_Names);
-	JUMP_IF_NULL(py_iterator, error);
-
-	while ((py_item = PyIter_Next(py_iterator))) {
-		int type;
-
-		if (!PyObject_IsInstance(py_item, g_type_Name)) {
-			PyErr_SetString(PyExc_ValueError, "Expected Name element");
-			goto error;
-		}
-
-		py_o = PyObject_GetAttrString(py_item, "type");
-		JUMP_IF_NULL(py_o, error);
-
-		type = PyLong_AsLong(py_o);
-		Py_DECREF(py_o);
-		JUMP_IF_ERR(error);
-
-		if (type == 0) {
-			py_o = PyObject_GetAttrString(py_item, "ndn_data");
-			JUMP_IF_NULL(py_o, error);
-
-			if (!NDNObject_IsValid(NAME, py_o)) {
-				Py_DECREF(py_o);
-				PyErr_SetString(PyExc_TypeError, "Expected NDN Name");
-				goto error;
-			}
-
-			name = NDNObject_Get(NAME, py_o);
-
-			/* append without NDN name tag */
-			assert(name->length >= 4);
-			r = ndn_charbuf_append(exclude, name->buf + 1, name->length - 2);
-			Py_DECREF(py_o);
-			JUMP_IF_NEG_MEM(r, error);
-		} else if (type == 1) {
-			r = ndn_charbuf_append_tt(exclude, NDN_DTAG_Any, NDN_DTAG);
-			JUMP_IF_NEG_MEM(r, error);
-
-			r = ndn_charbuf_append_closer(exclude);
-			JUMP_IF_NEG_MEM(r, error);
-		} else {
-			PyErr_SetString(PyExc_ValueError, "Unhandled Name type");
-			goto error;
-		}
-
-		Py_CLEAR(py_item);
-	}
-	Py_CLEAR(py_iterator);
-
-	r = ndn_charbuf_append_closer(exclude); /* </Exclude> */
-	JUMP_IF_NEG_MEM(r, error);
-
-	return py_exclude;
-
-error:
-	Py_XDECREF(py_item);
-	Py_XDECREF(py_iterator);
-	Py_XDECREF(py_exclude);
-	return NULL;
-}
-
-static PyObject *
-Exclusion_Any_Obj(void)
-{
-	PyObject *py_o, *py_kwds;
-	int r;
-
-	assert(g_type_Name);
-
-	py_kwds = PyDict_New();
-	JUMP_IF_NULL(py_kwds, error);
-
-	py_o = PyLong_FromLong(NAME_TYPE_ANY);
-	JUMP_IF_NULL(py_o, error);
-
-	r = PyDict_SetItemString(py_kwds, "name_type", py_o);
-	Py_DECREF(py_o);
-	JUMP_IF_NEG(r, error);
-
-	py_o = PyEval_CallObjectWithKeywords(g_type_Name, NULL, py_kwds);
-	Py_CLEAR(py_kwds);
-
-	return py_o;
-
-error:
-	Py_XDECREF(py_kwds);
-	return NULL;
-}
-
-static PyObject *
-Exclusion_Name_Obj(unsigned char *buf, size_t start, size_t stop)
-{
-	struct ndn_charbuf *name;
-	PyObject *py_name, *res;
-	int r;
-
-	py_name = NDNObject_New_charbuf(NAME, &name);
-	JUMP_IF_NULL(py_name, error);
-
-	r = ndn_name_init(name);
-	JUMP_IF_NEG_MEM(r, error);
-
-	r = ndn_name_append_components(name, buf, start, stop);
-	JUMP_IF_NEG_MEM(r, error);
-
-	res = Name_obj_from_ndn(py_name);
-	Py_DECREF(py_name);
-
-	return res;
-
-error:
-	Py_XDECREF(py_name);
-	return NULL;
-}
-
-// static PyObject *
-// ExclusionFilter_obj_from_ndn(PyObject *py_exclusion_filter)
-// {
-// 	PyObject *py_obj_ExclusionFilter, *py_components = NULL;
-// 	PyObject *py_o;
-// 	struct ndn_charbuf *exclusion_filter;
-// 	int r;
-// 	struct ndn_buf_decoder decoder, *d;
-// 	size_t start, stop;
-
-// 	assert(g_type_ExclusionFilter);
-
-// 	debug("ExclusionFilter_from_ndn start\n");
-
-// 	exclusion_filter = NDNObject_Get(EXCLUSION_FILTER, py_exclusion_filter);
-
-// 	// 1) Create python object
-// 	py_obj_ExclusionFilter = PyObject_CallObject(g_type_ExclusionFilter, NULL);
-// 	JUMP_IF_NULL(py_obj_ExclusionFilter, error);
-
-// 	// 2) Set ndn_data to a cobject pointing to the c struct
-// 	//    and ensure proper destructor is set up for the c object.
-// 	r = PyObject_SetAttrString(py_obj_ExclusionFilter, "ndn_data",
-// 			py_exclusion_filter);
-// 	JUMP_IF_NEG(r, error);
-
-// 	// 3) Parse c structure and fill python attributes
-// 	//    using PyObject_SetAttrString
-// 	//
-// 	//    self.components = None
-// 	//    # pyndn
-// 	//    self.ndn_data_dirty = False
-// 	//    self.ndn_data = None  # backing charbuf
-
-// 	py_components = PyList_New(0);
-// 	JUMP_IF_NULL(py_components, error);
-
-// 	r = PyObject_SetAttrString(py_obj_ExclusionFilter, "components",
-// 			py_components);
-// 	JUMP_IF_NEG(r, error);
-
-// 	/* begin the actual parsing */
-// 	d = ndn_buf_decoder_start(&decoder, exclusion_filter->buf,
-// 			exclusion_filter->length);
-
-// 	r = ndn_buf_match_dtag(d, NDN_DTAG_Exclude);
-// 	JUMP_IF_NEG(r, parse_error);
-// 	ndn_buf_advance(d);
-
-// 	r = ndn_buf_match_dtag(d, NDN_DTAG_Any);
-// 	JUMP_IF_NEG(r, error);
-// 	if (r) {
-// 		ndn_buf_advance(d);
-// 		ndn_buf_check_close(d);
-// 		debug("got any: %d\n", r);
-
-// 		py_o = Exclusion_Any_Obj();
-// 		JUMP_IF_NULL(py_o, error);
-
-// 		r = PyList_Append(py_components, py_o);
-// 		Py_DECREF(py_o);
-// 		JUMP_IF_NEG(r, error);
-// 	}
-
-// 	while (ndn_buf_match_dtag(d, NDN_DTAG_Component)) {
-// 		start = d->decoder.token_index;
-// 		r = ndn_parse_required_tagged_BLOB(d, NDN_DTAG_Component, 0, -1);
-// 		JUMP_IF_NEG(r, error);
-// 		stop = d->decoder.token_index;
-// 		debug("got name\n");
-
-// 		py_o = Exclusion_Name_Obj(exclusion_filter->buf, start, stop);
-// 		r = PyList_Append(py_components, py_o);
-// 		Py_DECREF(py_o);
-// 		JUMP_IF_NEG(r, error);
-
-// 		r = ndn_buf_match_dtag(d, NDN_DTAG_Any);
-// 		if (r) {
-// 			ndn_buf_advance(d);
-// 			ndn_buf_check_close(d);
-// 			debug("got *any*: %d\n", r);
-
-// 			py_o = Exclusion_Any_Obj();
-// 			JUMP_IF_NULL(py_o, error);
-
-// 			r = PyList_Append(py_components, py_o);
-// 			Py_DECREF(py_o);
-// 			JUMP_IF_NEG(r, error);
-// 		}
-// 	}
-// 	ndn_buf_check_close(d);
-// 	JUMP_IF_NEG(d->decoder.state, parse_error);
-
-// 	// 4) Return the created object
-// 	debug("ExclusionFilter_from_ndn ends\n");
-
-// 	return py_obj_ExclusionFilter;
-
-// parse_error:
-// 	PyErr_SetString(g_PyExc_NDNExclusionFilterError, "error parsing the data");
-// error:
-// 	Py_XDECREF(py_components);
-// 	Py_XDECREF(py_obj_ExclusionFilter);
-// 	return NULL;
-// }
-
 // ************
 // Interest
 //
@@ -404,25 +148,38 @@ Interest_obj_to_ndn(PyObject *py_obj_Interest)
 
 	r = is_attr_set(py_obj_Interest, "exclude", &py_o);
 	JUMP_IF_NEG(r, error);
-	// if (r) {
-	// 	PyObject *py_exclusions;
-	// 	struct ndn_charbuf *exclusion_filter;
-
-	// 	if (!PyObject_IsInstance(py_o, g_type_ExclusionFilter)) {
-	// 		Py_DECREF(py_o);
-	// 		PyErr_SetString(PyExc_TypeError, "Expected ExclusionFilter");
-	// 		goto error;
-	// 	}
-
-	// 	r = is_attr_set(py_o, "ndn_data", &py_exclusions);
-	// 	Py_DECREF(py_o);
-	// 	JUMP_IF_NEG(r, error);
-
-	// 	exclusion_filter = NDNObject_Get(EXCLUSION_FILTER, py_exclusions);
-	// 	r = ndn_charbuf_append_charbuf(interest, exclusion_filter);
-	// 	Py_DECREF(py_exclusions);
-	// 	JUMP_IF_NEG(r, error);
-	// }
+	if (r) {
+		PyObject *py_exclusions;
+		const struct ndn_charbuf *exclusion_filter;
+
+		if (!PyObject_IsInstance(py_o, g_type_ExclusionFilter)) {
+			Py_DECREF(py_o);
+			PyErr_SetString(PyExc_TypeError, "Expected ExclusionFilter");
+			goto error;
+		}
+
+		py_exclusions = PyObject_GetAttrString(py_o, "ndn_data");
+		Py_DECREF(py_o);
+		JUMP_IF_NULL(py_exclusions, error);
+
+		if (!NDNObject_ReqType(EXCLUSION_FILTER, py_exclusions)) {
+			Py_DECREF(py_exclusions);
+			goto error;
+		}
+
+		/* cached by the filter, usually no re-encoding happens here */
+		exclusion_filter = exclusion_filter_encode(
+				NDNObject_Get(EXCLUSION_FILTER, py_exclusions));
+		if (!exclusion_filter) {
+			Py_DECREF(py_exclusions);
+			PyErr_NoMemory();
+			goto error;
+		}
+
+		r = ndn_charbuf_append_charbuf(interest, exclusion_filter);
+		Py_DECREF(py_exclusions);
+		JUMP_IF_NEG_MEM(r, error);
+	}
 
 	r = process_int_attribute(interest, NDN_DTAG_ChildSelector,
 			py_obj_Interest, "childSelector");
@@ -623,21 +380,33 @@ Interest_obj_from_ndn(PyObject *py_interest)
 	len = pi->offset[NDN_PI_E_Exclude] - pi->offset[NDN_PI_B_Exclude];
 	if (len > 0) {
 		PyObject *py_exclusion_filter;
+		struct exclusion_filter *ef;
 
-		py_exclusion_filter = NDNObject_New_charbuf(EXCLUSION_FILTER, &cb);
-		JUMP_IF_NULL(py_exclusion_filter, error);
+		ef = exclusion_filter_create();
+		JUMP_IF_NULL_MEM(ef, error);
 
-		r = ndn_charbuf_append(cb, interest->buf + pi->offset[NDN_PI_B_Exclude],
-				len);
-		JUMP_IF_NEG_MEM(r, error);
+		py_exclusion_filter = NDNObject_New(EXCLUSION_FILTER, ef);
+		if (!py_exclusion_filter) {
+			exclusion_filter_destroy(&ef);
+			goto error;
+		}
+
+		r = exclusion_filter_parse(ef, interest->buf,
+				pi->offset[NDN_PI_B_Exclude], pi->offset[NDN_PI_E_Exclude]);
+		if (r < 0) {
+			Py_DECREF(py_exclusion_filter);
+			PyErr_SetString(g_PyExc_NDNExclusionFilterError, "error parsing"
+					" the data");
+			goto error;
+		}
 
-		// py_o = ExclusionFilter_obj_from_ndn(py_exclusion_filter);
-		// Py_DECREF(py_exclusion_filter);
-		// JUMP_IF_NULL(py_o, error);
+		py_o = ExclusionFilter_obj_from_ndn(py_exclusion_filter);
+		Py_DECREF(py_exclusion_filter);
+		JUMP_IF_NULL(py_o, error);
 
-		// r = PyObject_SetAttrString(py_obj_Interest, "exclude", py_o);
-		// Py_DECREF(py_o);
-		// JUMP_IF_NEG(r, error);
+		r = PyObject_SetAttrString(py_obj_Interest, "exclude", py_o);
+		Py_DECREF(py_o);
+		JUMP_IF_NEG(r, error);
 	}
 
 	//        self.childSelector = None
@@ -813,6 +582,127 @@ _pyndn_interest_set_pi(PyObject *py_interest, struct ndn_parsed_interest *pi)
 	context->pi = pi;
 }
 
+/*
+ * Template for interests issued from C (version resolver, crawler), the name
+ * is supplied to ndn_express_interest() separately.  Negative child_selector
+ * omits the selector, lifetime is in 1/4096 s and 0 leaves the default.
+ */
+int
+_pyndn_interest_probe_template(struct ndn_charbuf *templ,
+		const struct ndn_charbuf *exclude, int child_selector,
+		unsigned long lifetime)
+{
+	unsigned char buf[3];
+	int r;
+
+	ndn_charbuf_reset(templ);
+
+	r = ndn_charbuf_append_tt(templ, NDN_DTAG_Interest, NDN_DTAG);
+	if (r < 0)
+		return r;
+
+	r = ndn_charbuf_append_tt(templ, NDN_DTAG_Name, NDN_DTAG);
+	if (r < 0)
+		return r;
+
+	r = ndn_charbuf_append_closer(templ); /* </Name> */
+	if (r < 0)
+		return r;
+
+	if (exclude) {
+		r = ndn_charbuf_append_charbuf(templ, exclude);
+		if (r < 0)
+			return r;
+	}
+
+	if (child_selector >= 0) {
+		r = ndnb_tagged_putf(templ, NDN_DTAG_ChildSelector, "%d",
+				child_selector);
+		if (r < 0)
+			return r;
+	}
+
+	if (lifetime) {
+		/* same three byte encoding as Interest_obj_to_ndn() */
+		if (lifetime > 0xffffff)
+			lifetime = 0xffffff;
+
+		for (int i = sizeof(buf) - 1; i >= 0; i--, lifetime >>= 8)
+			buf[i] = lifetime & 0xff;
+
+		r = ndnb_append_tagged_blob(templ, NDN_DTAG_InterestLifetime,
+				buf, sizeof(buf));
+		if (r < 0)
+			return r;
+	}
+
+	return ndn_charbuf_append_closer(templ); /* </Interest> */
+}
+
+/*
+ * Strips the name and the nonce from an encoded interest, leaving
+ * <Interest><Name/>selectors</Interest>. ndn_express_interest() splices the
+ * requested name in front of the selectors (parsing the template as it does
+ * so) and the nonce is generated fresh for every expressed interest.
+ */
+static PyObject *
+Interest_template_compile(PyObject *py_interest)
+{
+	struct ndn_charbuf *interest, *templ;
+	struct ndn_parsed_interest *pi, templ_pi;
+	PyObject *py_templ;
+	size_t start, stop;
+	int r;
+
+	interest = NDNObject_Get(INTEREST, py_interest);
+
+	pi = _pyndn_interest_get_pi(py_interest);
+	if (!pi)
+		return NULL;
+
+	py_templ = NDNObject_New_charbuf(INTEREST, &templ);
+	if (!py_templ)
+		return NULL;
+
+	r = ndn_charbuf_append_tt(templ, NDN_DTAG_Interest, NDN_DTAG);
+	JUMP_IF_NEG_MEM(r, error);
+
+	r = ndn_charbuf_append_tt(templ, NDN_DTAG_Name, NDN_DTAG);
+	JUMP_IF_NEG_MEM(r, error);
+
+	r = ndn_charbuf_append_closer(templ); /* </Name> */
+	JUMP_IF_NEG_MEM(r, error);
+
+	/* selectors, everything between </Name> and <Nonce> */
+	start = pi->offset[NDN_PI_E_Name];
+	stop = pi->offset[NDN_PI_B_Nonce];
+	r = ndn_charbuf_append(templ, interest->buf + start, stop - start);
+	JUMP_IF_NEG_MEM(r, error);
+
+	/* elements we don't know about, but should pass along */
+	start = pi->offset[NDN_PI_B_OTHER];
+	stop = pi->offset[NDN_PI_E_OTHER];
+	r = ndn_charbuf_append(templ, interest->buf + start, stop - start);
+	JUMP_IF_NEG_MEM(r, error);
+
+	r = ndn_charbuf_append_closer(templ); /* </Interest> */
+	JUMP_IF_NEG_MEM(r, error);
+
+	/* better to fail here than on every expressInterest() */
+	r = ndn_parse_interest(templ->buf, templ->length, &templ_pi, NULL);
+	if (r < 0) {
+		PyErr_SetString(g_PyExc_NDNInterestError, "Unable to compile the"
+				" Interest template");
+		goto error;
+	}
+
+	return py_templ;
+
+error:
+	Py_DECREF(py_templ);
+	return NULL;
+}
+
 /*
  * From within python
  */
@@ -841,24 +731,28 @@ _pyndn_cmd_Interest_obj_from_ndn(PyObject *UNUSED(self), PyObject *py_interest)
 }
 
 PyObject *
-_pyndn_cmd_ExclusionFilter_names_to_ndn(PyObject *UNUSED(self), PyObject *py_names)
+_pyndn_cmd_compile_interest_template(PyObject *UNUSED(self),
+		PyObject *py_obj_Interest)
 {
-	if (!PyList_Check(py_names)) {
-		PyErr_SetString(PyExc_TypeError, "Must pass a list of NDN names");
+	PyObject *py_interest, *py_templ;
+
+	if (strcmp(py_obj_Interest->ob_type->tp_name, "Interest") != 0) {
+		PyErr_SetString(PyExc_TypeError, "Must pass an Interest");
 		return NULL;
 	}
 
-	return ExclusionFilter_names_to_ndn(py_names);
-}
+	py_interest = PyObject_GetAttrString(py_obj_Interest, "ndn_data");
+	if (!py_interest)
+		return NULL;
+
+	if (!NDNObject_IsValid(INTEREST, py_interest)) {
+		Py_DECREF(py_interest);
+		PyErr_SetString(PyExc_TypeError, "Expected NDN Interest");
+		return NULL;
+	}
 
-// PyObject *
-// _pyndn_cmd_ExclusionFilter_obj_from_ndn(PyObject *UNUSED(self),
-// 		PyObject *py_exclusion_filter)
-// {
-// 	if (!NDNObject_IsValid(EXCLUSION_FILTER, py_exclusion_filter)) {
-// 		PyErr_SetString(PyExc_TypeError, "Must pass a NDN Exclusion Filter");
-// 		return NULL;
-// 	}
-
-// 	return ExclusionFilter_obj_from_ndn(py_exclusion_filter);
-// }
+	py_templ = Interest_template_compile(py_interest);
+	Py_DECREF(py_interest);
+
+	return py_templ;
+}
@@ -12,13 +12,14 @@ PyObject *Interest_obj_from_ndn(PyObject *py_interest);
 struct ndn_parsed_interest *_pyndn_interest_get_pi(PyObject *py_interest);
 void _pyndn_interest_set_pi(PyObject *py_interest,
 		struct ndn_parsed_interest *pi);
+int _pyndn_interest_probe_template(struct ndn_charbuf *templ,
+		const struct ndn_charbuf *exclude, int child_selector,
+		unsigned long lifetime);
 PyObject *_pyndn_cmd_Interest_obj_to_ndn(PyObject *UNUSED(self),
 		PyObject *py_interest);
 PyObject *_pyndn_cmd_Interest_obj_from_ndn(PyObject *UNUSED(self), PyObject *args);
-// PyObject *_pyndn_cmd_ExclusionFilter_names_to_ndn(PyObject *UNUSED(self),
-// 		PyObject* args);
-// PyObject *_pyndn_cmd_ExclusionFilter_obj_from_ndn(PyObject *UNUSED(self),
-// 		PyObject* args);
+PyObject *_pyndn_cmd_compile_interest_template(PyObject *UNUSED(self),
+		PyObject *py_obj_Interest);
 
 #endif	/* METHODS_INTERESTS_H */
 
@@ -192,7 +192,7 @@ Key_obj_from_ndn(PyObject *py_key_ndn)
 	// in ndn_client, but *for now* it boils down to the same thing.
 
 	/* type */
-	py_o = PyUnicode_FromString("RSA");
+	py_o = PyUnicode_FromString(key_type_name(key_ndn));
 	JUMP_IF_NULL(py_o, error);
 	r = PyObject_SetAttrString(py_obj_Key, "type", py_o);
 	Py_DECREF(py_o);
@@ -12,7 +12,11 @@
 #include <openssl/evp.h>
 #include <openssl/err.h>
 
+#include <pthread.h>
+
 #include "namecrypto/authentication.h"
+#include "namecrypto/encryption.h"
+#include "namecrypto/verifier.h"
 
 #include "pyndn.h"
 #include "util.h"
@@ -42,49 +46,123 @@ error:
 	return NULL;
 }
 
-PyObject *
-_pyndn_cmd_nc_authenticate_command(PyObject *UNUSED(self), PyObject *args)
+static pthread_key_t g_hmac_key;
+static pthread_once_t g_hmac_once = PTHREAD_ONCE_INIT;
+
+static void
+command_hmac_free(void *ctx)
+{
+	HMAC_CTX_free(ctx);
+}
+
+static void
+command_hmac_init(void)
+{
+	pthread_key_create(&g_hmac_key, command_hmac_free);
+}
+
+/*
+ * HMAC context for authenticating commands, one per thread since commands
+ * are authenticated without the GIL
+ */
+static HMAC_CTX *
+command_hmac(void)
+{
+	HMAC_CTX *ctx;
+
+	pthread_once(&g_hmac_once, command_hmac_init);
+
+	ctx = pthread_getspecific(g_hmac_key);
+	if (!ctx) {
+		ctx = HMAC_CTX_new();
+		if (ctx && pthread_setspecific(g_hmac_key, ctx)) {
+			HMAC_CTX_free(ctx);
+			ctx = NULL;
+		}
+	}
+
+	return ctx;
+}
+
+static int
+authenticate_command(PyObject *py_state, PyObject *py_name,
+		PyObject *py_appname, PyObject *py_appkey, struct ndn_charbuf *out)
 {
-	PyObject *py_state, *py_name, *py_appname, *py_appkey;
-	PyObject *py_new_name;
 	state *auth_state;
-	struct ndn_charbuf *name, *new_name;
+	struct ndn_charbuf *name;
 	unsigned char *appname, *appkey;
 	Py_ssize_t appname_len, appkey_len;
+	HMAC_CTX *ctx;
 	int r;
 
-	if (!PyArg_ParseTuple(args, "OOOO", &py_state, &py_name, &py_appname, &py_appkey))
-		return NULL;
-
 	if (!NDNObject_ReqType(NAMECRYPTO_STATE, py_state))
-		return NULL;
+		return -1;
 
 	if (!NDNObject_ReqType(NAME, py_name))
-		return NULL;
+		return -1;
 
 	auth_state = NDNObject_Get(NAMECRYPTO_STATE, py_state);
 	name = NDNObject_Get(NAME, py_name);
 
+	if (name == out) {
+		PyErr_SetString(PyExc_ValueError, "The output can't be the command"
+				" name");
+		return -1;
+	}
+
 	if (PyBytes_AsStringAndSize(py_appname, (char **) &appname, &appname_len) < 0)
-		return NULL;
+		return -1;
 
 	if (PyBytes_AsStringAndSize(py_appkey, (char **) &appkey, &appkey_len) < 0)
-		return NULL;
+		return -1;
 
 	if (appkey_len != APPKEYLEN) {
 		PyErr_Format(PyExc_ValueError, "key length needs to be %d bytes long", APPKEYLEN);
-		return NULL;
+		return -1;
+	}
+
+	ctx = command_hmac();
+	if (!ctx) {
+		PyErr_NoMemory();
+		return -1;
+	}
+
+	/*
+	 * the state is updated atomically, other threads may use it meanwhile;
+	 * the arguments keep the buffers alive
+	 */
+	Py_BEGIN_ALLOW_THREADS
+	r = authenticateCommandInto(auth_state, name, appname, appname_len,
+			appkey, ctx, out);
+	Py_END_ALLOW_THREADS
+
+	if (r < 0) {
+		PyErr_SetString(g_PyExc_NDNError, "Unable to authenticate the command");
+		return -1;
 	}
 
+	return 0;
+}
+
+PyObject *
+_pyndn_cmd_nc_authenticate_command(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_state, *py_name, *py_appname, *py_appkey;
+	PyObject *py_new_name;
+	struct ndn_charbuf *new_name;
+	int r;
+
+	if (!PyArg_ParseTuple(args, "OOOO", &py_state, &py_name, &py_appname, &py_appkey))
+		return NULL;
+
 	py_new_name = NDNObject_New_charbuf(NAME, &new_name);
 	JUMP_IF_NULL(py_new_name, error);
 
-	r = ndn_charbuf_append_charbuf(new_name, name);
+	r = authenticate_command(py_state, py_name, py_appname, py_appkey,
+			new_name);
 	if (r < 0)
 		Py_DECREF(py_new_name);
-	JUMP_IF_NEG_MEM(r, error);
-
-	authenticateCommand(auth_state, new_name, appname, appname_len, appkey);
+	JUMP_IF_NEG(r, error);
 
 	return py_new_name;
 
@@ -92,6 +170,29 @@ error:
 	return NULL;
 }
 
+// arguments: state, Name_ndn_data, appname, appkey, Name_ndn_data for the result
+// returns: None, the second name is overwritten and can be reused
+PyObject *
+_pyndn_cmd_nc_authenticate_command_into(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_state, *py_name, *py_appname, *py_appkey, *py_out;
+	int r;
+
+	if (!PyArg_ParseTuple(args, "OOOOO", &py_state, &py_name, &py_appname,
+			&py_appkey, &py_out))
+		return NULL;
+
+	if (!NDNObject_ReqType(NAME, py_out))
+		return NULL;
+
+	r = authenticate_command(py_state, py_name, py_appname, py_appkey,
+			NDNObject_Get(NAME, py_out));
+	if (r < 0)
+		return NULL;
+
+	Py_RETURN_NONE;
+}
+
 PyObject *
 _pyndn_cmd_nc_authenticate_command_sig(PyObject *UNUSED(self), PyObject *args)
 {
@@ -217,6 +318,146 @@ openssl_error:
 	return NULL;
 }
 
+// arguments: maxdiff_ms, fixture_key=None, pub_key=None, window
+// returns: verifier keeping the derived keys and a replay window per app
+PyObject *
+_pyndn_cmd_nc_new_verifier(PyObject *UNUSED(self), PyObject *args,
+		PyObject *kwds)
+{
+	unsigned long maxtime_ms;
+	unsigned int window = NC_WINDOW_DEFAULT;
+	PyObject *py_fixture_key = Py_None, *py_pub_key = Py_None;
+	PyObject *py_verifier;
+	unsigned char *fixture_key = NULL;
+	Py_ssize_t fixture_key_len = 0;
+	struct ndn_pkey *pub_key;
+	RSA *rsa_pub_key = NULL;
+	struct nc_verifier *verifier;
+	unsigned long err;
+
+	static char *kwlist[] = {"maxdiff_ms", "fixture_key", "pub_key", "window",
+		NULL};
+
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "k|OOI", kwlist, &maxtime_ms,
+			&py_fixture_key, &py_pub_key, &window))
+		return NULL;
+
+	if (window < 1 || window > NC_WINDOW_MAX) {
+		PyErr_Format(PyExc_ValueError, "window needs to be between 1 and %d",
+				NC_WINDOW_MAX);
+		return NULL;
+	}
+
+	if (py_fixture_key != Py_None && PyBytes_AsStringAndSize(py_fixture_key,
+			(char **) &fixture_key, &fixture_key_len) < 0)
+		return NULL;
+
+	if (py_pub_key != Py_None) {
+		if (!NDNObject_ReqType(PKEY_PUB, py_pub_key))
+			return NULL;
+		pub_key = NDNObject_Get(PKEY_PUB, py_pub_key);
+		rsa_pub_key = EVP_PKEY_get1_RSA((EVP_PKEY *) pub_key);
+		JUMP_IF_NULL(rsa_pub_key, openssl_error);
+	}
+
+	/* the verifier owns rsa_pub_key from now on */
+	verifier = nc_verifier_create(fixture_key, fixture_key_len, rsa_pub_key,
+			maxtime_ms, window);
+	if (!verifier) {
+		if (rsa_pub_key)
+			RSA_free(rsa_pub_key);
+		return PyErr_NoMemory();
+	}
+
+	py_verifier = NDNObject_New(NAMECRYPTO_VERIFIER, verifier);
+	if (!py_verifier)
+		nc_verifier_destroy(&verifier);
+
+	return py_verifier;
+
+openssl_error:
+	err = ERR_get_error();
+	PyErr_Format(g_PyExc_NDNKeyError, "Unable to convert given key to RSA: %s",
+			ERR_reason_error_string(err));
+	return NULL;
+}
+
+// arguments: verifier, sequence of Name_ndn_data
+// returns: list with True or the error code for every name
+PyObject *
+_pyndn_cmd_nc_verify_batch(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_verifier, *py_names, *py_seq = NULL, *py_result = NULL;
+	PyObject *py_o;
+	struct nc_verifier *verifier;
+	const struct ndn_charbuf **names = NULL;
+	int *results = NULL;
+	Py_ssize_t i, n;
+
+	if (!PyArg_ParseTuple(args, "OO", &py_verifier, &py_names))
+		return NULL;
+
+	if (!NDNObject_ReqType(NAMECRYPTO_VERIFIER, py_verifier))
+		return NULL;
+
+	verifier = NDNObject_Get(NAMECRYPTO_VERIFIER, py_verifier);
+
+	/* py_seq keeps the names alive while the lock is released */
+	py_seq = PySequence_Fast(py_names, "names must be a sequence");
+	JUMP_IF_NULL(py_seq, error);
+
+	n = PySequence_Fast_GET_SIZE(py_seq);
+	names = PyMem_New(const struct ndn_charbuf *, n ? n : 1);
+	results = PyMem_New(int, n ? n : 1);
+	if (!names || !results) {
+		PyErr_NoMemory();
+		goto error;
+	}
+
+	for (i = 0; i < n; i++) {
+		py_o = PySequence_Fast_GET_ITEM(py_seq, i);
+		if (!NDNObject_ReqType(NAME, py_o))
+			goto error;
+		names[i] = NDNObject_Get(NAME, py_o);
+	}
+
+	if (nc_verifier_claim(verifier) < 0) {
+		PyErr_SetString(PyExc_RuntimeError, "The verifier is being used by"
+				" another thread");
+		goto error;
+	}
+
+	Py_BEGIN_ALLOW_THREADS
+	for (i = 0; i < n; i++)
+		results[i] = nc_verifier_verify(verifier, names[i]);
+	Py_END_ALLOW_THREADS
+
+	nc_verifier_release(verifier);
+
+	py_result = PyList_New(n);
+	JUMP_IF_NULL(py_result, error);
+
+	for (i = 0; i < n; i++) {
+		if (results[i] == AUTH_OK) {
+			Py_INCREF(Py_True);
+			py_o = Py_True;
+		} else {
+			py_o = _pyndn_Int_FromLong(results[i]);
+			if (!py_o) {
+				Py_CLEAR(py_result);
+				goto error;
+			}
+		}
+		PyList_SET_ITEM(py_result, i, py_o);
+	}
+
+error:
+	PyMem_Free(results);
+	PyMem_Free(names);
+	Py_XDECREF(py_seq);
+	return py_result;
+}
+
 PyObject *
 _pyndn_cmd_nc_app_id(PyObject *UNUSED(self), PyObject *py_appname)
 {
@@ -10,10 +10,15 @@
 
 PyObject *_pyndn_cmd_nc_new_state(PyObject *self, PyObject *args);
 PyObject *_pyndn_cmd_nc_authenticate_command(PyObject *self, PyObject *args);
+PyObject *_pyndn_cmd_nc_authenticate_command_into(PyObject *self,
+		PyObject *args);
 PyObject *_pyndn_cmd_nc_authenticate_command_sig(PyObject *self,
 		PyObject *args);
 PyObject *_pyndn_cmd_nc_verify_command(PyObject *self, PyObject *args,
 		PyObject *kwds);
+PyObject *_pyndn_cmd_nc_new_verifier(PyObject *self, PyObject *args,
+		PyObject *kwds);
+PyObject *_pyndn_cmd_nc_verify_batch(PyObject *self, PyObject *args);
 PyObject *_pyndn_cmd_nc_app_id(PyObject *self, PyObject *py_appname);
 PyObject *_pyndn_cmd_nc_app_key(PyObject *self, PyObject *args);
 
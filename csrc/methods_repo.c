@@ -0,0 +1,401 @@
+/*
+ * Copyright (c) 2011, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ * Written by: Derek Kulinski <takeda@takeda.tk>
+ *             Jeff Burke <jburke@ucla.edu>
+ */
+
+#include "python_hdr.h"
+#include <ndn/ndn.h>
+
+#include <stdlib.h>
+
+#include "pyndn.h"
+#include "util.h"
+#include "content_index.h"
+#include "methods_repo.h"
+#include "objects.h"
+#include "stats.h"
+
+// Repository upload
+//
+// The repo is asked to start a write under the name, and then it fetches
+// the segments with interests. Pending Data packets are kept in a
+// content_index, so each interest is served with a binary search. Data
+// packets are pulled from a Python iterator and at most window of them are
+// held in memory at any time.
+
+struct repo_upload {
+	struct ndn_closure filter;        /* the repo's interests */
+	struct ndn_closure start_write;   /* reply to the start write command */
+	PyObject *capsule;                /* ourselves, held by each closure */
+	struct ndn *handle;
+	struct handle_stats *stats;
+	struct ndn_charbuf *name;
+	struct content_index *pending;
+	size_t window;
+	PyObject *py_face;                /* keeps the handle alive */
+	PyObject *py_source;              /* NULL once exhausted */
+	PyObject *py_on_done;
+	int filter_set;
+	int finished;
+
+	/* progress */
+	long long started, last;          /* _pyndn_monotonic_ms() */
+	unsigned long served;
+	unsigned long long bytes;
+	unsigned long interests;
+	unsigned long unmatched;
+};
+
+void
+repo_upload_destroy(struct repo_upload **rup)
+{
+	struct repo_upload *ru = *rup;
+
+	if (!ru)
+		return;
+
+	ndn_charbuf_destroy(&ru->name);
+	content_index_destroy(&ru->pending);
+
+	Py_XDECREF(ru->py_face);
+	Py_XDECREF(ru->py_source);
+	Py_XDECREF(ru->py_on_done);
+
+	free(ru);
+	*rup = NULL;
+}
+
+/* Tops the pending index up to the window from the source iterator */
+static int
+repo_upload_fill(struct repo_upload *ru)
+{
+	PyObject *py_data, *py_o;
+	struct ndn_charbuf *co;
+	int r;
+
+	while (ru->py_source && content_index_count(ru->pending) < ru->window) {
+		py_data = PyIter_Next(ru->py_source);
+		if (!py_data) {
+			Py_CLEAR(ru->py_source);
+			return PyErr_Occurred() ? -1 : 0;
+		}
+
+		if (!PyObject_IsInstance(py_data, g_type_Data)) {
+			Py_DECREF(py_data);
+			PyErr_SetString(PyExc_TypeError, "Upload source has to yield"
+					" Data objects");
+			return -1;
+		}
+
+		py_o = PyObject_GetAttrString(py_data, "ndn_data");
+		Py_DECREF(py_data);
+		if (!py_o)
+			return -1;
+
+		if (!NDNObject_ReqType(CONTENT_OBJECT, py_o)) {
+			Py_DECREF(py_o);
+			return -1;
+		}
+
+		co = NDNObject_Get(CONTENT_OBJECT, py_o);
+		r = content_index_add(ru->pending, co->buf, co->length);
+		Py_DECREF(py_o);
+		if (r == -1) {
+			PyErr_NoMemory();
+			return -1;
+		} else if (r < 0) {
+			PyErr_SetString(g_PyExc_NDNDataError, "Unable to parse Data"
+					" packet");
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static void
+repo_upload_finish(struct repo_upload *ru)
+{
+	PyObject *py_res;
+
+	if (ru->finished)
+		return;
+	ru->finished = 1;
+
+	/* clearing the filter might drop the last reference to us */
+	Py_INCREF(ru->capsule);
+
+	/* NDN_UPCALL_FINAL on the filter closure releases its reference */
+	if (ru->filter_set)
+		ndn_set_interest_filter(ru->handle, ru->name, NULL);
+
+	if (ru->py_on_done != Py_None) {
+		py_res = PyObject_CallFunction(ru->py_on_done, "O", ru->capsule);
+		if (py_res)
+			Py_DECREF(py_res);
+		else
+			PyErr_Print();
+
+		/* it's called once, don't keep whatever it references alive */
+		Py_DECREF(ru->py_on_done);
+		Py_INCREF(Py_None);
+		ru->py_on_done = Py_None;
+	}
+
+	Py_DECREF(ru->capsule);
+}
+
+static enum ndn_upcall_res
+repo_upload_serve(struct repo_upload *ru, struct ndn_upcall_info *info)
+{
+	const struct ndn_charbuf *co;
+	int i, r;
+
+	ru->interests++;
+
+	i = content_index_match(ru->pending, info->interest_ndnb,
+			info->pi->offset[NDN_PI_E], info->pi);
+	if (i < 0) {
+		ru->unmatched++;
+		return NDN_UPCALL_RESULT_OK;
+	}
+
+	co = content_index_get(ru->pending, i);
+	r = ndn_put(info->h, co->buf, co->length);
+	if (r < 0) {
+		debug("Unable to put segment\n");
+		return NDN_UPCALL_RESULT_OK;
+	}
+	handle_stats_put(ru->stats, co->length);
+
+	ru->served++;
+	ru->bytes += co->length;
+	ru->last = _pyndn_monotonic_ms();
+	content_index_remove(ru->pending, i);
+
+	r = repo_upload_fill(ru);
+	if (r < 0) {
+		/* the source broke, nothing more will be uploaded */
+		PyErr_Print();
+		Py_CLEAR(ru->py_source);
+	}
+
+	if (!ru->py_source && !content_index_count(ru->pending))
+		repo_upload_finish(ru);
+
+	return NDN_UPCALL_RESULT_INTEREST_CONSUMED;
+}
+
+static enum ndn_upcall_res
+repo_upload_upcall(struct ndn_closure *selfp, enum ndn_upcall_kind upcall_kind,
+		struct ndn_upcall_info *info)
+{
+	struct repo_upload *ru = selfp->data;
+	enum ndn_upcall_res res = NDN_UPCALL_RESULT_OK;
+	struct handle_stats *stats = (struct handle_stats *) selfp->intdata;
+	PyGILState_STATE gstate;
+	long long entered;
+
+	debug("repo_upload_upcall dispatched kind %d\n", upcall_kind);
+
+	assert(ru);
+
+	entered = handle_stats_upcall_enter(selfp, upcall_kind, info, &gstate);
+
+	switch (upcall_kind) {
+	case NDN_UPCALL_FINAL:
+		if (selfp == &ru->filter)
+			ru->filter_set = 0;
+		Py_DECREF(ru->capsule);
+		break;
+	case NDN_UPCALL_INTEREST:
+		if (selfp == &ru->filter && !ru->finished)
+			res = repo_upload_serve(ru, info);
+		break;
+	default:
+		/* the start write reply carries nothing we need */
+		break;
+	}
+
+	handle_stats_upcall_leave(stats, entered, upcall_kind, info,
+			"RepoUpload", gstate);
+
+	return res;
+}
+
+static int
+repo_upload_start_write(struct repo_upload *ru)
+{
+	struct ndn_charbuf *command;
+	int r;
+
+	command = ndn_charbuf_create();
+	if (!command)
+		return -1;
+
+	r = ndn_charbuf_append_charbuf(command, ru->name);
+	if (r >= 0)
+		r = ndn_name_append_str(command, "\xC1.R.sw");
+	if (r >= 0)
+		r = ndn_name_append_nonce(command);
+	if (r >= 0) {
+		Py_INCREF(ru->capsule);
+		r = ndn_express_interest(ru->handle, command, &ru->start_write,
+				NULL);
+		if (r < 0)
+			Py_DECREF(ru->capsule);
+		else
+			handle_stats_expressed(ru->stats);
+	}
+
+	ndn_charbuf_destroy(&command);
+
+	return r;
+}
+
+// arguments: Face, Name, iterable of Data, [window, onDone callable or None]
+// returns:   upload session, onDone(session) is called from ndn_run() after
+//            the last Data was served
+
+PyObject *
+_pyndn_cmd_repo_upload_start(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_face, *py_name, *py_content, *py_on_done = Py_None;
+	PyObject *py_o, *py_capsule = NULL;
+	struct repo_upload *ru = NULL;
+	struct ndn_charbuf *name;
+	int window = 64, r;
+
+	if (!PyArg_ParseTuple(args, "OOO|iO", &py_face, &py_name, &py_content,
+			&window, &py_on_done))
+		return NULL;
+
+	if (!PyObject_IsInstance(py_face, g_type_Face)) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a Face as arg 1");
+		return NULL;
+	}
+	if (strcmp(py_name->ob_type->tp_name, "Name")) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a Name as arg 2");
+		return NULL;
+	}
+	if (window < 1) {
+		PyErr_SetString(PyExc_ValueError, "Window has to hold at least one"
+				" Data packet");
+		return NULL;
+	}
+	if (py_on_done != Py_None && !PyCallable_Check(py_on_done)) {
+		PyErr_SetString(PyExc_TypeError, "onDone must be callable or None");
+		return NULL;
+	}
+
+	ru = calloc(1, sizeof(*ru));
+	JUMP_IF_NULL_MEM(ru, error);
+
+	ru->filter.p = repo_upload_upcall;
+	ru->filter.data = ru;
+	ru->start_write.p = repo_upload_upcall;
+	ru->start_write.data = ru;
+	ru->window = window;
+
+	py_o = PyObject_GetAttrString(py_face, "ndn_data");
+	JUMP_IF_NULL(py_o, error);
+	ru->handle = NDNObject_Get(HANDLE, py_o);
+	ru->stats = _pyndn_handle_get_stats(py_o);
+	ru->filter.intdata = (intptr_t) ru->stats;
+	ru->start_write.intdata = (intptr_t) ru->stats;
+	Py_DECREF(py_o);
+
+	py_o = PyObject_GetAttrString(py_name, "ndn_data");
+	JUMP_IF_NULL(py_o, error);
+	name = NDNObject_Get(NAME, py_o);
+	Py_DECREF(py_o);
+
+	ru->name = ndn_charbuf_create();
+	JUMP_IF_NULL_MEM(ru->name, error);
+	r = ndn_charbuf_append_charbuf(ru->name, name);
+	JUMP_IF_NEG_MEM(r, error);
+
+	ru->pending = content_index_create();
+	JUMP_IF_NULL_MEM(ru->pending, error);
+
+	ru->py_source = PyObject_GetIter(py_content);
+	JUMP_IF_NULL(ru->py_source, error);
+
+	Py_INCREF(py_face);
+	ru->py_face = py_face;
+	Py_INCREF(py_on_done);
+	ru->py_on_done = py_on_done;
+
+	py_capsule = NDNObject_New(REPO_UPLOAD, ru);
+	JUMP_IF_NULL(py_capsule, error);
+	ru->capsule = py_capsule;
+
+	/* from now on the capsule owns ru */
+	ru->started = ru->last = _pyndn_monotonic_ms();
+
+	r = repo_upload_fill(ru);
+	JUMP_IF_NEG(r, error_capsule);
+
+	Py_INCREF(py_capsule);
+	r = ndn_set_interest_filter(ru->handle, ru->name, &ru->filter);
+	if (r < 0) {
+		Py_DECREF(py_capsule);
+		goto error_ndn;
+	}
+	ru->filter_set = 1;
+
+	r = repo_upload_start_write(ru);
+	if (r < 0)
+		goto error_ndn;
+
+	if (!ru->py_source && !content_index_count(ru->pending))
+		repo_upload_finish(ru);
+
+	return py_capsule;
+
+error_ndn:
+	r = ndn_geterror(ru->handle);
+	PyErr_Format(PyExc_IOError, "Unable to start the upload: %s [%d]",
+			strerror(r), r);
+	if (ru->filter_set)
+		ndn_set_interest_filter(ru->handle, ru->name, NULL);
+error_capsule:
+	Py_DECREF(py_capsule);
+	return NULL;
+
+error:
+	repo_upload_destroy(&ru);
+	return NULL;
+}
+
+// arguments: upload session
+// returns:   dictionary with the progress of the upload
+
+PyObject *
+_pyndn_cmd_repo_upload_stats(PyObject *UNUSED(self), PyObject *py_repo_upload)
+{
+	struct repo_upload *ru;
+	double elapsed;
+
+	if (!NDNObject_ReqType(REPO_UPLOAD, py_repo_upload))
+		return NULL;
+
+	ru = NDNObject_Get(REPO_UPLOAD, py_repo_upload);
+
+	/* rates are over the time it took to serve what was served */
+	elapsed = (ru->last - ru->started) / 1000.0;
+
+	return Py_BuildValue("{s:k,s:K,s:n,s:n,s:k,s:k,s:d,s:d,s:d,s:O}",
+			"served", ru->served,
+			"bytes", ru->bytes,
+			"pending", (Py_ssize_t) content_index_count(ru->pending),
+			"pending_bytes", (Py_ssize_t) content_index_bytes(ru->pending),
+			"interests", ru->interests,
+			"unmatched", ru->unmatched,
+			"elapsed", elapsed,
+			"segments_per_sec", elapsed > 0 ? ru->served / elapsed : 0.0,
+			"bytes_per_sec", elapsed > 0 ? ru->bytes / elapsed : 0.0,
+			"finished", ru->finished ? Py_True : Py_False);
+}
@@ -0,0 +1,19 @@
+/*
+ * Copyright (c) 2011, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ * Written by: Derek Kulinski <takeda@takeda.tk>
+ *             Jeff Burke <jburke@ucla.edu>
+ */
+
+#ifndef METHODS_REPO_H
+#  define	METHODS_REPO_H
+
+struct repo_upload;
+
+void repo_upload_destroy(struct repo_upload **ru);
+
+PyObject *_pyndn_cmd_repo_upload_start(PyObject *self, PyObject *args);
+PyObject *_pyndn_cmd_repo_upload_stats(PyObject *self,
+		PyObject *py_repo_upload);
+
+#endif	/* METHODS_REPO_H */
@@ -0,0 +1,604 @@
+/*
+ * Copyright (c) 2011, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ * Written by: Derek Kulinski <takeda@takeda.tk>
+ *             Jeff Burke <jburke@ucla.edu>
+ */
+
+#include "python_hdr.h"
+#include <ndn/ndn.h>
+#include <ndn/hashtb.h>
+
+#include <stdlib.h>
+
+#include "pyndn.h"
+#include "util.h"
+#include "methods_contentobject.h"
+#include "methods_exclusionfilter.h"
+#include "methods_interest.h"
+#include "methods_resolver.h"
+#include "objects.h"
+#include "stats.h"
+
+// Latest version discovery
+//
+// The resolver asks for the rightmost child of the prefix, and every answer
+// it gets is excluded together with everything sorting before it, so the
+// next interest can only be satisfied by a newer version. When the interest
+// finally times out the newest Data seen is handed to Python in a single
+// callback. The whole walk happens here, Python is not involved in between.
+//
+// The result is kept in a per-module cache keyed by the prefix. A fresh
+// entry answers the request without touching the network (Face delivers it
+// from the loop, like any other answer), a stale one seeds the exclude
+// filter so only versions newer than it are looked for.
+
+struct version_cache_entry {
+	struct ndn_charbuf *data;     /* Data packet of the latest version */
+	struct ndn_charbuf *version;  /* component following the prefix */
+	enum ndn_upcall_kind kind;
+	long long expires;            /* in _pyndn_monotonic_ms() time */
+};
+
+struct version_resolver {
+	struct ndn_closure closure;
+	struct ndn *handle;
+	struct ndn_charbuf *prefix;
+	struct ndn_charbuf *templ;
+	struct exclusion_filter *exclude;
+	struct ndn_charbuf *best;     /* newest Data seen so far */
+	struct ndn_charbuf *version;
+	enum ndn_upcall_kind best_kind;
+	unsigned long lifetime;       /* in 1/4096 s, 0 for the default */
+	long long ttl;                /* in ms, 0 disables the cache */
+	PyObject *py_face;            /* keeps the handle alive */
+	PyObject *py_name;
+	PyObject *py_on_data;
+	PyObject *py_on_timeout;
+};
+
+static void
+version_cache_finalize(struct hashtb_enumerator *e)
+{
+	struct version_cache_entry *entry = e->data;
+
+	ndn_charbuf_destroy(&entry->data);
+	ndn_charbuf_destroy(&entry->version);
+}
+
+static struct hashtb *
+version_cache(void)
+{
+	struct pyndn_state *state = GETSTATE(_pyndn_module);
+	struct hashtb_param param = {0};
+
+	if (!state->version_cache) {
+		param.finalize = version_cache_finalize;
+		state->version_cache = hashtb_create(
+				sizeof(struct version_cache_entry), &param);
+	}
+
+	return state->version_cache;
+}
+
+static int
+version_cache_store(const struct version_resolver *vr)
+{
+	struct hashtb *cache;
+	struct hashtb_enumerator ee, *e = &ee;
+	struct version_cache_entry *entry;
+	int r;
+
+	cache = version_cache();
+	if (!cache)
+		return -1;
+
+	hashtb_start(cache, e);
+
+	r = hashtb_seek(e, vr->prefix->buf, vr->prefix->length, 0);
+	if (r < 0)
+		goto out;
+
+	entry = e->data;
+	if (r == HT_NEW_ENTRY) {
+		entry->data = ndn_charbuf_create();
+		entry->version = ndn_charbuf_create();
+		if (!entry->data || !entry->version) {
+			hashtb_delete(e);
+			r = -1;
+			goto out;
+		}
+	} else {
+		ndn_charbuf_reset(entry->data);
+		ndn_charbuf_reset(entry->version);
+	}
+
+	if (ndn_charbuf_append_charbuf(entry->data, vr->best) < 0 ||
+			ndn_charbuf_append_charbuf(entry->version, vr->version) < 0) {
+		hashtb_delete(e);
+		r = -1;
+		goto out;
+	}
+
+	entry->kind = vr->best_kind;
+	entry->expires = _pyndn_monotonic_ms() + vr->ttl;
+
+out:
+	hashtb_end(e);
+	return r < 0 ? -1 : 0;
+}
+
+static void
+version_resolver_destroy(struct version_resolver **vrp)
+{
+	struct version_resolver *vr = *vrp;
+
+	if (!vr)
+		return;
+
+	ndn_charbuf_destroy(&vr->prefix);
+	ndn_charbuf_destroy(&vr->templ);
+	exclusion_filter_destroy(&vr->exclude);
+	ndn_charbuf_destroy(&vr->best);
+	ndn_charbuf_destroy(&vr->version);
+
+	Py_XDECREF(vr->py_face);
+	Py_XDECREF(vr->py_name);
+	Py_XDECREF(vr->py_on_data);
+	Py_XDECREF(vr->py_on_timeout);
+
+	free(vr);
+	*vrp = NULL;
+}
+
+static int
+resolver_express(struct version_resolver *vr)
+{
+	const struct ndn_charbuf *exclude;
+	int r;
+
+	exclude = exclusion_filter_encode(vr->exclude);
+	if (!exclude)
+		return -1;
+
+	/* rightmost child */
+	r = _pyndn_interest_probe_template(vr->templ, exclude, 1, vr->lifetime);
+	if (r < 0)
+		return r;
+
+	r = ndn_express_interest(vr->handle, vr->prefix, &vr->closure,
+			vr->templ);
+	if (r >= 0)
+		handle_stats_expressed((struct handle_stats *) vr->closure.intdata);
+
+	return r;
+}
+
+static int
+resolver_set_best(struct version_resolver *vr, enum ndn_upcall_kind kind,
+		const unsigned char *data, size_t data_size,
+		const unsigned char *version, size_t version_size)
+{
+	int r;
+
+	ndn_charbuf_reset(vr->best);
+	ndn_charbuf_reset(vr->version);
+
+	r = ndn_charbuf_append(vr->best, data, data_size);
+	if (r < 0)
+		return r;
+
+	r = ndn_charbuf_append(vr->version, version, version_size);
+	if (r < 0)
+		return r;
+
+	vr->best_kind = kind;
+
+	return 0;
+}
+
+static PyObject *
+interest_obj_from_upcall(struct ndn_upcall_info *info)
+{
+	PyObject *py_interest, *py_o;
+	struct ndn_charbuf *interest;
+	int r;
+
+	py_interest = NDNObject_New_charbuf(INTEREST, &interest);
+	if (!py_interest)
+		return NULL;
+
+	r = ndn_charbuf_append(interest, info->interest_ndnb,
+			info->pi->offset[NDN_PI_E]);
+	if (r < 0) {
+		Py_DECREF(py_interest);
+		return PyErr_NoMemory();
+	}
+
+	py_o = Interest_obj_from_ndn(py_interest);
+	Py_DECREF(py_interest);
+
+	return py_o;
+}
+
+static enum ndn_upcall_res
+resolver_deliver(struct version_resolver *vr, struct ndn_upcall_info *info)
+{
+	PyObject *py_interest = NULL, *py_data = NULL, *py_res;
+
+	/* not being able to cache isn't fatal, the next lookup will just walk */
+	if (vr->ttl > 0)
+		version_cache_store(vr);
+
+	py_interest = interest_obj_from_upcall(info);
+	JUMP_IF_NULL(py_interest, error);
+
+	py_data = Data_obj_from_ndnb(vr->best->buf, vr->best->length);
+	JUMP_IF_NULL(py_data, error);
+
+	py_res = PyObject_CallFunction(vr->py_on_data, "OOOi", vr->py_name,
+			py_interest, py_data, vr->best_kind);
+	JUMP_IF_NULL(py_res, error);
+
+	Py_DECREF(py_res);
+	Py_DECREF(py_data);
+	Py_DECREF(py_interest);
+
+	return NDN_UPCALL_RESULT_OK;
+
+error:
+	Py_XDECREF(py_data);
+	Py_XDECREF(py_interest);
+	PyErr_Print();
+
+	return NDN_UPCALL_RESULT_ERR;
+}
+
+static enum ndn_upcall_res
+resolver_timed_out(struct version_resolver *vr, struct ndn_upcall_info *info)
+{
+	PyObject *py_interest, *py_res;
+	long r;
+
+	if (vr->best->length > 0)
+		return resolver_deliver(vr, info);
+
+	if (vr->py_on_timeout == Py_None)
+		return NDN_UPCALL_RESULT_OK;
+
+	py_interest = interest_obj_from_upcall(info);
+	JUMP_IF_NULL(py_interest, error);
+
+	py_res = PyObject_CallFunction(vr->py_on_timeout, "OO", vr->py_name,
+			py_interest);
+	Py_DECREF(py_interest);
+	JUMP_IF_NULL(py_res, error);
+
+	/* the same way as in Closure.upcall(), only re-expressing matters */
+	r = _pyndn_Int_Check(py_res) ? _pyndn_Int_AsLong(py_res) :
+			NDN_UPCALL_RESULT_OK;
+	Py_DECREF(py_res);
+
+	return r == NDN_UPCALL_RESULT_REEXPRESS ? NDN_UPCALL_RESULT_REEXPRESS :
+			NDN_UPCALL_RESULT_OK;
+
+error:
+	PyErr_Print();
+	return NDN_UPCALL_RESULT_ERR;
+}
+
+static enum ndn_upcall_res
+resolver_content(struct version_resolver *vr, enum ndn_upcall_kind kind,
+		struct ndn_upcall_info *info)
+{
+	const unsigned char *comp = NULL;
+	size_t size = 0;
+	int ncomps, r;
+
+	ncomps = info->content_comps->n - 1;
+
+	/* the prefix itself matched, there are no versions to walk */
+	if (ncomps <= info->pi->prefix_comps) {
+		if (kind == NDN_UPCALL_CONTENT_BAD)
+			return resolver_timed_out(vr, info);
+
+		r = resolver_set_best(vr, kind, info->content_ndnb,
+				info->pco->offset[NDN_PCO_E], comp, size);
+		if (r < 0)
+			return resolver_timed_out(vr, info);
+
+		return resolver_deliver(vr, info);
+	}
+
+	r = ndn_name_comp_get(info->content_ndnb, info->content_comps,
+			info->pi->prefix_comps, &comp, &size);
+	if (r < 0)
+		return resolver_timed_out(vr, info);
+
+	if (kind != NDN_UPCALL_CONTENT_BAD) {
+		r = resolver_set_best(vr, kind, info->content_ndnb,
+				info->pco->offset[NDN_PCO_E], comp, size);
+		if (r < 0)
+			return resolver_timed_out(vr, info);
+
+		r = exclusion_filter_exclude_before(vr->exclude, comp, size);
+	} else
+		/* skip just this one, older versions may still be good */
+		r = exclusion_filter_add(vr->exclude, comp, size);
+	if (r < 0)
+		return resolver_timed_out(vr, info);
+
+	r = resolver_express(vr);
+	if (r < 0)
+		return resolver_timed_out(vr, info);
+
+	return NDN_UPCALL_RESULT_OK;
+}
+
+static enum ndn_upcall_res
+resolver_upcall(struct ndn_closure *selfp, enum ndn_upcall_kind upcall_kind,
+		struct ndn_upcall_info *info)
+{
+	struct version_resolver *vr = selfp->data;
+	enum ndn_upcall_res res = NDN_UPCALL_RESULT_OK;
+	struct handle_stats *stats = (struct handle_stats *) selfp->intdata;
+	PyGILState_STATE gstate;
+	long long entered;
+
+	debug("resolver_upcall dispatched kind %d\n", upcall_kind);
+
+	assert(vr);
+
+	entered = handle_stats_upcall_enter(selfp, upcall_kind, info, &gstate);
+
+	switch (upcall_kind) {
+	case NDN_UPCALL_FINAL:
+		version_resolver_destroy(&vr);
+		break;
+	case NDN_UPCALL_CONTENT:
+	case NDN_UPCALL_CONTENT_UNVERIFIED:
+	case NDN_UPCALL_CONTENT_BAD:
+	case NDN_UPCALL_CONTENT_KEYMISSING:
+	case NDN_UPCALL_CONTENT_RAW:
+		res = resolver_content(vr, upcall_kind, info);
+		break;
+	case NDN_UPCALL_INTEREST_TIMED_OUT:
+		res = resolver_timed_out(vr, info);
+		break;
+	default:
+		break;
+	}
+
+	handle_stats_upcall_leave(stats, entered, upcall_kind, info,
+			"VersionResolver", gstate);
+
+	return res;
+}
+
+/*
+ * The first interest of a walk, <Interest> from the probe template with the
+ * prefix spliced in place of its empty <Name>, the way ndn_express_interest()
+ * puts it together
+ */
+static PyObject *
+probe_interest_obj(const struct ndn_charbuf *prefix, unsigned long lifetime)
+{
+	struct ndn_parsed_interest pi = {0};
+	struct ndn_charbuf *templ, *interest;
+	PyObject *py_interest = NULL, *py_o = NULL;
+	int r;
+
+	templ = ndn_charbuf_create();
+	JUMP_IF_NULL_MEM(templ, out);
+
+	r = _pyndn_interest_probe_template(templ, NULL, 1, lifetime);
+	JUMP_IF_NEG_MEM(r, out);
+
+	r = ndn_parse_interest(templ->buf, templ->length, &pi, NULL);
+	if (r < 0) {
+		PyErr_SetString(g_PyExc_NDNInterestError,
+				"Unable to parse the probe template");
+		goto out;
+	}
+
+	py_interest = NDNObject_New_charbuf(INTEREST, &interest);
+	JUMP_IF_NULL(py_interest, out);
+
+	r = ndn_charbuf_append(interest, templ->buf, pi.offset[NDN_PI_B_Name]);
+	JUMP_IF_NEG_MEM(r, out);
+	r = ndn_charbuf_append_charbuf(interest, prefix);
+	JUMP_IF_NEG_MEM(r, out);
+	r = ndn_charbuf_append(interest, templ->buf + pi.offset[NDN_PI_E_Name],
+			templ->length - pi.offset[NDN_PI_E_Name]);
+	JUMP_IF_NEG_MEM(r, out);
+
+	py_o = Interest_obj_from_ndn(py_interest);
+
+out:
+	Py_XDECREF(py_interest);
+	ndn_charbuf_destroy(&templ);
+	return py_o;
+}
+
+// arguments: Face, Name, onData callable, [onTimeout callable or None,
+//            interest lifetime in seconds, cache TTL in seconds]
+// returns:   (Data, upcall kind, Interest) when a fresh cached version is
+//            known, the Interest being the one the walk would have started
+//            with; otherwise None and onData will be called from ndn_run()
+
+PyObject *
+_pyndn_cmd_express_interest_for_latest(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_face, *py_name, *py_on_data, *py_on_timeout = Py_None;
+	PyObject *py_o;
+	double lifetime = 0.0, ttl = 0.0;
+	struct version_resolver *vr = NULL;
+	struct version_cache_entry *entry = NULL;
+	struct ndn_charbuf *name;
+	struct handle_stats *stats;
+	struct hashtb *cache;
+	struct ndn *handle;
+	int r;
+
+	if (!PyArg_ParseTuple(args, "OOO|Odd", &py_face, &py_name, &py_on_data,
+			&py_on_timeout, &lifetime, &ttl))
+		return NULL;
+
+	if (!PyObject_IsInstance(py_face, g_type_Face)) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a Face as arg 1");
+		return NULL;
+	}
+	if (strcmp(py_name->ob_type->tp_name, "Name")) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a Name as arg 2");
+		return NULL;
+	}
+	if (!PyCallable_Check(py_on_data)) {
+		PyErr_SetString(PyExc_TypeError, "onData must be callable");
+		return NULL;
+	}
+	if (py_on_timeout != Py_None && !PyCallable_Check(py_on_timeout)) {
+		PyErr_SetString(PyExc_TypeError, "onTimeout must be callable or"
+				" None");
+		return NULL;
+	}
+
+	py_o = PyObject_GetAttrString(py_face, "ndn_data");
+	if (!py_o)
+		return NULL;
+	handle = NDNObject_Get(HANDLE, py_o);
+	stats = _pyndn_handle_get_stats(py_o);
+	Py_DECREF(py_o);
+
+	py_o = PyObject_GetAttrString(py_name, "ndn_data");
+	if (!py_o)
+		return NULL;
+	name = NDNObject_Get(NAME, py_o);
+	Py_DECREF(py_o);
+
+	if (ttl > 0) {
+		cache = version_cache();
+		JUMP_IF_NULL_MEM(cache, error);
+
+		entry = hashtb_lookup(cache, name->buf, name->length);
+		if (entry && entry->expires > _pyndn_monotonic_ms()) {
+			PyObject *py_interest;
+
+			py_o = Data_obj_from_ndnb(entry->data->buf,
+					entry->data->length);
+			JUMP_IF_NULL(py_o, error);
+
+			py_interest = probe_interest_obj(name,
+					lifetime > 0 ? lifetime * 4096 : 0);
+			if (!py_interest) {
+				Py_DECREF(py_o);
+				goto error;
+			}
+
+			return Py_BuildValue("(NiN)", py_o, entry->kind,
+					py_interest);
+		}
+	}
+
+	vr = calloc(1, sizeof(*vr));
+	JUMP_IF_NULL_MEM(vr, error);
+
+	vr->closure.p = resolver_upcall;
+	vr->closure.data = vr;
+	vr->closure.intdata = (intptr_t) stats;
+	vr->handle = handle;
+
+	vr->prefix = ndn_charbuf_create();
+	JUMP_IF_NULL_MEM(vr->prefix, error);
+	vr->templ = ndn_charbuf_create();
+	JUMP_IF_NULL_MEM(vr->templ, error);
+	vr->exclude = exclusion_filter_create();
+	JUMP_IF_NULL_MEM(vr->exclude, error);
+	vr->best = ndn_charbuf_create();
+	JUMP_IF_NULL_MEM(vr->best, error);
+	vr->version = ndn_charbuf_create();
+	JUMP_IF_NULL_MEM(vr->version, error);
+
+	r = ndn_charbuf_append_charbuf(vr->prefix, name);
+	JUMP_IF_NEG_MEM(r, error);
+
+	vr->lifetime = lifetime > 0 ? lifetime * 4096 : 0;
+	vr->ttl = ttl > 0 ? ttl * 1000 : 0;
+
+	Py_INCREF(py_face);
+	vr->py_face = py_face;
+	Py_INCREF(py_name);
+	vr->py_name = py_name;
+	Py_INCREF(py_on_data);
+	vr->py_on_data = py_on_data;
+	Py_INCREF(py_on_timeout);
+	vr->py_on_timeout = py_on_timeout;
+
+	/*
+	 * Stale entry: only versions newer than the cached one are looked for,
+	 * if none shows up the cached one is still the latest
+	 */
+	if (entry && entry->version->length > 0) {
+		r = resolver_set_best(vr, entry->kind, entry->data->buf,
+				entry->data->length, entry->version->buf,
+				entry->version->length);
+		JUMP_IF_NEG_MEM(r, error);
+
+		r = exclusion_filter_exclude_before(vr->exclude,
+				entry->version->buf, entry->version->length);
+		JUMP_IF_NEG_MEM(r, error);
+	}
+
+	r = resolver_express(vr);
+	if (r < 0) {
+		int err = ndn_geterror(handle);
+
+		PyErr_Format(PyExc_IOError, "Unable to issue an interest: %s [%d]",
+				strerror(err), err);
+		goto error;
+	}
+
+	/* vr is released on NDN_UPCALL_FINAL */
+
+	Py_RETURN_NONE;
+
+error:
+	version_resolver_destroy(&vr);
+	return NULL;
+}
+
+// arguments: [Name], when omitted the whole cache is dropped
+// returns:   None
+
+PyObject *
+_pyndn_cmd_clear_version_cache(PyObject *UNUSED(self), PyObject *args)
+{
+	struct pyndn_state *state = GETSTATE(_pyndn_module);
+	PyObject *py_name = Py_None, *py_o;
+	struct ndn_charbuf *name;
+
+	if (!PyArg_ParseTuple(args, "|O", &py_name))
+		return NULL;
+
+	if (py_name != Py_None && strcmp(py_name->ob_type->tp_name, "Name")) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a Name or None");
+		return NULL;
+	}
+
+	if (!state->version_cache)
+		Py_RETURN_NONE;
+
+	if (py_name == Py_None) {
+		hashtb_destroy(&state->version_cache);
+		Py_RETURN_NONE;
+	}
+
+	py_o = PyObject_GetAttrString(py_name, "ndn_data");
+	if (!py_o)
+		return NULL;
+	name = NDNObject_Get(NAME, py_o);
+	Py_DECREF(py_o);
+
+	hashtb_delete_key(state->version_cache, name->buf, name->length);
+
+	Py_RETURN_NONE;
+}
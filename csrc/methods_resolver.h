@@ -0,0 +1,15 @@
+/*
+ * Copyright (c) 2011, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ * Written by: Derek Kulinski <takeda@takeda.tk>
+ *             Jeff Burke <jburke@ucla.edu>
+ */
+
+#ifndef METHODS_RESOLVER_H
+#  define	METHODS_RESOLVER_H
+
+PyObject *_pyndn_cmd_express_interest_for_latest(PyObject *self,
+		PyObject *args);
+PyObject *_pyndn_cmd_clear_version_cache(PyObject *self, PyObject *args);
+
+#endif	/* METHODS_RESOLVER_H */
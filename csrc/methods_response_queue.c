@@ -0,0 +1,330 @@
+/*
+ * Copyright (c) 2011, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ * Written by: Derek Kulinski <takeda@takeda.tk>
+ *             Jeff Burke <jburke@ucla.edu>
+ */
+
+#include "python_hdr.h"
+#include <ndn/ndn.h>
+
+#include <stdlib.h>
+
+#include "pyndn.h"
+#include "util.h"
+#include "content_index.h"
+#include "methods_response_queue.h"
+#include "objects.h"
+#include "stats.h"
+
+// Response queue
+//
+// Data published ahead of the interests asking for it, for chat and
+// pub/sub style producers. The queue sets an interest filter on its prefix
+// and answers from ndn_run() without calling into Python: pending Data is
+// kept in a content_index, found with a binary search and given up once
+// it was served or its lifetime is over, whichever comes first.
+
+struct response_queue {
+	struct ndn_closure filter;
+	PyObject *capsule;                /* ourselves, held by the filter */
+	struct ndn *handle;
+	struct handle_stats *stats;
+	struct ndn_charbuf *name;
+	struct content_index *pending;
+	long long lifetime;               /* ms, default for put */
+	PyObject *py_face;                /* keeps the handle alive */
+	int filter_set;
+	int closed;
+
+	unsigned long queued;
+	unsigned long served;
+	unsigned long long bytes;
+	unsigned long expired;
+	unsigned long interests;
+	unsigned long unmatched;
+};
+
+void
+response_queue_destroy(struct response_queue **rqp)
+{
+	struct response_queue *rq = *rqp;
+
+	if (!rq)
+		return;
+
+	ndn_charbuf_destroy(&rq->name);
+	content_index_destroy(&rq->pending);
+
+	Py_XDECREF(rq->py_face);
+
+	free(rq);
+	*rqp = NULL;
+}
+
+static void
+response_queue_expire(struct response_queue *rq)
+{
+	rq->expired += content_index_expire(rq->pending, _pyndn_monotonic_ms());
+}
+
+static enum ndn_upcall_res
+response_queue_serve(struct response_queue *rq, struct ndn_upcall_info *info)
+{
+	const struct ndn_charbuf *co;
+	int i, r;
+
+	rq->interests++;
+
+	response_queue_expire(rq);
+
+	i = content_index_match(rq->pending, info->interest_ndnb,
+			info->pi->offset[NDN_PI_E], info->pi);
+	if (i < 0) {
+		rq->unmatched++;
+		return NDN_UPCALL_RESULT_OK;
+	}
+
+	co = content_index_get(rq->pending, i);
+	r = ndn_put(info->h, co->buf, co->length);
+	if (r < 0) {
+		debug("Unable to put queued Data\n");
+		return NDN_UPCALL_RESULT_OK;
+	}
+	handle_stats_put(rq->stats, co->length);
+
+	rq->served++;
+	rq->bytes += co->length;
+	content_index_remove(rq->pending, i);
+
+	return NDN_UPCALL_RESULT_INTEREST_CONSUMED;
+}
+
+static enum ndn_upcall_res
+response_queue_upcall(struct ndn_closure *selfp,
+		enum ndn_upcall_kind upcall_kind, struct ndn_upcall_info *info)
+{
+	struct response_queue *rq = selfp->data;
+	enum ndn_upcall_res res = NDN_UPCALL_RESULT_OK;
+	struct handle_stats *stats = (struct handle_stats *) selfp->intdata;
+	PyGILState_STATE gstate;
+	long long entered;
+
+	debug("response_queue_upcall dispatched kind %d\n", upcall_kind);
+
+	assert(rq);
+
+	entered = handle_stats_upcall_enter(selfp, upcall_kind, info, &gstate);
+
+	switch (upcall_kind) {
+	case NDN_UPCALL_FINAL:
+		rq->filter_set = 0;
+		Py_DECREF(rq->capsule);
+		break;
+	case NDN_UPCALL_INTEREST:
+		if (!rq->closed)
+			res = response_queue_serve(rq, info);
+		break;
+	default:
+		break;
+	}
+
+	handle_stats_upcall_leave(stats, entered, upcall_kind, info,
+			"ResponseQueue", gstate);
+
+	return res;
+}
+
+// arguments: Face, Name, [lifetime in seconds]
+// returns:   queue answering interests under Name with what is put in it
+
+PyObject *
+_pyndn_cmd_response_queue_create(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_face, *py_name, *py_o, *py_capsule = NULL;
+	struct response_queue *rq = NULL;
+	struct ndn_charbuf *name;
+	double lifetime = 15 * 60;
+	int r;
+
+	if (!PyArg_ParseTuple(args, "OO|d", &py_face, &py_name, &lifetime))
+		return NULL;
+
+	if (!PyObject_IsInstance(py_face, g_type_Face)) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a Face as arg 1");
+		return NULL;
+	}
+	if (strcmp(py_name->ob_type->tp_name, "Name")) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a Name as arg 2");
+		return NULL;
+	}
+	if (lifetime <= 0) {
+		PyErr_SetString(PyExc_ValueError, "Lifetime has to be positive");
+		return NULL;
+	}
+
+	rq = calloc(1, sizeof(*rq));
+	JUMP_IF_NULL_MEM(rq, error);
+
+	rq->filter.p = response_queue_upcall;
+	rq->filter.data = rq;
+	rq->lifetime = (long long) (lifetime * 1000);
+
+	py_o = PyObject_GetAttrString(py_face, "ndn_data");
+	JUMP_IF_NULL(py_o, error);
+	rq->handle = NDNObject_Get(HANDLE, py_o);
+	rq->stats = _pyndn_handle_get_stats(py_o);
+	rq->filter.intdata = (intptr_t) rq->stats;
+	Py_DECREF(py_o);
+
+	py_o = PyObject_GetAttrString(py_name, "ndn_data");
+	JUMP_IF_NULL(py_o, error);
+	name = NDNObject_Get(NAME, py_o);
+	Py_DECREF(py_o);
+
+	rq->name = ndn_charbuf_create();
+	JUMP_IF_NULL_MEM(rq->name, error);
+	r = ndn_charbuf_append_charbuf(rq->name, name);
+	JUMP_IF_NEG_MEM(r, error);
+
+	rq->pending = content_index_create();
+	JUMP_IF_NULL_MEM(rq->pending, error);
+
+	Py_INCREF(py_face);
+	rq->py_face = py_face;
+
+	py_capsule = NDNObject_New(RESPONSE_QUEUE, rq);
+	JUMP_IF_NULL(py_capsule, error);
+	rq->capsule = py_capsule;
+
+	/* from now on the capsule owns rq */
+	Py_INCREF(py_capsule);
+	r = ndn_set_interest_filter(rq->handle, rq->name, &rq->filter);
+	if (r < 0) {
+		Py_DECREF(py_capsule);
+		r = ndn_geterror(rq->handle);
+		PyErr_Format(PyExc_IOError, "Unable to set the interest filter: %s"
+				" [%d]", strerror(r), r);
+		Py_DECREF(py_capsule);
+		return NULL;
+	}
+	rq->filter_set = 1;
+
+	return py_capsule;
+
+error:
+	response_queue_destroy(&rq);
+	return NULL;
+}
+
+// arguments: queue, Data, [lifetime in seconds]
+// returns:   number of Data packets pending
+
+PyObject *
+_pyndn_cmd_response_queue_put(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_queue, *py_data, *py_o;
+	struct response_queue *rq;
+	struct ndn_charbuf *co;
+	double lifetime = -1;
+	long long expires;
+	int r;
+
+	if (!PyArg_ParseTuple(args, "OO|d", &py_queue, &py_data, &lifetime))
+		return NULL;
+
+	if (!NDNObject_ReqType(RESPONSE_QUEUE, py_queue))
+		return NULL;
+
+	rq = NDNObject_Get(RESPONSE_QUEUE, py_queue);
+	if (rq->closed) {
+		PyErr_SetString(PyExc_ValueError, "The queue is closed");
+		return NULL;
+	}
+
+	if (!PyObject_IsInstance(py_data, g_type_Data)) {
+		PyErr_SetString(PyExc_TypeError, "Only Data objects can be queued");
+		return NULL;
+	}
+
+	py_o = PyObject_GetAttrString(py_data, "ndn_data");
+	if (!py_o)
+		return NULL;
+
+	if (!NDNObject_ReqType(CONTENT_OBJECT, py_o)) {
+		Py_DECREF(py_o);
+		return NULL;
+	}
+
+	response_queue_expire(rq);
+
+	expires = _pyndn_monotonic_ms() +
+			(lifetime < 0 ? rq->lifetime : (long long) (lifetime * 1000));
+
+	co = NDNObject_Get(CONTENT_OBJECT, py_o);
+	r = content_index_add_expiring(rq->pending, co->buf, co->length,
+			expires);
+	Py_DECREF(py_o);
+	if (r == -1)
+		return PyErr_NoMemory();
+	else if (r < 0) {
+		PyErr_SetString(g_PyExc_NDNDataError, "Unable to parse Data packet");
+		return NULL;
+	}
+	rq->queued++;
+
+	return _pyndn_Int_FromLong((long) content_index_count(rq->pending));
+}
+
+// arguments: queue
+// returns:   None, the filter is removed and pending Data dropped
+
+PyObject *
+_pyndn_cmd_response_queue_close(PyObject *UNUSED(self), PyObject *py_queue)
+{
+	struct response_queue *rq;
+
+	if (!NDNObject_ReqType(RESPONSE_QUEUE, py_queue))
+		return NULL;
+
+	rq = NDNObject_Get(RESPONSE_QUEUE, py_queue);
+	if (rq->closed)
+		Py_RETURN_NONE;
+	rq->closed = 1;
+
+	while (content_index_count(rq->pending))
+		content_index_remove(rq->pending, content_index_count(rq->pending) - 1);
+
+	/* NDN_UPCALL_FINAL on the filter releases its reference */
+	if (rq->filter_set)
+		ndn_set_interest_filter(rq->handle, rq->name, NULL);
+
+	Py_RETURN_NONE;
+}
+
+// arguments: queue
+// returns:   dictionary with the queue depth and what was served
+
+PyObject *
+_pyndn_cmd_response_queue_stats(PyObject *UNUSED(self), PyObject *py_queue)
+{
+	struct response_queue *rq;
+
+	if (!NDNObject_ReqType(RESPONSE_QUEUE, py_queue))
+		return NULL;
+
+	rq = NDNObject_Get(RESPONSE_QUEUE, py_queue);
+
+	response_queue_expire(rq);
+
+	return Py_BuildValue("{s:n,s:n,s:k,s:k,s:K,s:k,s:k,s:k,s:O}",
+			"pending", (Py_ssize_t) content_index_count(rq->pending),
+			"pending_bytes", (Py_ssize_t) content_index_bytes(rq->pending),
+			"queued", rq->queued,
+			"served", rq->served,
+			"bytes", rq->bytes,
+			"expired", rq->expired,
+			"interests", rq->interests,
+			"unmatched", rq->unmatched,
+			"closed", rq->closed ? Py_True : Py_False);
+}
@@ -0,0 +1,22 @@
+/*
+ * Copyright (c) 2011, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ * Written by: Derek Kulinski <takeda@takeda.tk>
+ *             Jeff Burke <jburke@ucla.edu>
+ */
+
+#ifndef METHODS_RESPONSE_QUEUE_H
+#  define	METHODS_RESPONSE_QUEUE_H
+
+struct response_queue;
+
+void response_queue_destroy(struct response_queue **rq);
+
+PyObject *_pyndn_cmd_response_queue_create(PyObject *self, PyObject *args);
+PyObject *_pyndn_cmd_response_queue_put(PyObject *self, PyObject *args);
+PyObject *_pyndn_cmd_response_queue_close(PyObject *self,
+		PyObject *py_queue);
+PyObject *_pyndn_cmd_response_queue_stats(PyObject *self,
+		PyObject *py_queue);
+
+#endif	/* METHODS_RESPONSE_QUEUE_H */
@@ -11,6 +11,7 @@
 #include "pyndn.h"
 #include "methods_signature.h"
 #include "objects.h"
+#include "sign_symmetric.h"
 #include "util.h"
 
 /* only used by assertions code */
@@ -40,8 +41,7 @@ append_digest_algorithm(struct ndn_charbuf *signature,
 		assert((Py_ssize_t) strlen(str) == str_len);
 		JUMP_IF_NULL(py_o, error);
 
-		r = ndnb_append_tagged_blob(signature, NDN_DTAG_DigestAlgorithm,
-				str, str_len);
+		r = sign_symmetric_append_digest_alg(signature, str, str_len);
 		Py_DECREF(py_o);
 		JUMP_IF_NEG_MEM(r, error);
 	}
@@ -199,14 +199,14 @@ Signature_obj_from_ndn(PyObject *py_signature)
 
 	/* NDN_DTAG_DigestAlgorithm */
 	start = d->decoder.token_index;
-	ndn_parse_optional_tagged_BLOB(d, NDN_DTAG_DigestAlgorithm, 1, -1);
+	ndn_parse_optional_tagged_UDATA(d, NDN_DTAG_DigestAlgorithm);
 	stop = d->decoder.token_index;
 
-	r = ndn_ref_tagged_BLOB(NDN_DTAG_DigestAlgorithm, d->buf, start, stop,
+	r = ndn_ref_tagged_string(NDN_DTAG_DigestAlgorithm, d->buf, start, stop,
 			&ptr, &size);
 	if (r == 0) {
 		debug("PyObject_SetAttrString digestAlgorithm\n");
-		py_o = PyBytes_FromStringAndSize((const char*) ptr, size);
+		py_o = PyUnicode_FromStringAndSize((const char*) ptr, size);
 		JUMP_IF_NULL(py_o, error);
 		r = PyObject_SetAttrString(py_obj_signature, "digestAlgorithm", py_o);
 		Py_DECREF(py_o);
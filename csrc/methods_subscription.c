@@ -0,0 +1,410 @@
+/*
+ * Copyright (c) 2011, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ * Written by: Derek Kulinski <takeda@takeda.tk>
+ *             Jeff Burke <jburke@ucla.edu>
+ */
+
+#include "python_hdr.h"
+#include <ndn/ndn.h>
+
+#include <stdlib.h>
+
+#include "pyndn.h"
+#include "util.h"
+#include "methods_contentobject.h"
+#include "methods_exclusionfilter.h"
+#include "methods_interest.h"
+#include "methods_subscription.h"
+#include "objects.h"
+#include "stats.h"
+
+// Versioned pull subscription
+//
+// A stream publishes versions under a prefix and the subscriber keeps
+// in_flight interests for "a version after the newest one seen" out at all
+// times. Every interest that comes back, with Data or timed out, is
+// expressed again right away with the exclude filter's lower bound moved
+// to the newest version, so there is no fetch-then-request gap and Python
+// is only called with new versions. Identical interests are likely folded
+// into one by the forwarder until their lower bounds differ; the extra
+// ones still cover the time one of them is being re-expressed.
+//
+// The first interests ask for the rightmost child, so the subscription
+// starts at the newest version unless a version to start after is given.
+// After that every version is delivered in order, or only the newest one
+// when latest is set.
+
+struct subscription {
+	struct ndn_closure closure;       /* shared by all the interests */
+	PyObject *capsule;                /* ourselves, held by the closure */
+	struct ndn *handle;
+	struct handle_stats *stats;
+	struct ndn_charbuf *prefix;
+	struct ndn_charbuf *templ;
+	struct exclusion_filter *exclude;
+	struct ndn_charbuf *version;      /* newest one delivered */
+	unsigned long lifetime;           /* in 1/4096 s, 0 for the default */
+	int in_flight, max_in_flight;
+	int latest;
+	int templ_valid;
+	int closed;
+	PyObject *py_face;                /* keeps the handle alive */
+	PyObject *py_name;
+	PyObject *py_on_data;
+
+	unsigned long delivered;
+	unsigned long duplicates;
+	unsigned long timeouts;
+	unsigned long expressed;
+};
+
+void
+subscription_destroy(struct subscription **subp)
+{
+	struct subscription *sub = *subp;
+
+	if (!sub)
+		return;
+
+	ndn_charbuf_destroy(&sub->prefix);
+	ndn_charbuf_destroy(&sub->templ);
+	exclusion_filter_destroy(&sub->exclude);
+	ndn_charbuf_destroy(&sub->version);
+
+	Py_XDECREF(sub->py_face);
+	Py_XDECREF(sub->py_name);
+	Py_XDECREF(sub->py_on_data);
+
+	free(sub);
+	*subp = NULL;
+}
+
+static int
+subscription_express(struct subscription *sub)
+{
+	const struct ndn_charbuf *exclude;
+	int child, r;
+
+	if (!sub->templ_valid) {
+		exclude = exclusion_filter_encode(sub->exclude);
+		if (!exclude)
+			return -1;
+
+		child = sub->latest || !sub->version->length ? 1 : 0;
+		r = _pyndn_interest_probe_template(sub->templ,
+				exclusion_filter_count(sub->exclude) ? exclude : NULL, child,
+				sub->lifetime);
+		if (r < 0)
+			return r;
+
+		sub->templ_valid = 1;
+	}
+
+	r = ndn_express_interest(sub->handle, sub->prefix, &sub->closure,
+			sub->templ);
+	if (r < 0)
+		return r;
+
+	sub->in_flight++;
+	sub->expressed++;
+	handle_stats_expressed(sub->stats);
+
+	return 0;
+}
+
+static void
+subscription_fill(struct subscription *sub)
+{
+	while (!sub->closed && sub->in_flight < sub->max_in_flight)
+		if (subscription_express(sub) < 0) {
+			debug("Unable to express subscription interest\n");
+			break;
+		}
+}
+
+static int
+subscription_deliver(struct subscription *sub, enum ndn_upcall_kind kind,
+		struct ndn_upcall_info *info)
+{
+	PyObject *py_data, *py_res;
+
+	py_data = Data_obj_from_ndnb(info->content_ndnb,
+			info->pco->offset[NDN_PCO_E]);
+	if (!py_data)
+		return -1;
+
+	py_res = PyObject_CallFunction(sub->py_on_data, "OOi", sub->py_name,
+			py_data, kind);
+	Py_DECREF(py_data);
+	if (!py_res)
+		return -1;
+
+	Py_DECREF(py_res);
+	sub->delivered++;
+
+	return 0;
+}
+
+static void
+subscription_content(struct subscription *sub, enum ndn_upcall_kind kind,
+		struct ndn_upcall_info *info)
+{
+	const unsigned char *comp;
+	size_t size;
+	int r;
+
+	r = ndn_name_comp_get(info->content_ndnb, info->content_comps,
+			info->pi->prefix_comps, &comp, &size);
+	if (r < 0 || (int) info->content_comps->n - 1 <= info->pi->prefix_comps) {
+		/* no version component, nothing to move the bound to */
+		sub->duplicates++;
+		return;
+	}
+
+	/* another interest brought it already */
+	if (exclusion_filter_matches(sub->exclude, comp, size)) {
+		sub->duplicates++;
+		return;
+	}
+
+	if (kind == NDN_UPCALL_CONTENT_BAD) {
+		/* skip just this one, the next version may be good */
+		r = exclusion_filter_add(sub->exclude, comp, size);
+		sub->templ_valid = 0;
+		if (r < 0) {
+			PyErr_NoMemory();
+			PyErr_Print();
+		}
+		return;
+	}
+
+	ndn_charbuf_reset(sub->version);
+	r = exclusion_filter_exclude_before(sub->exclude, comp, size);
+	if (r >= 0)
+		r = ndn_charbuf_append(sub->version, comp, size);
+	sub->templ_valid = 0;
+	if (r < 0) {
+		PyErr_NoMemory();
+		PyErr_Print();
+		return;
+	}
+
+	if (subscription_deliver(sub, kind, info) < 0)
+		PyErr_Print();
+}
+
+static enum ndn_upcall_res
+subscription_upcall(struct ndn_closure *selfp,
+		enum ndn_upcall_kind upcall_kind, struct ndn_upcall_info *info)
+{
+	struct subscription *sub = selfp->data;
+	struct handle_stats *stats = (struct handle_stats *) selfp->intdata;
+	PyGILState_STATE gstate;
+	long long entered;
+
+	debug("subscription_upcall dispatched kind %d\n", upcall_kind);
+
+	assert(sub);
+
+	entered = handle_stats_upcall_enter(selfp, upcall_kind, info, &gstate);
+
+	switch (upcall_kind) {
+	case NDN_UPCALL_FINAL:
+		/* the last interest is gone, see _pyndn_cmd_subscribe() */
+		Py_DECREF(sub->capsule);
+		break;
+	case NDN_UPCALL_CONTENT:
+	case NDN_UPCALL_CONTENT_UNVERIFIED:
+	case NDN_UPCALL_CONTENT_BAD:
+	case NDN_UPCALL_CONTENT_KEYMISSING:
+	case NDN_UPCALL_CONTENT_RAW:
+		sub->in_flight--;
+		if (!sub->closed)
+			subscription_content(sub, upcall_kind, info);
+		subscription_fill(sub);
+		break;
+	case NDN_UPCALL_INTEREST_TIMED_OUT:
+		sub->in_flight--;
+		sub->timeouts++;
+		subscription_fill(sub);
+		break;
+	default:
+		break;
+	}
+
+	handle_stats_upcall_leave(stats, entered, upcall_kind, info,
+			"Subscription", gstate);
+
+	return NDN_UPCALL_RESULT_OK;
+}
+
+// arguments: Face, Name, onData callable, [in flight, latest only,
+//            interest lifetime in seconds, version component to start after]
+// returns:   subscription, onData(name, data, kind) is called from ndn_run()
+//            with every new version
+
+PyObject *
+_pyndn_cmd_subscribe(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_face, *py_name, *py_on_data, *py_after = Py_None;
+	PyObject *py_o, *py_capsule;
+	struct subscription *sub = NULL;
+	struct ndn_charbuf *name;
+	const char *after;
+	Py_ssize_t after_size;
+	int in_flight = 1, latest = 0, r;
+	double lifetime = 0.0;
+
+	if (!PyArg_ParseTuple(args, "OOO|iidO", &py_face, &py_name, &py_on_data,
+			&in_flight, &latest, &lifetime, &py_after))
+		return NULL;
+
+	if (!PyObject_IsInstance(py_face, g_type_Face)) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a Face as arg 1");
+		return NULL;
+	}
+	if (strcmp(py_name->ob_type->tp_name, "Name")) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a Name as arg 2");
+		return NULL;
+	}
+	if (!PyCallable_Check(py_on_data)) {
+		PyErr_SetString(PyExc_TypeError, "onData must be callable");
+		return NULL;
+	}
+	if (in_flight < 1) {
+		PyErr_SetString(PyExc_ValueError, "At least one interest has to be"
+				" in flight");
+		return NULL;
+	}
+
+	sub = calloc(1, sizeof(*sub));
+	JUMP_IF_NULL_MEM(sub, error);
+
+	sub->closure.p = subscription_upcall;
+	sub->closure.data = sub;
+	sub->max_in_flight = in_flight;
+	sub->latest = latest;
+	sub->lifetime = lifetime > 0 ? lifetime * 4096 : 0;
+
+	py_o = PyObject_GetAttrString(py_face, "ndn_data");
+	JUMP_IF_NULL(py_o, error);
+	sub->handle = NDNObject_Get(HANDLE, py_o);
+	sub->stats = _pyndn_handle_get_stats(py_o);
+	sub->closure.intdata = (intptr_t) sub->stats;
+	Py_DECREF(py_o);
+
+	py_o = PyObject_GetAttrString(py_name, "ndn_data");
+	JUMP_IF_NULL(py_o, error);
+	name = NDNObject_Get(NAME, py_o);
+	Py_DECREF(py_o);
+
+	sub->prefix = ndn_charbuf_create();
+	JUMP_IF_NULL_MEM(sub->prefix, error);
+	sub->templ = ndn_charbuf_create();
+	JUMP_IF_NULL_MEM(sub->templ, error);
+	sub->exclude = exclusion_filter_create();
+	JUMP_IF_NULL_MEM(sub->exclude, error);
+	sub->version = ndn_charbuf_create();
+	JUMP_IF_NULL_MEM(sub->version, error);
+
+	r = ndn_charbuf_append_charbuf(sub->prefix, name);
+	JUMP_IF_NEG_MEM(r, error);
+
+	if (py_after != Py_None) {
+		r = PyBytes_AsStringAndSize(py_after, (char **) &after, &after_size);
+		JUMP_IF_NEG(r, error);
+
+		r = exclusion_filter_exclude_before(sub->exclude,
+				(const unsigned char *) after, after_size);
+		JUMP_IF_NEG_MEM(r, error);
+		r = ndn_charbuf_append(sub->version, after, after_size);
+		JUMP_IF_NEG_MEM(r, error);
+	}
+
+	Py_INCREF(py_face);
+	sub->py_face = py_face;
+	Py_INCREF(py_name);
+	sub->py_name = py_name;
+	Py_INCREF(py_on_data);
+	sub->py_on_data = py_on_data;
+
+	py_capsule = NDNObject_New(SUBSCRIPTION, sub);
+	JUMP_IF_NULL(py_capsule, error);
+	sub->capsule = py_capsule;
+
+	/*
+	 * From now on the capsule owns sub. The closure holds one reference
+	 * for as long as the library knows it, NDN_UPCALL_FINAL releases it
+	 * after the last interest is done
+	 */
+	Py_INCREF(py_capsule);
+	r = subscription_express(sub);
+	if (r < 0) {
+		/* never expressed, so there won't be a FINAL */
+		Py_DECREF(py_capsule);
+		r = ndn_geterror(sub->handle);
+		PyErr_Format(PyExc_IOError, "Unable to issue an interest: %s [%d]",
+				strerror(r), r);
+		Py_DECREF(py_capsule);
+		return NULL;
+	}
+	subscription_fill(sub);
+
+	return py_capsule;
+
+error:
+	subscription_destroy(&sub);
+	return NULL;
+}
+
+// arguments: subscription
+// returns:   None, interests out are not expressed again
+
+PyObject *
+_pyndn_cmd_subscription_close(PyObject *UNUSED(self), PyObject *py_sub)
+{
+	struct subscription *sub;
+
+	if (!NDNObject_ReqType(SUBSCRIPTION, py_sub))
+		return NULL;
+
+	sub = NDNObject_Get(SUBSCRIPTION, py_sub);
+	sub->closed = 1;
+
+	Py_RETURN_NONE;
+}
+
+// arguments: subscription
+// returns:   dictionary with the newest version and interest counts
+
+PyObject *
+_pyndn_cmd_subscription_stats(PyObject *UNUSED(self), PyObject *py_sub)
+{
+	struct subscription *sub;
+	PyObject *py_version;
+
+	if (!NDNObject_ReqType(SUBSCRIPTION, py_sub))
+		return NULL;
+
+	sub = NDNObject_Get(SUBSCRIPTION, py_sub);
+
+	if (sub->version->length)
+		py_version = PyBytes_FromStringAndSize((const char *)
+				sub->version->buf, sub->version->length);
+	else {
+		Py_INCREF(Py_None);
+		py_version = Py_None;
+	}
+	if (!py_version)
+		return NULL;
+
+	return Py_BuildValue("{s:N,s:i,s:k,s:k,s:k,s:k,s:O}",
+			"version", py_version,
+			"in_flight", sub->in_flight,
+			"delivered", sub->delivered,
+			"duplicates", sub->duplicates,
+			"timeouts", sub->timeouts,
+			"expressed", sub->expressed,
+			"closed", sub->closed ? Py_True : Py_False);
+}
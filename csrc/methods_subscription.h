@@ -0,0 +1,19 @@
+/*
+ * Copyright (c) 2011, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ * Written by: Derek Kulinski <takeda@takeda.tk>
+ *             Jeff Burke <jburke@ucla.edu>
+ */
+
+#ifndef METHODS_SUBSCRIPTION_H
+#  define	METHODS_SUBSCRIPTION_H
+
+struct subscription;
+
+void subscription_destroy(struct subscription **sub);
+
+PyObject *_pyndn_cmd_subscribe(PyObject *self, PyObject *args);
+PyObject *_pyndn_cmd_subscription_close(PyObject *self, PyObject *py_sub);
+PyObject *_pyndn_cmd_subscription_stats(PyObject *self, PyObject *py_sub);
+
+#endif	/* METHODS_SUBSCRIPTION_H */
@@ -0,0 +1,421 @@
+/*
+ * Copyright (c) 2011, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ * Written by: Derek Kulinski <takeda@takeda.tk>
+ *             Jeff Burke <jburke@ucla.edu>
+ */
+
+#include "python_hdr.h"
+#include <ndn/ndn.h>
+#include <ndn/schedule.h>
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include "pyndn.h"
+#include "util.h"
+#include "methods_timer.h"
+#include "objects.h"
+#include "stats.h"
+#include "timer_wheel.h"
+
+// Timers
+//
+// Python callables run after a delay, or every period, from the thread
+// running the handle. Each handle has a timer wheel, driven by a single
+// event on the library's schedule: ndn_run() runs it between reads, and
+// so does process_scheduled_operations(), whose wait accounts for the
+// next timer. No extra thread wakes up to poll.
+
+#define TIMERS_MAX_WAIT_US (1 << 30)  /* fits the schedule's int */
+
+struct handle_timers {
+	struct ndn *handle;
+	struct ndn_schedule *sched;
+	int own_sched;                    /* created here, not by the library */
+	struct timer_wheel *wheel;
+	struct ndn_scheduled_event *ev;   /* runs the wheel, NULL if idle */
+	long long ev_at;                  /* when ev is due, in ms */
+	int running;
+};
+
+struct pyndn_timer {
+	struct timer_entry entry;         /* has to be first */
+	struct handle_timers *timers;     /* NULL once the handle is gone */
+	PyObject *capsule;                /* ourselves, held while pending */
+	PyObject *py_callable;
+	PyObject *py_args;
+	long long period;                 /* in ms, 0 for a single call */
+	int firing;
+	int cancelled;
+	unsigned long fired;
+};
+
+static void
+timers_gettime(const struct ndn_gettime *UNUSED(self),
+		struct ndn_timeval *result)
+{
+	long long now = _pyndn_monotonic_us();
+
+	result->s = now / 1000000;
+	result->micros = now % 1000000;
+}
+
+static const struct ndn_gettime timers_clock = {"pyndn", timers_gettime,
+		1000000, NULL};
+
+static int
+timers_event(struct ndn_schedule *UNUSED(sched), void *UNUSED(clienth),
+		struct ndn_scheduled_event *ev, int flags)
+{
+	struct handle_timers *timers = ev->evdata;
+	PyGILState_STATE gstate;
+	long long next, wait;
+
+	if (flags & NDN_SCHEDULE_CANCEL)
+		return 0;
+
+	/* we might be inside ndn_run() with the GIL released */
+	gstate = PyGILState_Ensure();
+
+	timers->running = 1;
+	timer_wheel_run(timers->wheel, _pyndn_monotonic_ms());
+	timers->running = 0;
+
+	next = timer_wheel_next(timers->wheel);
+	if (next < 0) {
+		timers->ev = NULL;
+		wait = 0;
+	} else {
+		timers->ev_at = next;
+		wait = (next - _pyndn_monotonic_ms()) * 1000;
+		if (wait <= 0)
+			wait = 1;
+		else if (wait > TIMERS_MAX_WAIT_US)
+			wait = TIMERS_MAX_WAIT_US;
+	}
+
+	PyGILState_Release(gstate);
+
+	return (int) wait;
+}
+
+static struct handle_timers *
+handle_timers_get(PyObject *py_handle)
+{
+	struct handle_stats *stats = _pyndn_handle_get_stats(py_handle);
+	struct handle_timers *timers;
+
+	if (stats->timers)
+		return stats->timers;
+
+	timers = calloc(1, sizeof(*timers));
+	JUMP_IF_NULL_MEM(timers, error);
+
+	timers->handle = NDNObject_Get(HANDLE, py_handle);
+
+	timers->wheel = timer_wheel_create(_pyndn_monotonic_ms());
+	JUMP_IF_NULL_MEM(timers->wheel, error);
+
+	timers->sched = ndn_get_schedule(timers->handle);
+	if (!timers->sched) {
+		timers->sched = ndn_schedule_create(timers->handle, &timers_clock);
+		JUMP_IF_NULL_MEM(timers->sched, error);
+
+		ndn_set_schedule(timers->handle, timers->sched);
+		timers->own_sched = 1;
+	}
+
+	stats->timers = timers;
+
+	return timers;
+
+error:
+	if (timers)
+		timer_wheel_destroy(&timers->wheel);
+	free(timers);
+	return NULL;
+}
+
+void
+handle_timers_destroy(struct handle_timers **timersp)
+{
+	struct handle_timers *timers = *timersp;
+
+	if (!timers)
+		return;
+
+	if (timers->own_sched) {
+		ndn_set_schedule(timers->handle, NULL);
+		ndn_schedule_destroy(&timers->sched);
+	} else if (timers->ev)
+		ndn_schedule_cancel(timers->sched, timers->ev);
+
+	/* calls back every pending timer, see timer_fire() */
+	timer_wheel_destroy(&timers->wheel);
+
+	free(timers);
+	*timersp = NULL;
+}
+
+/* makes sure the schedule runs the wheel by expires */
+static int
+handle_timers_arm(struct handle_timers *timers, long long expires)
+{
+	long long wait;
+
+	/* timers_event() works out the next run itself */
+	if (timers->running)
+		return 0;
+
+	if (timers->ev && timers->ev_at <= expires)
+		return 0;
+
+	if (timers->ev) {
+		ndn_schedule_cancel(timers->sched, timers->ev);
+		timers->ev = NULL;
+	}
+
+	wait = (expires - _pyndn_monotonic_ms()) * 1000;
+	if (wait <= 0)
+		wait = 1;
+	else if (wait > TIMERS_MAX_WAIT_US)
+		wait = TIMERS_MAX_WAIT_US;
+
+	timers->ev = ndn_schedule_event(timers->sched, (int) wait, timers_event,
+			timers, 0);
+	if (!timers->ev)
+		return -1;
+	timers->ev_at = expires;
+
+	return 0;
+}
+
+static void
+timer_fire(struct timer_entry *e, int cancelled)
+{
+	struct pyndn_timer *timer = (struct pyndn_timer *) e;
+	PyObject *py_res;
+	long long now, missed;
+	int again;
+
+	if (cancelled) {
+		timer->timers = NULL;
+		Py_DECREF(timer->capsule);
+		return;
+	}
+
+	timer->firing = 1;
+	py_res = PyObject_CallObject(timer->py_callable, timer->py_args);
+	timer->firing = 0;
+	timer->fired++;
+
+	if (!py_res)
+		PyErr_Print();
+
+	/* a periodic timer stops when cancelled or returning False */
+	again = timer->period && timer->timers && !timer->cancelled &&
+			py_res != Py_False;
+	Py_XDECREF(py_res);
+
+	if (!again) {
+		Py_DECREF(timer->capsule);
+		return;
+	}
+
+	/* stays on the original grid, skipping the periods already missed */
+	now = _pyndn_monotonic_ms();
+	missed = now > e->expires ? (now - e->expires) / timer->period : 0;
+	timer_wheel_add(timer->timers->wheel, e,
+			e->expires + (missed + 1) * timer->period);
+}
+
+void
+pyndn_timer_destroy(struct pyndn_timer **timerp)
+{
+	struct pyndn_timer *timer = *timerp;
+
+	if (!timer)
+		return;
+
+	/* the wheel holds the capsule while the timer is pending */
+	assert(!timer->entry.wheel);
+
+	Py_XDECREF(timer->py_callable);
+	Py_XDECREF(timer->py_args);
+
+	free(timer);
+	*timerp = NULL;
+}
+
+static PyObject *
+timer_start(PyObject *py_face, double delay, double period,
+		PyObject *py_callable, PyObject *py_args)
+{
+	struct handle_timers *timers;
+	struct pyndn_timer *timer = NULL;
+	PyObject *py_handle, *py_capsule;
+	long long expires;
+	int r;
+
+	if (!PyObject_IsInstance(py_face, g_type_Face)) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a Face as arg 1");
+		return NULL;
+	}
+	if (!PyCallable_Check(py_callable)) {
+		PyErr_SetString(PyExc_TypeError, "Callback must be callable");
+		return NULL;
+	}
+
+	py_handle = PyObject_GetAttrString(py_face, "ndn_data");
+	if (!py_handle)
+		return NULL;
+	if (!NDNObject_ReqType(HANDLE, py_handle)) {
+		Py_DECREF(py_handle);
+		return NULL;
+	}
+	timers = handle_timers_get(py_handle);
+	Py_DECREF(py_handle);
+	if (!timers)
+		return NULL;
+
+	timer = calloc(1, sizeof(*timer));
+	JUMP_IF_NULL_MEM(timer, error);
+
+	timer->entry.action = timer_fire;
+	timer->timers = timers;
+	timer->period = (long long) (period * 1000);
+
+	Py_INCREF(py_callable);
+	timer->py_callable = py_callable;
+	if (py_args)
+		Py_INCREF(py_args);
+	else {
+		py_args = PyTuple_New(0);
+		JUMP_IF_NULL(py_args, error);
+	}
+	timer->py_args = py_args;
+
+	py_capsule = NDNObject_New(TIMER, timer);
+	JUMP_IF_NULL(py_capsule, error);
+	timer->capsule = py_capsule;
+
+	/* a wheel left idle counts its ticks from now */
+	if (!timer_wheel_count(timers->wheel))
+		timer_wheel_run(timers->wheel, _pyndn_monotonic_ms());
+
+	expires = _pyndn_monotonic_ms() + (long long) (delay * 1000);
+
+	r = handle_timers_arm(timers, expires);
+	if (r < 0) {
+		Py_DECREF(py_capsule);
+		return PyErr_NoMemory();
+	}
+
+	/* from now on the capsule owns timer, the wheel holds a reference */
+	Py_INCREF(py_capsule);
+	timer_wheel_add(timers->wheel, &timer->entry, expires);
+
+	return py_capsule;
+
+error:
+	pyndn_timer_destroy(&timer);
+	return NULL;
+}
+
+// arguments: Face, delay in seconds, callable, [arguments tuple]
+// returns:   timer, callable(*arguments) is called once from the handle's
+//            loop after the delay
+
+PyObject *
+_pyndn_cmd_call_later(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_face, *py_callable, *py_args = NULL;
+	double delay;
+
+	if (!PyArg_ParseTuple(args, "OdO|O!", &py_face, &delay, &py_callable,
+			&PyTuple_Type, &py_args))
+		return NULL;
+
+	if (delay < 0)
+		delay = 0;
+
+	return timer_start(py_face, delay, 0, py_callable, py_args);
+}
+
+// arguments: Face, period in seconds, callable, [arguments tuple]
+// returns:   timer, callable(*arguments) is called every period until it
+//            returns False or the timer is cancelled
+
+PyObject *
+_pyndn_cmd_call_every(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_face, *py_callable, *py_args = NULL;
+	double period;
+
+	if (!PyArg_ParseTuple(args, "OdO|O!", &py_face, &period, &py_callable,
+			&PyTuple_Type, &py_args))
+		return NULL;
+
+	if (period < 0.001) {
+		PyErr_SetString(PyExc_ValueError, "Period has to be at least 1 ms");
+		return NULL;
+	}
+
+	return timer_start(py_face, period, period, py_callable, py_args);
+}
+
+// arguments: timer
+// returns:   None, the callable is not called again
+
+PyObject *
+_pyndn_cmd_timer_cancel(PyObject *UNUSED(self), PyObject *py_timer)
+{
+	struct pyndn_timer *timer;
+
+	if (!NDNObject_ReqType(TIMER, py_timer))
+		return NULL;
+
+	timer = NDNObject_Get(TIMER, py_timer);
+
+	if (timer->entry.wheel) {
+		timer_wheel_remove(&timer->entry);
+		Py_DECREF(timer->capsule);
+	} else if (timer->firing)
+		timer->cancelled = 1;
+
+	Py_RETURN_NONE;
+}
+
+// arguments: timer
+// returns:   dictionary telling if the timer is pending, when it is due
+//            and how many times it was called
+
+PyObject *
+_pyndn_cmd_timer_info(PyObject *UNUSED(self), PyObject *py_timer)
+{
+	struct pyndn_timer *timer;
+	PyObject *py_remaining;
+	long long remaining;
+
+	if (!NDNObject_ReqType(TIMER, py_timer))
+		return NULL;
+
+	timer = NDNObject_Get(TIMER, py_timer);
+
+	if (timer->entry.wheel) {
+		remaining = timer->entry.expires - _pyndn_monotonic_ms();
+		py_remaining = PyFloat_FromDouble(remaining > 0 ? remaining / 1e3 : 0);
+	} else {
+		Py_INCREF(Py_None);
+		py_remaining = Py_None;
+	}
+	if (!py_remaining)
+		return NULL;
+
+	return Py_BuildValue("{s:O,s:N,s:d,s:k}",
+			"pending", timer->entry.wheel ? Py_True : Py_False,
+			"remaining", py_remaining,
+			"period", timer->period / 1e3,
+			"fired", timer->fired);
+}
@@ -0,0 +1,22 @@
+/*
+ * Copyright (c) 2011, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ * Written by: Derek Kulinski <takeda@takeda.tk>
+ *             Jeff Burke <jburke@ucla.edu>
+ */
+
+#ifndef METHODS_TIMER_H
+#  define	METHODS_TIMER_H
+
+struct handle_timers;
+struct pyndn_timer;
+
+void handle_timers_destroy(struct handle_timers **timers);
+void pyndn_timer_destroy(struct pyndn_timer **timer);
+
+PyObject *_pyndn_cmd_call_later(PyObject *self, PyObject *args);
+PyObject *_pyndn_cmd_call_every(PyObject *self, PyObject *args);
+PyObject *_pyndn_cmd_timer_cancel(PyObject *self, PyObject *py_timer);
+PyObject *_pyndn_cmd_timer_info(PyObject *self, PyObject *py_timer);
+
+#endif	/* METHODS_TIMER_H */
@@ -151,27 +151,75 @@ state_init(state * st)
 }
 
 /*
- * Updates the current state to reflect the new state
- * after a new authenticator is generated
+ * Time for a new state. It is the wall clock, which is what the verifier
+ * compares it with, held at the last timestamp st was updated with when
+ * the clock is set back
  */
 static void
-update_state(state * st)
+state_time(state * st, struct timeval * tv)
 {
-	if (st) {
-		struct timeval tmp;
-		gettimeofday(&tmp, NULL);
-		st->tv_sec = tmp.tv_sec;
-		st->tv_usec = tmp.tv_usec;
-		st->seq++;
+	u_int32_t sec, usec;
+
+	gettimeofday(tv, NULL);
+
+	sec = __atomic_load_n(&st->tv_sec, __ATOMIC_RELAXED);
+	usec = __atomic_load_n(&st->tv_usec, __ATOMIC_RELAXED);
+	if ((u_int32_t) tv->tv_sec < sec ||
+			((u_int32_t) tv->tv_sec == sec && (u_int32_t) tv->tv_usec < usec)) {
+		tv->tv_sec = sec;
+		tv->tv_usec = usec;
 	}
 }
 
+/*
+ * Updates the current state to reflect the new state
+ * after a new authenticator is generated; net_st gets the new state in
+ * network byte order. The sequence number is taken atomically, so threads
+ * sharing st never send the same one
+ */
+static void
+update_state(state * st, state * net_st)
+{
+	struct timeval tmp;
+	u_int32_t seq;
+
+	state_time(st, &tmp);
+	seq = __atomic_add_fetch(&st->seq, 1, __ATOMIC_RELAXED);
+	__atomic_store_n(&st->tv_sec, tmp.tv_sec, __ATOMIC_RELAXED);
+	__atomic_store_n(&st->tv_usec, tmp.tv_usec, __ATOMIC_RELAXED);
+
+	net_st->tv_sec = htonl(tmp.tv_sec);
+	net_st->tv_usec = htonl(tmp.tv_usec);
+	net_st->seq = htonl(seq);
+	net_st->rsvd = htonl(__atomic_load_n(&st->rsvd, __ATOMIC_RELAXED));
+}
+
+/*
+ * Checks that the command was issued no more than maxDelay ms from now,
+ * maxDelay 0 accepts any time
+ */
 int
-verify_update_state_freshness(state * currstate, state * new_state, unsigned long int maxDelay)
+verify_state_time(state * st, unsigned long int maxDelay)
 {
 	long int diff;
 	struct timeval t_now;
 
+	if (maxDelay > 0) {
+		gettimeofday(&t_now, NULL);
+		diff = (int) ((t_now.tv_sec - st->tv_sec)*1000000 + t_now.tv_usec - st->tv_usec) / 1000;
+		if (labs(diff) > maxDelay)
+			return FAIL_COMMAND_EXPIRED;
+	}
+
+	return AUTH_OK;
+}
+
+static int
+verify_update_state_freshness(state * currstate, state * new_state, unsigned long int maxDelay)
+{
+	struct timeval t_now;
+	int ret;
+
 	if (!currstate || !new_state)
 		return INFO_STATE_NOT_VERIFIED;
 
@@ -180,12 +228,10 @@ verify_update_state_freshness(state * currstate, state * new_state, unsigned lon
 		return FAIL_DUPLICATE_INTEREST;
 
 	//Check if the interest is recent
+	ret = verify_state_time(new_state, maxDelay);
+	if (ret != AUTH_OK)
+		return ret;
 	gettimeofday(&t_now, NULL);
-	if (maxDelay > 0) {
-		diff = (int) ((t_now.tv_sec - new_state->tv_sec)*1000000 + t_now.tv_usec - new_state->tv_usec) / 1000;
-		if (labs(diff) > maxDelay)
-			return FAIL_COMMAND_EXPIRED;
-	}
 
 	// The state of the interest looks good. Update current application state
 	currstate->seq = new_state->seq;
@@ -219,12 +265,8 @@ authenticateCommand(state *st, struct ndn_charbuf *commandname, unsigned char *a
 	int mac_offset = state_offset + state_len;
 
 	// update and store the current time in "state"
-	update_state(st);
-    state net_st;  // Convert 'st' into network byte order
-    net_st.tv_sec = htonl(st->tv_sec);
-    net_st.tv_usec = htonl(st->tv_usec);
-    net_st.seq = htonl(st->seq);
-    net_st.rsvd = htonl(st->rsvd);
+    state net_st;  // 'st' after the update, in network byte order
+	update_state(st, &net_st);
 
 	command_len = commandname->length;
 
@@ -277,6 +319,62 @@ authenticateCommand(state *st, struct ndn_charbuf *commandname, unsigned char *a
 	free(authenticatorwithmagic);
 }
 
+/*
+ * Same authenticated name as authenticateCommand(), but the MAC is computed
+ * over the parts where they are and the component is assembled in out.
+ * Returns 0, or -1 when commandname isn't a name or out can't grow
+ */
+int
+authenticateCommandInto(state * st, const struct ndn_charbuf * commandname,
+		const unsigned char * appname, unsigned int appname_len,
+		const unsigned char * appkey, HMAC_CTX * ctx, struct ndn_charbuf * out)
+{
+	static const unsigned char closer[2] = {0, 0};
+	unsigned char len[2];
+	unsigned char *mac;
+	size_t auth_len;
+	state net_st;
+	int r;
+
+	if (commandname->length < 2 || commandname->buf[commandname->length - 1] != 0)
+		return -1;
+
+	auth_len = AUTH_MAGIC_LEN + 2 + appname_len + sizeof(state) + MACLEN;
+
+	// one allocation at most, for a buffer that was never this long
+	out->length = 0;
+	if (!ndn_charbuf_reserve(out, commandname->length + auth_len + 16))
+		return -1;
+
+	update_state(st, &net_st);
+
+	len[0] = (appname_len >> 8) & 0xff;
+	len[1] = appname_len & 0xff;
+
+	// MAC(commandname|appname|state), commandname with its closing tag
+	if (!HMAC_Init_ex(ctx, appkey, APPKEYLEN, EVP_sha256(), NULL) ||
+			!HMAC_Update(ctx, commandname->buf, commandname->length) ||
+			!HMAC_Update(ctx, appname, appname_len) ||
+			!HMAC_Update(ctx, (unsigned char *) &net_st, sizeof(net_st)))
+		return -1;
+
+	r = ndn_charbuf_append(out, commandname->buf, commandname->length - 1);
+	r |= ndn_charbuf_append_tt(out, NDN_DTAG_Component, NDN_DTAG);
+	r |= ndn_charbuf_append_tt(out, auth_len, NDN_BLOB);
+	r |= ndn_charbuf_append(out, SK_AUTH_MAGIC, AUTH_MAGIC_LEN);
+	r |= ndn_charbuf_append(out, len, sizeof(len));
+	r |= ndn_charbuf_append(out, appname, appname_len);
+	r |= ndn_charbuf_append(out, &net_st, sizeof(net_st));
+	if (r < 0)
+		return -1;
+
+	mac = ndn_charbuf_reserve(out, MACLEN);
+	if (!mac || !HMAC_Final(ctx, mac, NULL))
+		return -1;
+	out->length += MACLEN;
+
+	return ndn_charbuf_append(out, closer, sizeof(closer)) < 0 ? -1 : 0;
+}
 
 /* return NOT_AUTHENTICATOR if no authenticator, AUTH_SYMMETRIC if symmetric, AUTH_ASYMMETRIC if asymmetric */
 static int
@@ -493,12 +591,8 @@ authenticateCommandSig(state * st, struct ndn_charbuf * commandname, unsigned ch
 
 	int state_len = sizeof(state);
 
-	update_state(st);
-    state net_st;  // Convert 'st' into network byte order
-    net_st.tv_sec = htonl(st->tv_sec);
-    net_st.tv_usec = htonl(st->tv_usec);
-    net_st.seq = htonl(st->seq);
-    net_st.rsvd = htonl(st->rsvd);
+    state net_st;  // 'st' after the update, in network byte order
+	update_state(st, &net_st);
 
 	command_len = (int) commandname->length;
 
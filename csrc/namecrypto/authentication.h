@@ -10,6 +10,7 @@
 #ifndef __ndn_authentication__
 #define __ndn_authentication__
 #include <time.h>
+#include <openssl/hmac.h>
 #include <openssl/rsa.h>
 #include <openssl/sha.h>
 #include <ndn/ndn.h>
@@ -56,9 +57,16 @@ unsigned char * appKey(unsigned char * k, unsigned int keylen, unsigned char * a
 // Symmetric
 void authenticateCommand(state * st, struct ndn_charbuf * commandname, unsigned char * appname, unsigned int appname_len, unsigned char * appkey);
 
+// Symmetric, writes commandname with the authenticator into out (not commandname);
+// ctx is scratch space. Allocates nothing once out is large enough
+int authenticateCommandInto(state * st, const struct ndn_charbuf * commandname, const unsigned char * appname, unsigned int appname_len, const unsigned char * appkey, HMAC_CTX * ctx, struct ndn_charbuf * out);
+
 // Public key
 void authenticateCommandSig(state * st, struct ndn_charbuf * commandname, unsigned char * appname, unsigned int appname_len, RSA * app_signing_key);
 
+// Checks that the command in st isn't older or newer than maxTimeDifferenceMsec
+int verify_state_time(state * st, unsigned long int maxTimeDifferenceMsec);
+
 // Use with both symmetric and asymmetric
 int verifyCommand(struct ndn_charbuf * authenticatedname, unsigned char * fixtureKey, unsigned int keylen, RSA * pubkey, state * currstate, unsigned long int maxTimeDifferenceMsec);
 
@@ -11,11 +11,36 @@
 #ifndef __ndn_encryption__
 #define __ndn_encryption__
 
+#include <stdlib.h>
+#include <openssl/hmac.h>
 #include <openssl/rsa.h>
 #include <openssl/sha.h>
 
 #define MACLEN SHA256_DIGEST_LENGTH
 
+// OpenSSL before 1.1 has no opaque HMAC_CTX
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+static inline HMAC_CTX *
+HMAC_CTX_new(void)
+{
+	HMAC_CTX *ctx = malloc(sizeof(*ctx));
+
+	if (ctx)
+		HMAC_CTX_init(ctx);
+
+	return ctx;
+}
+
+static inline void
+HMAC_CTX_free(HMAC_CTX *ctx)
+{
+	if (ctx) {
+		HMAC_CTX_cleanup(ctx);
+		free(ctx);
+	}
+}
+#endif
+
 unsigned char *KDF(const unsigned char *key, unsigned int keylen, const unsigned char *appid, unsigned int appid_len);
 
 #endif
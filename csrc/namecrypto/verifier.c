@@ -0,0 +1,404 @@
+//
+//  verifier.c
+//  namecrypto
+//
+//  Copyright (c) 2013, Regents of the University of California
+//  BSD license, See the COPYING file for more information
+//
+
+/*
+ * A verifier for a stream of authenticated command names. verifyCommand()
+ * splits every name into a new indexbuf, copies the prefix and the
+ * authenticator and derives the application key again; here the derived
+ * key is kept per appname together with an HMAC context already keyed
+ * with it (so the inner and outer pads are hashed only once), and the MAC
+ * is computed over the name, appname and state where they lie in the
+ * name. Verifying a command allocates nothing once its app is known.
+ *
+ * Unlike verifyCommand() the MAC is checked before the state is updated,
+ * so a forged command can't move the sequence number forward.
+ *
+ * Replays are caught per app with a window over the last sequence
+ * numbers accepted, like IPsec does (RFC 4303 3.4.3): a command that
+ * arrives after a newer one is still accepted as long as its number is
+ * in the window and wasn't seen yet. A window of 1 is verifyCommand()'s
+ * strict ordering.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/sha.h>
+
+#include <ndn/ndn.h>
+#include <ndn/hashtb.h>
+
+#include "authentication.h"
+#include "encryption.h"
+#include "verifier.h"
+
+#define NC_WINDOW_WORDS (NC_WINDOW_MAX / 64)
+
+struct nc_app {
+	unsigned char app_key[APPKEYLEN];
+	HMAC_CTX *hmac;                 /* keyed with app_key, or NULL */
+	int seen;                       /* any command accepted yet */
+	uint32_t top;                   /* highest seq accepted */
+	uint64_t window[NC_WINDOW_WORDS]; /* seq % NC_WINDOW_MAX seen */
+};
+
+struct nc_verifier {
+	unsigned char *fixture_key;
+	unsigned int keylen;
+	RSA *pubkey;                    /* for signed commands, may be NULL */
+	unsigned long max_diff_ms;      /* 0 doesn't check the time */
+	unsigned int window;            /* sequence numbers remembered */
+	struct hashtb *apps;            /* appname -> struct nc_app */
+	struct ndn_indexbuf *comps;     /* scratch for ndn_name_split() */
+	int busy;                       /* see nc_verifier_claim() */
+};
+
+/* where the parts of an authenticated name are */
+struct nc_command {
+	const unsigned char *prefix;    /* name up to the authenticator */
+	size_t prefix_len;              /* without the closing tag */
+	const unsigned char *appname;
+	size_t appname_len;
+	const unsigned char *state;     /* network byte order */
+	const unsigned char *mac;       /* MAC or signature */
+	size_t mac_len;
+	int type;                       /* AUTH_SYMMETRIC or AUTH_ASYMMETRIC */
+};
+
+static const unsigned char g_closer = 0;
+
+static void
+nc_app_clear(struct nc_app *app)
+{
+	HMAC_CTX_free(app->hmac);
+	app->hmac = NULL;
+	OPENSSL_cleanse(app->app_key, sizeof(app->app_key));
+}
+
+static void
+nc_app_finalize(struct hashtb_enumerator *e)
+{
+	nc_app_clear(e->data);
+}
+
+struct nc_verifier *
+nc_verifier_create(const unsigned char *fixture_key, unsigned int keylen,
+		RSA *pubkey, unsigned long maxTimeDifferenceMsec, unsigned int window)
+{
+	struct nc_verifier *v;
+
+	if (window < 1 || window > NC_WINDOW_MAX)
+		return NULL;
+
+	struct hashtb_param param = {0};
+
+	v = calloc(1, sizeof(*v));
+	if (!v)
+		return NULL;
+
+	if (keylen) {
+		v->fixture_key = malloc(keylen);
+		if (!v->fixture_key)
+			goto error;
+		memcpy(v->fixture_key, fixture_key, keylen);
+		v->keylen = keylen;
+	}
+
+	param.finalize = nc_app_finalize;
+	v->apps = hashtb_create(sizeof(struct nc_app), &param);
+	v->comps = ndn_indexbuf_create();
+	if (!v->apps || !v->comps)
+		goto error;
+
+	v->window = window;
+	v->max_diff_ms = maxTimeDifferenceMsec;
+	v->pubkey = pubkey;
+
+	return v;
+
+error:
+	nc_verifier_destroy(&v);
+	return NULL;
+}
+
+void
+nc_verifier_destroy(struct nc_verifier **vp)
+{
+	struct nc_verifier *v = *vp;
+
+	if (!v)
+		return;
+
+	if (v->apps)
+		hashtb_destroy(&v->apps);
+	ndn_indexbuf_destroy(&v->comps);
+	if (v->fixture_key) {
+		OPENSSL_cleanse(v->fixture_key, v->keylen);
+		free(v->fixture_key);
+	}
+	if (v->pubkey)
+		RSA_free(v->pubkey);
+	free(v);
+	*vp = NULL;
+}
+
+/*
+ * Marks the verifier as used by the caller, so it can be used without the
+ * caller's lock held. Returns -1 when it's already in use
+ */
+int
+nc_verifier_claim(struct nc_verifier *v)
+{
+	if (v->busy)
+		return -1;
+
+	v->busy = 1;
+	return 0;
+}
+
+void
+nc_verifier_release(struct nc_verifier *v)
+{
+	v->busy = 0;
+}
+
+static int
+split_command(struct nc_verifier *v, const struct ndn_charbuf *name,
+		struct nc_command *cmd)
+{
+	const unsigned char *comp, *auth;
+	size_t comp_len, auth_len, sig_len;
+	int i, n;
+
+	n = ndn_name_split(name, v->comps);
+	if (n < 0)
+		return FAIL_MISSING_AUTHENTICATOR;
+
+	/* the first component can't be an authenticator */
+	for (i = n - 1; i > 0; i--) {
+		if (ndn_name_comp_get(name->buf, v->comps, i, &comp, &comp_len) < 0)
+			return FAIL_MISSING_AUTHENTICATOR;
+
+		if (comp_len < AUTH_MAGIC_LEN)
+			continue;
+
+		if (!memcmp(comp, SK_AUTH_MAGIC, AUTH_MAGIC_LEN))
+			cmd->type = AUTH_SYMMETRIC;
+		else if (!memcmp(comp, PK_AUTH_MAGIC, AUTH_MAGIC_LEN))
+			cmd->type = AUTH_ASYMMETRIC;
+		else
+			continue;
+
+		/* the name up to and including the previous component */
+		cmd->prefix = name->buf;
+		cmd->prefix_len = v->comps->buf[i];
+
+		auth = comp + AUTH_MAGIC_LEN;
+		auth_len = comp_len - AUTH_MAGIC_LEN;
+		if (auth_len < 2)
+			return FAIL_INVALID_AUTHENTICATOR;
+
+		cmd->appname_len = (auth[0] << 8) + auth[1];
+		if (auth_len < 2 + cmd->appname_len + sizeof(state))
+			return FAIL_INVALID_AUTHENTICATOR;
+
+		cmd->appname = auth + 2;
+		cmd->state = cmd->appname + cmd->appname_len;
+		cmd->mac = cmd->state + sizeof(state);
+		cmd->mac_len = auth_len - 2 - cmd->appname_len - sizeof(state);
+
+		sig_len = cmd->type == AUTH_SYMMETRIC ? MACLEN :
+				v->pubkey ? (size_t) RSA_size(v->pubkey) : cmd->mac_len;
+		if (cmd->mac_len != sig_len)
+			return FAIL_INVALID_AUTHENTICATOR;
+
+		return AUTH_OK;
+	}
+
+	return FAIL_MISSING_AUTHENTICATOR;
+}
+
+/* HMAC context for a new app, not kept until a command verified with it */
+static int
+derive_app_key(struct nc_verifier *v, const struct nc_command *cmd,
+		struct nc_app *tmp)
+{
+	unsigned char app_id[APPIDLEN];
+
+	if (!appID((unsigned char *) cmd->appname, cmd->appname_len, app_id) ||
+			!appKey(v->fixture_key, v->keylen, app_id, tmp->app_key))
+		return -1;
+
+	tmp->hmac = HMAC_CTX_new();
+	if (!tmp->hmac)
+		return -1;
+
+	if (!HMAC_Init_ex(tmp->hmac, tmp->app_key, APPKEYLEN, EVP_sha256(),
+			NULL)) {
+		nc_app_clear(tmp);
+		return -1;
+	}
+
+	return 0;
+}
+
+static struct nc_app *
+keep_app(struct nc_verifier *v, const struct nc_command *cmd)
+{
+	struct hashtb_enumerator ee, *e = &ee;
+	struct nc_app *app = NULL;
+	int r;
+
+	hashtb_start(v->apps, e);
+	r = hashtb_seek(e, cmd->appname, cmd->appname_len, 0);
+	if (r >= 0)
+		app = e->data;
+	hashtb_end(e);
+
+	return app;
+}
+
+static int
+verify_symmetric(struct nc_verifier *v, const struct nc_command *cmd,
+		struct nc_app **appp)
+{
+	struct nc_app tmp, *app;
+	HMAC_CTX *hmac;
+	unsigned char mac[MACLEN];
+	int ok;
+
+	if (!v->keylen)
+		return FAIL_VERIFICATION_KEY_NOT_PROVIDED;
+
+	memset(&tmp, 0, sizeof(tmp));
+	app = hashtb_lookup(v->apps, cmd->appname, cmd->appname_len);
+	if (app && app->hmac)
+		hmac = app->hmac;
+	else if (derive_app_key(v, cmd, &tmp) < 0)
+		return FAIL_NO_MEMORY;
+	else
+		hmac = tmp.hmac;
+
+	/* a NULL key keeps the one the context was initialized with */
+	ok = HMAC_Init_ex(hmac, NULL, 0, NULL, NULL) &&
+			HMAC_Update(hmac, cmd->prefix, cmd->prefix_len) &&
+			HMAC_Update(hmac, &g_closer, 1) &&
+			HMAC_Update(hmac, cmd->appname, cmd->appname_len) &&
+			HMAC_Update(hmac, cmd->state, sizeof(state)) &&
+			HMAC_Final(hmac, mac, NULL);
+
+	ok = ok && !CRYPTO_memcmp(mac, cmd->mac, MACLEN);
+
+	if (hmac == tmp.hmac) {
+		if (ok && !app)
+			app = keep_app(v, cmd);
+		if (!ok || !app) {
+			nc_app_clear(&tmp);
+			return ok ? FAIL_NO_MEMORY : FAIL_VERIFICATION_FAILED;
+		}
+
+		memcpy(app->app_key, tmp.app_key, sizeof(app->app_key));
+		app->hmac = tmp.hmac;
+	}
+
+	*appp = app;
+	return ok ? AUTH_OK : FAIL_VERIFICATION_FAILED;
+}
+
+static int
+verify_signature(struct nc_verifier *v, const struct nc_command *cmd,
+		struct nc_app **appp)
+{
+	SHA256_CTX ctx;
+	unsigned char md[SHA256_DIGEST_LENGTH];
+
+	if (!v->pubkey)
+		return FAIL_VERIFICATION_KEY_NOT_PROVIDED;
+
+	SHA256_Init(&ctx);
+	SHA256_Update(&ctx, cmd->prefix, cmd->prefix_len);
+	SHA256_Update(&ctx, &g_closer, 1);
+	SHA256_Update(&ctx, cmd->appname, cmd->appname_len);
+	SHA256_Update(&ctx, cmd->state, sizeof(state));
+	SHA256_Final(md, &ctx);
+
+	if (RSA_verify(NID_sha256, md, sizeof(md), cmd->mac, cmd->mac_len,
+			v->pubkey) != 1)
+		return FAIL_VERIFICATION_FAILED;
+
+	*appp = keep_app(v, cmd);
+	return *appp ? AUTH_OK : FAIL_NO_MEMORY;
+}
+
+#define WINDOW_BIT(seq) ((uint64_t) 1 << ((seq) % 64))
+#define WINDOW_WORD(app, seq) ((app)->window[(seq) % NC_WINDOW_MAX / 64])
+
+/* Records seq as seen, unless it was seen already or is out of the window */
+static int
+update_window(struct nc_verifier *v, struct nc_app *app, uint32_t seq)
+{
+	uint32_t s;
+
+	if (!app->seen || (seq > app->top && seq - app->top >= NC_WINDOW_MAX))
+		memset(app->window, 0, sizeof(app->window));
+	else if (seq > app->top) {
+		for (s = app->top + 1; s != seq; s++)
+			WINDOW_WORD(app, s) &= ~WINDOW_BIT(s);
+	} else if (app->top - seq >= v->window ||
+			WINDOW_WORD(app, seq) & WINDOW_BIT(seq))
+		return FAIL_DUPLICATE_INTEREST;
+
+	if (!app->seen || seq > app->top) {
+		app->top = seq;
+		app->seen = 1;
+	}
+	WINDOW_WORD(app, seq) |= WINDOW_BIT(seq);
+
+	return AUTH_OK;
+}
+
+/*
+ * Verifies one authenticated name, same results as verifyCommand(). The
+ * verifier isn't locked; only one thread may use it at a time
+ */
+int
+nc_verifier_verify(struct nc_verifier *v, const struct ndn_charbuf *name)
+{
+	struct nc_command cmd;
+	struct nc_app *app;
+	state st;
+	int r;
+
+	r = split_command(v, name, &cmd);
+	if (r != AUTH_OK)
+		return r;
+
+	if (cmd.type == AUTH_SYMMETRIC)
+		r = verify_symmetric(v, &cmd, &app);
+	else
+		r = verify_signature(v, &cmd, &app);
+	if (r != AUTH_OK)
+		return r;
+
+	memcpy(&st, cmd.state, sizeof(st));
+	st.tv_sec = ntohl(st.tv_sec);
+	st.tv_usec = ntohl(st.tv_usec);
+	st.seq = ntohl(st.seq);
+	st.rsvd = ntohl(st.rsvd);
+
+	r = verify_state_time(&st, v->max_diff_ms);
+	if (r != AUTH_OK)
+		return r;
+
+	return update_window(v, app, st.seq);
+}
@@ -0,0 +1,29 @@
+//
+//  verifier.h
+//  namecrypto
+//
+//  Copyright (c) 2013, Regents of the University of California
+//  BSD license, See the COPYING file for more information
+//
+
+#ifndef __ndn_verifier__
+#define __ndn_verifier__
+
+#include <openssl/rsa.h>
+#include <ndn/ndn.h>
+
+/* most sequence numbers a verifier remembers per app */
+#define NC_WINDOW_MAX 1024
+#define NC_WINDOW_DEFAULT 64
+
+struct nc_verifier;
+
+struct nc_verifier *nc_verifier_create(const unsigned char *fixture_key,
+		unsigned int keylen, RSA *pubkey, unsigned long maxTimeDifferenceMsec,
+		unsigned int window);
+void nc_verifier_destroy(struct nc_verifier **vp);
+int nc_verifier_claim(struct nc_verifier *v);
+void nc_verifier_release(struct nc_verifier *v);
+int nc_verifier_verify(struct nc_verifier *v, const struct ndn_charbuf *name);
+
+#endif
@@ -13,9 +13,20 @@
 #include <stdlib.h>
 
 #include "pyndn.h"
+#include "archive.h"
+#include "methods_exclusionfilter.h"
+#include "methods_repo.h"
+#include "methods_response_queue.h"
+#include "methods_subscription.h"
+#include "methods_timer.h"
 #include "objects.h"
+#include "stats.h"
 #include "util.h"
 
+#ifdef NAMECRYPTO
+#  include "namecrypto/verifier.h"
+#endif
+
 /*
 static struct completed_closure *g_completed_closures;
  */
@@ -24,6 +35,7 @@ static struct type_to_name {
 	enum _pyndn_capsules type;
 	const char *name;
 } g_types_to_names[] = {
+	{ARCHIVE, "Archive_ndn_data"},
 	{CLOSURE, "Closure_ndn_data"},
 	{CONTENT_OBJECT, "Data_ndn_data"},
 	{EXCLUSION_FILTER, "ExclusionFilter_ndn_data"},
@@ -33,10 +45,16 @@ static struct type_to_name {
 	{NAME, "Name_ndn_data"},
 	{PKEY_PRIV, "PKEY_PRIV_ndn_data"},
 	{PKEY_PUB, "PKEY_PUB_ndn_data"},
+	{REPO_UPLOAD, "RepoUpload_ndn_data"},
+	{RESPONSE_QUEUE, "ResponseQueue_ndn_data"},
 	{SIGNATURE, "Signature_ndn_data"},
 	{SIGNED_INFO, "SignedInfo_ndn_data"},
+	{SIGNING_PARAMS, "SigningParams_ndn_data"},
+	{SUBSCRIPTION, "Subscription_ndn_data"},
+	{TIMER, "Timer_ndn_data"},
 #ifdef NAMECRYPTO
 	{NAMECRYPTO_STATE, "Namecrypto_state"},
+	{NAMECRYPTO_VERIFIER, "Namecrypto_verifier"},
 #endif
 	{0, NULL}
 };
@@ -88,6 +106,12 @@ pyndn_Capsule_Destructor(PyObject *capsule)
 	assert(pointer);
 
 	switch (type) {
+	case ARCHIVE:
+	{
+		struct archive *p = pointer;
+		archive_close(&p);
+	}
+		break;
 	case CLOSURE:
 	{
 		PyObject *py_obj_closure;
@@ -120,9 +144,15 @@ pyndn_Capsule_Destructor(PyObject *capsule)
 		break;
 	case HANDLE:
 	{
+		struct handle_stats *stats;
 		struct ndn *p = pointer;
+
+		/* closures still refer to the stats until they get FINAL */
+		stats = PyCapsule_GetContext(capsule);
+		handle_timers_destroy(&stats->timers);
 		ndn_disconnect(p);
 		ndn_destroy(&p);
+		handle_stats_destroy(&stats);
 	}
 		break;
 	case INTEREST:
@@ -147,6 +177,23 @@ pyndn_Capsule_Destructor(PyObject *capsule)
 	}
 		break;
 	case EXCLUSION_FILTER:
+	{
+		struct exclusion_filter *p = pointer;
+		exclusion_filter_destroy(&p);
+	}
+		break;
+	case REPO_UPLOAD:
+	{
+		struct repo_upload *p = pointer;
+		repo_upload_destroy(&p);
+	}
+		break;
+	case RESPONSE_QUEUE:
+	{
+		struct response_queue *p = pointer;
+		response_queue_destroy(&p);
+	}
+		break;
 	case KEY_LOCATOR:
 	case NAME:
 	case SIGNATURE:
@@ -166,10 +213,29 @@ pyndn_Capsule_Destructor(PyObject *capsule)
 		free(p);
 	}
 		break;
+	case SUBSCRIPTION:
+	{
+		struct subscription *p = pointer;
+		subscription_destroy(&p);
+	}
+		break;
+	case TIMER:
+	{
+		struct pyndn_timer *p = pointer;
+		pyndn_timer_destroy(&p);
+	}
+		break;
 #ifdef NAMECRYPTO
 	case NAMECRYPTO_STATE:
 		free(pointer);
 		break;
+	case NAMECRYPTO_VERIFIER:
+	{
+		struct nc_verifier *p = pointer;
+
+		nc_verifier_destroy(&p);
+	}
+		break;
 #endif
 	default:
 		debug("Got capsule: %s\n", PyCapsule_GetName(capsule));
@@ -203,6 +269,20 @@ NDNObject_New(enum _pyndn_capsules type, void *pointer)
 		}
 		break;
 	}
+	case HANDLE:
+	{
+		struct handle_stats *context;
+
+		context = handle_stats_create();
+		JUMP_IF_NULL_MEM(context, error);
+
+		r = PyCapsule_SetContext(capsule, context);
+		if (r < 0) {
+			handle_stats_destroy(&context);
+			goto error;
+		}
+		break;
+	}
 	case INTEREST:
 	{
 		struct interest_data *context;
@@ -274,21 +354,21 @@ NDNObject_Get(enum _pyndn_capsules type, PyObject *capsule)
 PyObject *
 NDNObject_New_Closure(struct ndn_closure **closure)
 {
-	struct ndn_closure *p;
+	struct pyndn_closure *p;
 	PyObject *result;
 
 	p = calloc(1, sizeof(*p));
 	if (!p)
 		return PyErr_NoMemory();
 
-	result = NDNObject_New(CLOSURE, p);
+	result = NDNObject_New(CLOSURE, &p->closure);
 	if (!result) {
 		free(p);
 		return NULL;
 	}
 
 	if (closure)
-		*closure = p;
+		*closure = &p->closure;
 
 	return result;
 }
@@ -301,7 +381,6 @@ NDNObject_New_charbuf(enum _pyndn_capsules type,
 	PyObject *py_o;
 
 	assert(type == CONTENT_OBJECT ||
-			type == EXCLUSION_FILTER ||
 			type == INTEREST ||
 			type == KEY_LOCATOR ||
 			type == NAME ||
@@ -17,7 +17,8 @@ struct completed_closure {
 #  endif
 
 enum _pyndn_capsules {
-	CLOSURE = 1,
+	ARCHIVE = 1,
+	CLOSURE,
 	CONTENT_OBJECT,
 	EXCLUSION_FILTER,
 	HANDLE,
@@ -26,11 +27,16 @@ enum _pyndn_capsules {
 	NAME,
 	PKEY_PRIV,
 	PKEY_PUB,
+	REPO_UPLOAD,
+	RESPONSE_QUEUE,
 	SIGNATURE,
 	SIGNED_INFO,
 	SIGNING_PARAMS,
+	SUBSCRIPTION,
+	TIMER,
 #  ifdef NAMECRYPTO
 	NAMECRYPTO_STATE,
+	NAMECRYPTO_VERIFIER,
 #  endif
 };
 
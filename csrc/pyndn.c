@@ -16,13 +16,21 @@
 #include "util.h"
 #include "key_utils.h"
 #include "methods.h"
+#include "methods_archive.h"
 #include "methods_contentobject.h"
+#include "methods_crawler.h"
+#include "methods_exclusionfilter.h"
 #include "methods_handle.h"
 #include "methods_interest.h"
 #include "methods_key.h"
 #include "methods_name.h"
+#include "methods_repo.h"
+#include "methods_response_queue.h"
+#include "methods_resolver.h"
 #include "methods_signature.h"
 #include "methods_signedinfo.h"
+#include "methods_subscription.h"
+#include "methods_timer.h"
 
 #ifdef NAMECRYPTO
 #    include "methods_namecrypto.h"
@@ -69,12 +77,48 @@ static PyMethodDef g_module_methods[] = {
 	{"set_run_timeout", _pyndn_cmd_set_run_timeout, METH_VARARGS, NULL},
 	{"is_run_executing", _pyndn_cmd_is_run_executing, METH_O, NULL},
 	{"express_interest", _pyndn_cmd_express_interest, METH_VARARGS, NULL},
+	{"express_interest_for_latest", _pyndn_cmd_express_interest_for_latest,
+		METH_VARARGS, NULL},
+	{"clear_version_cache", _pyndn_cmd_clear_version_cache, METH_VARARGS,
+		NULL},
+	{"enumerate_namespace", _pyndn_cmd_enumerate_namespace, METH_VARARGS,
+		NULL},
+	{"archive_open", _pyndn_cmd_archive_open, METH_VARARGS, NULL},
+	{"archive_append", _pyndn_cmd_archive_append, METH_VARARGS, NULL},
+	{"archive_lookup", _pyndn_cmd_archive_lookup, METH_VARARGS, NULL},
+	{"archive_flush", _pyndn_cmd_archive_flush, METH_O, NULL},
+	{"archive_info", _pyndn_cmd_archive_info, METH_O, NULL},
+	{"archive_serve", _pyndn_cmd_archive_serve, METH_VARARGS, NULL},
+	{"repo_upload_start", _pyndn_cmd_repo_upload_start, METH_VARARGS, NULL},
+	{"repo_upload_stats", _pyndn_cmd_repo_upload_stats, METH_O, NULL},
+	{"response_queue_create", _pyndn_cmd_response_queue_create, METH_VARARGS,
+		NULL},
+	{"response_queue_put", _pyndn_cmd_response_queue_put, METH_VARARGS, NULL},
+	{"response_queue_close", _pyndn_cmd_response_queue_close, METH_O, NULL},
+	{"response_queue_stats", _pyndn_cmd_response_queue_stats, METH_O, NULL},
+	{"subscribe", _pyndn_cmd_subscribe, METH_VARARGS, NULL},
+	{"subscription_close", _pyndn_cmd_subscription_close, METH_O, NULL},
+	{"subscription_stats", _pyndn_cmd_subscription_stats, METH_O, NULL},
+	{"call_later", _pyndn_cmd_call_later, METH_VARARGS, NULL},
+	{"call_every", _pyndn_cmd_call_every, METH_VARARGS, NULL},
+	{"timer_cancel", _pyndn_cmd_timer_cancel, METH_O, NULL},
+	{"timer_info", _pyndn_cmd_timer_info, METH_O, NULL},
 	{"set_interest_filter", _pyndn_cmd_set_interest_filter, METH_VARARGS, NULL},
 	{"clear_interest_filter", _pyndn_cmd_clear_interest_filter, METH_VARARGS, NULL},
+	{"stats", _pyndn_cmd_stats, METH_O, NULL},
+	{"set_stats_callback", _pyndn_cmd_set_stats_callback, METH_VARARGS, NULL},
+	{"latency", _pyndn_cmd_latency, METH_VARARGS, NULL},
+	{"set_latency_options", _pyndn_cmd_set_latency_options, METH_VARARGS,
+		NULL},
+	{"slow_upcalls", _pyndn_cmd_slow_upcalls, METH_O, NULL},
 	{"get", _pyndn_cmd_get, METH_VARARGS, NULL},
 	{"put", _pyndn_cmd_put, METH_VARARGS, NULL},
 	{"get_default_key", _pyndn_cmd_get_default_key, METH_NOARGS, NULL},
+	{"get_default_key_name", _pyndn_cmd_get_default_key_name, METH_NOARGS,
+		NULL},
+	{"clear_key_cache", _pyndn_cmd_clear_key_cache, METH_NOARGS, NULL},
 	{"generate_RSA_key", _pyndn_cmd_generate_RSA_key, METH_VARARGS, NULL},
+	{"generate_EC_key", _pyndn_cmd_generate_EC_key, METH_VARARGS, NULL},
 	{"PEM_read_key", (PyCFunction) _pyndn_cmd_PEM_read_key,
 		METH_VARARGS | METH_KEYWORDS, NULL},
 	{"PEM_write_key", (PyCFunction) _pyndn_cmd_PEM_write_key,
@@ -90,6 +134,7 @@ static PyMethodDef g_module_methods[] = {
 	{"content_to_bytes", _pyndn_cmd_content_to_bytes, METH_O, NULL},
 	{"verify_content", _pyndn_cmd_verify_content, METH_VARARGS, NULL},
 	{"verify_signature", _pyndn_cmd_verify_signature, METH_VARARGS, NULL},
+	{"verify_symmetric", _pyndn_cmd_verify_symmetric, METH_VARARGS, NULL},
 #if 0
 	{"_pyndn_ndn_chk_signing_params", _pyndn_ndn_chk_signing_params, METH_VARARGS,
 		""},
@@ -113,11 +158,19 @@ static PyMethodDef g_module_methods[] = {
 	{"name_comps_from_ndn", _pyndn_cmd_name_comps_from_ndn, METH_O, NULL},
 	{"Interest_obj_to_ndn", _pyndn_cmd_Interest_obj_to_ndn, METH_O, NULL},
 	{"Interest_obj_from_ndn", _pyndn_cmd_Interest_obj_from_ndn, METH_O, NULL},
+	{"compile_interest_template", _pyndn_cmd_compile_interest_template,
+		METH_O, NULL},
 	{"encode_Data", _pyndn_cmd_encode_Data, METH_VARARGS,
 		NULL},
+	{"signing_cache", _pyndn_cmd_signing_cache, METH_VARARGS, NULL},
 	{"Data_obj_from_ndn", _pyndn_cmd_Data_obj_from_ndn,
 		METH_O, NULL},
         {"Data_obj_from_ndn_buffer", _pyndn_cmd_Data_obj_from_ndn_buffer, METH_O, NULL},
+	{"peek_data", _pyndn_cmd_peek_data, METH_O, NULL},
+	{"decode_data_stream", _pyndn_cmd_decode_data_stream, METH_VARARGS,
+		NULL},
+	{"Data_signature", _pyndn_cmd_Data_signature, METH_O, NULL},
+	{"Data_signed_info", _pyndn_cmd_Data_signed_info, METH_O, NULL},
 	{"digest_contentobject", _pyndn_cmd_digest_contentobject, METH_VARARGS,
 		NULL},
 	{"content_matches_interest", _pyndn_cmd_content_matches_interest,
@@ -138,10 +191,26 @@ static PyMethodDef g_module_methods[] = {
 		""},
 	{"_pyndn_SigningParams_from_ndn", _pyndn_SigningParams_from_ndn, METH_O, NULL},
 #endif
-	// {"ExclusionFilter_names_to_ndn", _pyndn_cmd_ExclusionFilter_names_to_ndn,
-	// 	METH_O, NULL},
-	// {"ExclusionFilter_obj_from_ndn", _pyndn_cmd_ExclusionFilter_obj_from_ndn,
-	// 	METH_O, NULL},
+	{"exclusion_filter_new", _pyndn_cmd_exclusion_filter_new, METH_NOARGS,
+		NULL},
+	{"exclusion_filter_reset", _pyndn_cmd_exclusion_filter_reset, METH_O,
+		NULL},
+	{"exclusion_filter_add", _pyndn_cmd_exclusion_filter_add, METH_VARARGS,
+		NULL},
+	{"exclusion_filter_add_any", _pyndn_cmd_exclusion_filter_add_any, METH_O,
+		NULL},
+	{"exclusion_filter_exclude_before",
+		_pyndn_cmd_exclusion_filter_exclude_before, METH_VARARGS, NULL},
+	{"exclusion_filter_exclude_after",
+		_pyndn_cmd_exclusion_filter_exclude_after, METH_VARARGS, NULL},
+	{"exclusion_filter_matches", _pyndn_cmd_exclusion_filter_matches,
+		METH_VARARGS, NULL},
+	{"exclusion_filter_components", _pyndn_cmd_exclusion_filter_components,
+		METH_O, NULL},
+	{"ExclusionFilter_to_ndn", _pyndn_cmd_exclusion_filter_to_ndn, METH_O,
+		NULL},
+	{"ExclusionFilter_obj_from_ndn", _pyndn_cmd_exclusion_filter_from_ndn,
+		METH_O, NULL},
 	{"dump_charbuf", _pyndn_cmd_dump_charbuf, METH_O, NULL},
 	{"new_charbuf", _pyndn_cmd_new_charbuf, METH_VARARGS, NULL},
 
@@ -149,10 +218,15 @@ static PyMethodDef g_module_methods[] = {
 	{"nc_new_state", _pyndn_cmd_nc_new_state, METH_NOARGS, NULL},
 	{"nc_authenticate_command", _pyndn_cmd_nc_authenticate_command, METH_VARARGS,
 		NULL},
+	{"nc_authenticate_command_into", _pyndn_cmd_nc_authenticate_command_into,
+		METH_VARARGS, NULL},
 	{"nc_authenticate_command_sig", _pyndn_cmd_nc_authenticate_command_sig,
 		METH_VARARGS, NULL},
 	{"nc_verify_command", (PyCFunction) _pyndn_cmd_nc_verify_command,
 		METH_VARARGS | METH_KEYWORDS, NULL},
+	{"nc_new_verifier", (PyCFunction) _pyndn_cmd_nc_new_verifier,
+		METH_VARARGS | METH_KEYWORDS, NULL},
+	{"nc_verify_batch", _pyndn_cmd_nc_verify_batch, METH_VARARGS, NULL},
 	{"nc_app_id", _pyndn_cmd_nc_app_id, METH_O, NULL},
 	{"nc_app_key", _pyndn_cmd_nc_app_key, METH_VARARGS, NULL},
 #endif
@@ -217,7 +291,7 @@ _pyndn_get_type(enum e_class_type type)
 		{Face, "ndn.Face", "Face"},
 		{Closure, "ndn.Closure", "Closure"},
 		{Data, "ndn.Data", "Data"},
-		/* {ExclusionFilter, "ndn.Interest", "ExclusionFilter"}, */
+		{ExclusionFilter, "ndn.Interest", "ExclusionFilter"},
 		{Interest, "ndn.Interest", "Interest"},
 		{Key, "ndn.Key", "Key"},
 		{KeyLocator, "ndn.KeyLocator", "KeyLocator"},
@@ -276,6 +350,11 @@ MODINIT(_pyndn)
 
 	initialize_exceptions();
 
+	if (_pyndn_init_data_header(_pyndn_module) < 0) {
+		fprintf(stderr, "Unable to initialize PyNDN module\n");
+		INITERROR;
+	}
+
 	initialize_crypto();
 
 #if PY_MAJOR_VERSION >= 3
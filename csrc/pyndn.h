@@ -14,7 +14,7 @@ enum e_class_type {
 	Face,
 	Closure,
 	Data,
-	/* ExclusionFilter, */
+	ExclusionFilter,
 	Interest,
 	Key,
 	KeyLocator,
@@ -35,6 +35,9 @@ struct pyndn_run_state {
 
 struct pyndn_state {
 	struct pyndn_run_state *run_state;
+	struct hashtb *version_cache;
+	struct signing_cache *signing_cache;
+	struct hashtb *key_cache;
 	PyObject *class_type[CLASS_TYPE_COUNT];
 };
 
@@ -52,7 +55,7 @@ PyObject *_pyndn_get_type(enum e_class_type type);
 #  define g_type_Face             _pyndn_get_type(Face)
 #  define g_type_Closure          _pyndn_get_type(Closure)
 #  define g_type_Data             _pyndn_get_type(Data)
-/* #  define g_type_ExclusionFilter  _pyndn_get_type(ExclusionFilter) */
+#  define g_type_ExclusionFilter  _pyndn_get_type(ExclusionFilter)
 #  define g_type_Interest         _pyndn_get_type(Interest)
 #  define g_type_Key              _pyndn_get_type(Key)
 #  define g_type_KeyLocator       _pyndn_get_type(KeyLocator)
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2011, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ * Written by: Derek Kulinski <takeda@takeda.tk>
+ *             Jeff Burke <jburke@ucla.edu>
+ */
+
+/*
+ * sign_symmetric.c - Data signed with a digest or HMAC instead of a key pair
+ *
+ * For traffic that stays on the host or on a trusted segment a public key
+ * signature costs far more than the data is worth. These packets carry
+ * SHA-256 (integrity only) or HMAC-SHA256 (a secret shared by producer and
+ * consumer) over the same part an RSA signature covers, Name through
+ * Content, and say which in DigestAlgorithm. A public key signature may
+ * name plain SHA-256 as its digest too, so a packet only counts as ours
+ * when it also has no KeyLocator and SignatureBits the size of a SHA-256
+ * (an RSA or ECDSA signature never is).
+ */
+
+#include <ndn/ndn.h>
+
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/sha.h>
+
+#include <string.h>
+
+#include "sign_symmetric.h"
+
+enum sign_symmetric_alg
+sign_symmetric_alg(const char *digest_alg, size_t size)
+{
+	if (size == sizeof(SIGN_SYMMETRIC_SHA256) - 1 &&
+			!memcmp(digest_alg, SIGN_SYMMETRIC_SHA256, size))
+		return SIGN_SYMMETRIC_DIGEST;
+
+	if (size == sizeof(SIGN_SYMMETRIC_HMAC_SHA256) - 1 &&
+			!memcmp(digest_alg, SIGN_SYMMETRIC_HMAC_SHA256, size))
+		return SIGN_SYMMETRIC_HMAC;
+
+	return SIGN_SYMMETRIC_NONE;
+}
+
+static int
+compute(unsigned char *md, const unsigned char *data, size_t size,
+		enum sign_symmetric_alg alg, const void *secret, size_t secret_size)
+{
+	unsigned int md_size = SHA256_DIGEST_LENGTH;
+
+	switch (alg) {
+	case SIGN_SYMMETRIC_DIGEST:
+		SHA256(data, size, md);
+		return 0;
+	case SIGN_SYMMETRIC_HMAC:
+		if (!HMAC(EVP_sha256(), secret, (int) secret_size, data, size, md,
+				&md_size))
+			return -1;
+		return md_size == SHA256_DIGEST_LENGTH ? 0 : -1;
+	default:
+		return -1;
+	}
+}
+
+/*
+ * DigestAlgorithm is UDATA, as ndn_encode_ContentObject() writes it and
+ * ndn_parse_ContentObject() expects; every encoder in the module uses this
+ */
+int
+sign_symmetric_append_digest_alg(struct ndn_charbuf *c,
+		const char *digest_alg, size_t size)
+{
+	return ndnb_append_tagged_udata(c, NDN_DTAG_DigestAlgorithm, digest_alg,
+			size);
+}
+
+/* how a parsed packet is signed, SIGN_SYMMETRIC_NONE for a key pair */
+enum sign_symmetric_alg
+sign_symmetric_packet_alg(const unsigned char *co,
+		const struct ndn_parsed_ContentObject *pco)
+{
+	const unsigned char *digest_alg, *bits;
+	size_t digest_alg_size, bits_size;
+	int r;
+
+	if (pco->offset[NDN_PCO_B_KeyLocator] != pco->offset[NDN_PCO_E_KeyLocator])
+		return SIGN_SYMMETRIC_NONE;
+
+	r = ndn_ref_tagged_BLOB(NDN_DTAG_SignatureBits, co,
+			pco->offset[NDN_PCO_B_SignatureBits],
+			pco->offset[NDN_PCO_E_SignatureBits], &bits, &bits_size);
+	if (r < 0 || bits_size != SHA256_DIGEST_LENGTH)
+		return SIGN_SYMMETRIC_NONE;
+
+	r = ndn_ref_tagged_string(NDN_DTAG_DigestAlgorithm, co,
+			pco->offset[NDN_PCO_B_DigestAlgorithm],
+			pco->offset[NDN_PCO_E_DigestAlgorithm], &digest_alg,
+			&digest_alg_size);
+	if (r < 0)
+		return SIGN_SYMMETRIC_NONE;
+
+	return sign_symmetric_alg((const char *) digest_alg, digest_alg_size);
+}
+
+/*
+ * Same layout ndn_encode_ContentObject() produces, with DigestAlgorithm
+ * always present. Returns 0, -1 on failure and -2 when signed_info has a
+ * KeyLocator, which would make the packet look signed with a key pair
+ */
+int
+sign_symmetric_encode(struct ndn_charbuf *co,
+		const struct ndn_charbuf *name, const struct ndn_charbuf *signed_info,
+		const void *content, size_t content_size,
+		enum sign_symmetric_alg alg, const void *secret, size_t secret_size)
+{
+	struct ndn_parsed_ContentObject pco;
+	struct ndn_charbuf *signed_part;
+	unsigned char md[SHA256_DIGEST_LENGTH];
+	const char *digest_alg;
+	size_t start = co->length;
+	int r;
+
+	digest_alg = alg == SIGN_SYMMETRIC_HMAC ? SIGN_SYMMETRIC_HMAC_SHA256 :
+			SIGN_SYMMETRIC_SHA256;
+
+	signed_part = ndn_charbuf_create();
+	if (!signed_part)
+		return -1;
+
+	r = ndn_charbuf_append_charbuf(signed_part, name);
+	r |= ndn_charbuf_append_charbuf(signed_part, signed_info);
+	r |= ndnb_append_tagged_blob(signed_part, NDN_DTAG_Content, content,
+			content_size);
+	if (r < 0)
+		goto out;
+
+	r = compute(md, signed_part->buf, signed_part->length, alg, secret,
+			secret_size);
+	if (r < 0)
+		goto out;
+
+	r = ndn_charbuf_append_tt(co, NDN_DTAG_ContentObject, NDN_DTAG);
+	r |= ndn_charbuf_append_tt(co, NDN_DTAG_Signature, NDN_DTAG);
+	r |= sign_symmetric_append_digest_alg(co, digest_alg, strlen(digest_alg));
+	r |= ndnb_append_tagged_blob(co, NDN_DTAG_SignatureBits, md, sizeof(md));
+	r |= ndn_charbuf_append_closer(co);
+	r |= ndn_charbuf_append_charbuf(co, signed_part);
+	r |= ndn_charbuf_append_closer(co);
+	if (r < 0)
+		goto out;
+
+	/* read back the way sign_symmetric_verify() will */
+	r = ndn_parse_ContentObject(co->buf + start, co->length - start, &pco,
+			NULL);
+	if (r >= 0 && sign_symmetric_packet_alg(co->buf + start, &pco) != alg) {
+		co->length = start;
+		ndn_charbuf_destroy(&signed_part);
+		return -2;
+	}
+
+out:
+	ndn_charbuf_destroy(&signed_part);
+	return r < 0 ? -1 : 0;
+}
+
+/*
+ * Returns 1 when the signature matches, 0 when it doesn't and -1 when the
+ * packet isn't signed with a digest or HMAC
+ */
+int
+sign_symmetric_verify(const unsigned char *co, size_t size,
+		const struct ndn_parsed_ContentObject *pco, const void *secret,
+		size_t secret_size)
+{
+	const unsigned char *bits;
+	unsigned char md[SHA256_DIGEST_LENGTH];
+	size_t bits_size;
+	enum sign_symmetric_alg alg;
+	int r;
+
+	alg = sign_symmetric_packet_alg(co, pco);
+	if (alg == SIGN_SYMMETRIC_NONE)
+		return -1;
+
+	r = ndn_ref_tagged_BLOB(NDN_DTAG_SignatureBits, co,
+			pco->offset[NDN_PCO_B_SignatureBits],
+			pco->offset[NDN_PCO_E_SignatureBits], &bits, &bits_size);
+	if (r < 0 || bits_size != sizeof(md))
+		return 0;
+
+	if (pco->offset[NDN_PCO_E_Content] > size)
+		return 0;
+
+	r = compute(md, co + pco->offset[NDN_PCO_B_Name],
+			pco->offset[NDN_PCO_E_Content] - pco->offset[NDN_PCO_B_Name],
+			alg, secret, secret_size);
+	if (r < 0)
+		return 0;
+
+	return !CRYPTO_memcmp(md, bits, sizeof(md));
+}
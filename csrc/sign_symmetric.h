@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2011, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ * Written by: Derek Kulinski <takeda@takeda.tk>
+ *             Jeff Burke <jburke@ucla.edu>
+ */
+
+#ifndef SIGN_SYMMETRIC_H
+#  define	SIGN_SYMMETRIC_H
+
+/* DigestAlgorithm values, the OIDs of the algorithms */
+#define SIGN_SYMMETRIC_SHA256 "2.16.840.1.101.3.4.2.1"
+#define SIGN_SYMMETRIC_HMAC_SHA256 "1.2.840.113549.2.9"
+
+enum sign_symmetric_alg {
+	SIGN_SYMMETRIC_NONE = 0,        /* public key signature */
+	SIGN_SYMMETRIC_DIGEST,          /* SHA-256 of the signed part */
+	SIGN_SYMMETRIC_HMAC             /* HMAC-SHA256 with a shared secret */
+};
+
+enum sign_symmetric_alg sign_symmetric_alg(const char *digest_alg,
+		size_t size);
+enum sign_symmetric_alg sign_symmetric_packet_alg(const unsigned char *co,
+		const struct ndn_parsed_ContentObject *pco);
+int sign_symmetric_append_digest_alg(struct ndn_charbuf *c,
+		const char *digest_alg, size_t size);
+int sign_symmetric_encode(struct ndn_charbuf *co,
+		const struct ndn_charbuf *name, const struct ndn_charbuf *signed_info,
+		const void *content, size_t content_size,
+		enum sign_symmetric_alg alg, const void *secret, size_t secret_size);
+int sign_symmetric_verify(const unsigned char *co, size_t size,
+		const struct ndn_parsed_ContentObject *pco, const void *secret,
+		size_t secret_size);
+
+#endif	/* SIGN_SYMMETRIC_H */
@@ -0,0 +1,285 @@
+/*
+ * Copyright (c) 2011, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ * Written by: Derek Kulinski <takeda@takeda.tk>
+ *             Jeff Burke <jburke@ucla.edu>
+ */
+
+/*
+ * signing_cache.c - encoded Data packets kept by what went into them
+ *
+ * A producer republishing the same content under the same name pays for a
+ * private key operation every time it signs. The cache remembers the
+ * encoded ContentObject under a SHA-256 of the name, the content, the
+ * SignedInfo and the signing key's ID, so signing unchanged inputs again
+ * is a copy. Entries are kept in LRU order and the least recently used
+ * ones are dropped once the packets take more than the budget.
+ *
+ * The SignedInfo timestamp is left out of the key. It can't be given
+ * explicitly yet, so it's always the time the SignedInfo was encoded, and
+ * counting it would make every freshly built SignedInfo a miss. A hit
+ * therefore returns the packet with the timestamp of the first signature,
+ * so callers only use the cache when they ask for it.
+ */
+
+#include <ndn/ndn.h>
+#include <ndn/digest.h>
+#include <ndn/hashtb.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "signing_cache.h"
+
+struct signing_entry {
+	unsigned char key[SIGNING_CACHE_KEY_SIZE];
+	struct ndn_charbuf *co;
+	struct signing_entry *prev, *next;  /* LRU list, head is the newest */
+};
+
+struct signing_cache {
+	struct hashtb *entries;         /* key -> struct signing_entry */
+	struct signing_entry *head, *tail;
+	struct ndn_digest *digest;
+	size_t bytes, budget;
+	unsigned long long hits, misses, evictions;
+};
+
+static void
+signing_entry_finalize(struct hashtb_enumerator *e)
+{
+	struct signing_entry *entry = e->data;
+
+	ndn_charbuf_destroy(&entry->co);
+}
+
+static void
+lru_unlink(struct signing_cache *cache, struct signing_entry *entry)
+{
+	if (entry->prev)
+		entry->prev->next = entry->next;
+	else
+		cache->head = entry->next;
+
+	if (entry->next)
+		entry->next->prev = entry->prev;
+	else
+		cache->tail = entry->prev;
+
+	entry->prev = entry->next = NULL;
+}
+
+static void
+lru_push(struct signing_cache *cache, struct signing_entry *entry)
+{
+	entry->prev = NULL;
+	entry->next = cache->head;
+
+	if (cache->head)
+		cache->head->prev = entry;
+	else
+		cache->tail = entry;
+
+	cache->head = entry;
+}
+
+static void
+evict(struct signing_cache *cache, size_t budget)
+{
+	struct signing_entry *entry;
+	unsigned char key[SIGNING_CACHE_KEY_SIZE];
+
+	while (cache->tail && cache->bytes > budget) {
+		entry = cache->tail;
+		lru_unlink(cache, entry);
+
+		cache->bytes -= entry->co->length;
+		cache->evictions++;
+
+		/* the entry, and the key stored in it, go away on delete */
+		memcpy(key, entry->key, sizeof(key));
+		hashtb_delete_key(cache->entries, key, sizeof(key));
+	}
+}
+
+struct signing_cache *
+signing_cache_create(size_t budget)
+{
+	struct signing_cache *cache;
+	struct hashtb_param param = {0};
+
+	cache = calloc(1, sizeof(*cache));
+	if (!cache)
+		return NULL;
+
+	param.finalize = signing_entry_finalize;
+	cache->entries = hashtb_create(sizeof(struct signing_entry), &param);
+	cache->digest = ndn_digest_create(NDN_DIGEST_SHA256);
+	if (!cache->entries || !cache->digest) {
+		signing_cache_destroy(&cache);
+		return NULL;
+	}
+
+	cache->budget = budget;
+
+	return cache;
+}
+
+void
+signing_cache_destroy(struct signing_cache **cachep)
+{
+	struct signing_cache *cache = *cachep;
+
+	if (!cache)
+		return;
+
+	if (cache->entries)
+		hashtb_destroy(&cache->entries);
+	ndn_digest_destroy(&cache->digest);
+	free(cache);
+	*cachep = NULL;
+}
+
+void
+signing_cache_set_budget(struct signing_cache *cache, size_t budget)
+{
+	cache->budget = budget;
+	evict(cache, budget);
+}
+
+int
+signing_cache_enabled(const struct signing_cache *cache)
+{
+	return cache->budget > 0;
+}
+
+/*
+ * Fills key with the digest of everything the signature covers, except
+ * the SignedInfo timestamp. Returns 0, or -1 if signed_info can't be parsed
+ */
+int
+signing_cache_key(struct signing_cache *cache, unsigned char *key,
+		const struct ndn_charbuf *name,
+		const void *content, size_t content_size,
+		const struct ndn_charbuf *signed_info, const void *key_id,
+		size_t key_id_size)
+{
+	struct ndn_digest *digest = cache->digest;
+	struct ndn_buf_decoder decoder, *d;
+	size_t start, stop;
+	unsigned char sizes[3 * sizeof(size_t)];
+
+	d = ndn_buf_decoder_start(&decoder, signed_info->buf,
+			signed_info->length);
+	if (!ndn_buf_match_dtag(d, NDN_DTAG_SignedInfo))
+		return -1;
+	ndn_buf_advance(d);
+	ndn_parse_required_tagged_BLOB(d, NDN_DTAG_PublisherPublicKeyDigest, 16,
+			64);
+
+	start = d->decoder.token_index;
+	ndn_parse_optional_tagged_BLOB(d, NDN_DTAG_Timestamp, 1, -1);
+	stop = d->decoder.token_index;
+
+	if (d->decoder.state < 0)
+		return -1;
+
+	/* lengths go in first so the fields can't run into each other */
+	memcpy(sizes, &name->length, sizeof(size_t));
+	memcpy(sizes + sizeof(size_t), &content_size, sizeof(size_t));
+	memcpy(sizes + 2 * sizeof(size_t), &key_id_size, sizeof(size_t));
+
+	ndn_digest_init(digest);
+	ndn_digest_update(digest, sizes, sizeof(sizes));
+	ndn_digest_update(digest, name->buf, name->length);
+	if (content_size)
+		ndn_digest_update(digest, content, content_size);
+	ndn_digest_update(digest, key_id, key_id_size);
+	ndn_digest_update(digest, signed_info->buf, start);
+	ndn_digest_update(digest, signed_info->buf + stop,
+			signed_info->length - stop);
+
+	return ndn_digest_final(digest, key, SIGNING_CACHE_KEY_SIZE) < 0 ? -1 : 0;
+}
+
+/* The cached packet, or NULL. It stays valid until the next store */
+const struct ndn_charbuf *
+signing_cache_lookup(struct signing_cache *cache, const unsigned char *key)
+{
+	struct signing_entry *entry;
+
+	entry = hashtb_lookup(cache->entries, key, SIGNING_CACHE_KEY_SIZE);
+	if (!entry) {
+		cache->misses++;
+		return NULL;
+	}
+
+	cache->hits++;
+	if (entry != cache->head) {
+		lru_unlink(cache, entry);
+		lru_push(cache, entry);
+	}
+
+	return entry->co;
+}
+
+/*
+ * Returns 0 when the packet was stored or didn't fit in the budget, -1
+ * when out of memory
+ */
+int
+signing_cache_store(struct signing_cache *cache, const unsigned char *key,
+		const struct ndn_charbuf *co)
+{
+	struct hashtb_enumerator ee, *e = &ee;
+	struct signing_entry *entry;
+	int r;
+
+	if (co->length > cache->budget)
+		return 0;
+
+	hashtb_start(cache->entries, e);
+
+	r = hashtb_seek(e, key, SIGNING_CACHE_KEY_SIZE, 0);
+	if (r < 0)
+		goto out;
+
+	entry = e->data;
+	if (r == HT_OLD_ENTRY) {
+		r = 0;
+		goto out;
+	}
+
+	memcpy(entry->key, key, SIGNING_CACHE_KEY_SIZE);
+	entry->co = ndn_charbuf_create();
+	if (!entry->co || ndn_charbuf_append_charbuf(entry->co, co) < 0) {
+		hashtb_delete(e);
+		r = -1;
+		goto out;
+	}
+
+	lru_push(cache, entry);
+	cache->bytes += co->length;
+	r = 0;
+
+out:
+	hashtb_end(e);
+
+	/* done after hashtb_end(), evict() deletes by key */
+	if (!r)
+		evict(cache, cache->budget);
+
+	return r;
+}
+
+void
+signing_cache_get_stats(const struct signing_cache *cache,
+		struct signing_cache_stats *stats)
+{
+	stats->hits = cache->hits;
+	stats->misses = cache->misses;
+	stats->evictions = cache->evictions;
+	stats->entries = hashtb_n(cache->entries);
+	stats->bytes = cache->bytes;
+	stats->budget = cache->budget;
+}
@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2011, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ * Written by: Derek Kulinski <takeda@takeda.tk>
+ *             Jeff Burke <jburke@ucla.edu>
+ */
+
+#ifndef SIGNING_CACHE_H
+#  define	SIGNING_CACHE_H
+
+#define SIGNING_CACHE_KEY_SIZE 32           /* SHA-256 */
+#define SIGNING_CACHE_DEFAULT_BUDGET (4 << 20)
+
+struct signing_cache;
+
+struct signing_cache_stats {
+	unsigned long long hits, misses, evictions;
+	size_t entries, bytes, budget;
+};
+
+struct signing_cache *signing_cache_create(size_t budget);
+void signing_cache_destroy(struct signing_cache **cachep);
+void signing_cache_set_budget(struct signing_cache *cache, size_t budget);
+int signing_cache_enabled(const struct signing_cache *cache);
+int signing_cache_key(struct signing_cache *cache, unsigned char *key,
+		const struct ndn_charbuf *name, const void *content,
+		size_t content_size, const struct ndn_charbuf *signed_info,
+		const void *key_id, size_t key_id_size);
+const struct ndn_charbuf *signing_cache_lookup(struct signing_cache *cache,
+		const unsigned char *key);
+int signing_cache_store(struct signing_cache *cache, const unsigned char *key,
+		const struct ndn_charbuf *co);
+void signing_cache_get_stats(const struct signing_cache *cache,
+		struct signing_cache_stats *stats);
+
+#endif	/* SIGNING_CACHE_H */
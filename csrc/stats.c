@@ -0,0 +1,486 @@
+/*
+ * Copyright (c) 2011, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ * Written by: Derek Kulinski <takeda@takeda.tk>
+ *             Jeff Burke <jburke@ucla.edu>
+ */
+
+/*
+ * stats.c - per handle instrumentation
+ */
+
+#include "python_hdr.h"
+#include <ndn/ndn.h>
+#include <ndn/hashtb.h>
+#include <ndn/uri.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "pyndn.h"
+#include "util.h"
+#include "objects.h"
+#include "stats.h"
+
+/*
+ * Histograms are referenced from pending closures, so entries are only
+ * reset and never removed before the handle goes away
+ */
+struct rtt_entry {
+	struct histogram hist;
+	char *uri;
+};
+
+static void
+rtt_entry_finalize(struct hashtb_enumerator *e)
+{
+	struct rtt_entry *entry = e->data;
+
+	free(entry->uri);
+}
+
+struct handle_stats *
+handle_stats_create(void)
+{
+	struct handle_stats *stats;
+
+	stats = calloc(1, sizeof(*stats));
+	if (!stats)
+		return NULL;
+
+	stats->rtt_components = 2;
+	stats->slow_threshold_us = 100000;
+
+	return stats;
+}
+
+void
+handle_stats_destroy(struct handle_stats **statsp)
+{
+	struct handle_stats *stats = *statsp;
+
+	if (!stats)
+		return;
+
+	for (int i = 0; i < HANDLE_STATS_SLOW_UPCALLS; i++)
+		free(stats->slow[i].name);
+
+	hashtb_destroy(&stats->rtt);
+	ndn_indexbuf_destroy(&stats->rtt_comps);
+	Py_XDECREF(stats->py_report);
+	free(stats);
+	*statsp = NULL;
+}
+
+struct handle_stats *
+_pyndn_handle_get_stats(PyObject *py_handle)
+{
+	assert(NDNObject_IsValid(HANDLE, py_handle));
+
+	return PyCapsule_GetContext(py_handle);
+}
+
+static void
+count_upcall(struct handle_stats *stats, enum ndn_upcall_kind upcall_kind,
+		struct ndn_upcall_info *info)
+{
+	if ((unsigned) upcall_kind < sizeof(stats->upcalls) /
+			sizeof(stats->upcalls[0]))
+		stats->upcalls[upcall_kind]++;
+
+	switch (upcall_kind) {
+	case NDN_UPCALL_INTEREST:
+	case NDN_UPCALL_CONSUMED_INTEREST:
+		stats->bytes_in += info->pi->offset[NDN_PI_E];
+		break;
+	case NDN_UPCALL_CONTENT:
+	case NDN_UPCALL_CONTENT_UNVERIFIED:
+	case NDN_UPCALL_CONTENT_BAD:
+	case NDN_UPCALL_CONTENT_KEYMISSING:
+	case NDN_UPCALL_CONTENT_RAW:
+		stats->bytes_in += info->pco->offset[NDN_PCO_E];
+		break;
+	default:
+		break;
+	}
+}
+
+/*
+ * Takes the GIL for an upcall and accounts for it, returns the time the GIL
+ * was obtained which has to be passed to handle_stats_upcall_leave()
+ */
+long long
+handle_stats_upcall_enter(struct ndn_closure *selfp,
+		enum ndn_upcall_kind upcall_kind, struct ndn_upcall_info *info,
+		PyGILState_STATE *gstate)
+{
+	struct handle_stats *stats = (struct handle_stats *) selfp->intdata;
+	long long start, now;
+	unsigned long long wait;
+
+	if (!stats) {
+		*gstate = PyGILState_Ensure();
+		return 0;
+	}
+
+	start = _pyndn_monotonic_us();
+	*gstate = PyGILState_Ensure();
+	now = _pyndn_monotonic_us();
+
+	wait = now - start;
+	stats->gil_wait_us += wait;
+	if (wait > stats->gil_wait_max_us)
+		stats->gil_wait_max_us = wait;
+
+	count_upcall(stats, upcall_kind, info);
+
+	if (stats->ready)
+		histogram_record(&stats->dispatch_time, now - stats->ready);
+
+	return now;
+}
+
+/* URI of the interest the upcall is about, NULL if there's none */
+static char *
+upcall_name(enum ndn_upcall_kind upcall_kind, struct ndn_upcall_info *info)
+{
+	struct ndn_charbuf *uri;
+	char *name = NULL;
+	int r;
+
+	if (upcall_kind == NDN_UPCALL_FINAL || !info || !info->pi)
+		return NULL;
+
+	uri = ndn_charbuf_create();
+	if (!uri)
+		return NULL;
+
+	r = ndn_uri_append(uri, info->interest_ndnb +
+			info->pi->offset[NDN_PI_B_Name],
+			info->pi->offset[NDN_PI_E_Name] -
+			info->pi->offset[NDN_PI_B_Name], 1);
+	if (r >= 0)
+		name = strdup(ndn_charbuf_as_string(uri));
+
+	ndn_charbuf_destroy(&uri);
+
+	return name;
+}
+
+static void
+trace_slow_upcall(struct handle_stats *stats, unsigned long long spent,
+		enum ndn_upcall_kind upcall_kind, struct ndn_upcall_info *info,
+		const char *type)
+{
+	struct slow_upcall *slow;
+	struct timeval tv;
+
+	slow = &stats->slow[stats->slow_count % HANDLE_STATS_SLOW_UPCALLS];
+	stats->slow_count++;
+
+	gettimeofday(&tv, NULL);
+	slow->when = tv.tv_sec + tv.tv_usec / 1e6;
+	slow->duration_us = spent;
+	slow->kind = upcall_kind;
+	snprintf(slow->type, sizeof(slow->type), "%s", type ? type : "");
+
+	free(slow->name);
+	slow->name = upcall_name(upcall_kind, info);
+}
+
+/*
+ * Accounts for the time the upcall held the GIL and releases it. type names
+ * the closure in the slow upcall trace, it only has to stay valid for the
+ * duration of the call.
+ */
+void
+handle_stats_upcall_leave(struct handle_stats *stats, long long entered,
+		enum ndn_upcall_kind upcall_kind, struct ndn_upcall_info *info,
+		const char *type, PyGILState_STATE gstate)
+{
+	unsigned long long spent;
+
+	if (stats) {
+		spent = _pyndn_monotonic_us() - entered;
+		stats->upcall_us += spent;
+		if (spent > stats->upcall_max_us)
+			stats->upcall_max_us = spent;
+		histogram_record(&stats->callback_time, spent);
+
+		if (stats->slow_threshold_us && spent >= stats->slow_threshold_us)
+			trace_slow_upcall(stats, spent, upcall_kind, info, type);
+
+		handle_stats_report(stats);
+	}
+
+	PyGILState_Release(gstate);
+}
+
+PyObject *
+handle_stats_snapshot(const struct handle_stats *stats)
+{
+	const unsigned long long *u = stats->upcalls;
+
+	return Py_BuildValue("{s:K,s:K,s:K,s:K,s:K,s:K,s:K,s:K,s:K,s:K,s:K,"
+			"s:K,s:K,s:d,s:d,s:d,s:d}",
+			"interests_expressed", stats->interests_expressed,
+			"interests_received", u[NDN_UPCALL_INTEREST],
+			"interests_consumed", u[NDN_UPCALL_CONSUMED_INTEREST],
+			"content", u[NDN_UPCALL_CONTENT],
+			"content_unverified", u[NDN_UPCALL_CONTENT_UNVERIFIED],
+			"content_bad", u[NDN_UPCALL_CONTENT_BAD],
+			"content_keymissing", u[NDN_UPCALL_CONTENT_KEYMISSING],
+			"content_raw", u[NDN_UPCALL_CONTENT_RAW],
+			"timeouts", u[NDN_UPCALL_INTEREST_TIMED_OUT],
+			"finals", u[NDN_UPCALL_FINAL],
+			"puts", stats->puts,
+			"bytes_in", stats->bytes_in,
+			"bytes_out", stats->bytes_out,
+			"upcall_time", stats->upcall_us / 1e6,
+			"upcall_max_time", stats->upcall_max_us / 1e6,
+			"gil_wait_time", stats->gil_wait_us / 1e6,
+			"gil_wait_max_time", stats->gil_wait_max_us / 1e6);
+}
+
+/* period in seconds, None disables the callback */
+int
+handle_stats_set_report(struct handle_stats *stats, PyObject *py_report,
+		double period)
+{
+	if (py_report != Py_None && !PyCallable_Check(py_report)) {
+		PyErr_SetString(PyExc_TypeError, "Stats callback must be callable"
+				" or None");
+		return -1;
+	}
+	if (py_report != Py_None && period <= 0) {
+		PyErr_SetString(PyExc_ValueError, "Stats period has to be"
+				" positive");
+		return -1;
+	}
+
+	Py_CLEAR(stats->py_report);
+	if (py_report == Py_None)
+		return 0;
+
+	Py_INCREF(py_report);
+	stats->py_report = py_report;
+	stats->report_period = period * 1000;
+	stats->next_report = _pyndn_monotonic_ms() + stats->report_period;
+
+	return 0;
+}
+
+/*
+ * Calls the periodic callback when it is due. It's checked after upcalls
+ * and when ndn_run() returns, so an idle handle reports late.
+ */
+void
+handle_stats_report(struct handle_stats *stats)
+{
+	PyObject *py_report, *py_snapshot, *py_res;
+	long long now;
+
+	if (!stats->py_report)
+		return;
+
+	now = _pyndn_monotonic_ms();
+	if (now < stats->next_report)
+		return;
+
+	stats->next_report = now + stats->report_period;
+
+	/* the callback may replace itself */
+	py_report = stats->py_report;
+	Py_INCREF(py_report);
+
+	py_snapshot = handle_stats_snapshot(stats);
+	if (py_snapshot) {
+		py_res = PyObject_CallFunctionObjArgs(py_report, py_snapshot,
+				NULL);
+		Py_DECREF(py_snapshot);
+		Py_XDECREF(py_res);
+	}
+	Py_DECREF(py_report);
+
+	if (PyErr_Occurred())
+		PyErr_Print();
+}
+
+/*
+ * Histogram for the first rtt_components components of name, NULL when it
+ * can't be created or there are too many prefixes already
+ */
+struct histogram *
+handle_stats_rtt_histogram(struct handle_stats *stats,
+		const struct ndn_charbuf *name)
+{
+	struct hashtb_param param = {0};
+	struct hashtb_enumerator ee, *e = &ee;
+	struct rtt_entry *entry;
+	struct ndn_charbuf *prefix, *uri;
+	size_t start, stop;
+	int r, ncomps;
+
+	if (!stats->rtt) {
+		param.finalize = rtt_entry_finalize;
+		stats->rtt = hashtb_create(sizeof(struct rtt_entry), &param);
+		if (!stats->rtt)
+			return NULL;
+	}
+
+	if (!stats->rtt_comps) {
+		stats->rtt_comps = ndn_indexbuf_create();
+		if (!stats->rtt_comps)
+			return NULL;
+	}
+
+	ncomps = ndn_name_split(name, stats->rtt_comps);
+	if (ncomps < 0)
+		return NULL;
+	if (ncomps > stats->rtt_components)
+		ncomps = stats->rtt_components;
+
+	/* components are the key, without the Name element around them */
+	start = stats->rtt_comps->buf[0];
+	stop = stats->rtt_comps->buf[ncomps];
+
+	entry = hashtb_lookup(stats->rtt, name->buf + start, stop - start);
+	if (entry)
+		return &entry->hist;
+
+	if (hashtb_n(stats->rtt) >= HANDLE_STATS_RTT_PREFIXES)
+		return NULL;
+
+	prefix = ndn_charbuf_create();
+	uri = ndn_charbuf_create();
+	entry = NULL;
+	if (!prefix || !uri)
+		goto out;
+
+	r = ndn_name_init(prefix);
+	if (r >= 0)
+		r = ndn_name_append_components(prefix, name->buf, start, stop);
+	if (r >= 0)
+		r = ndn_uri_append(uri, prefix->buf, prefix->length, 1);
+	if (r < 0)
+		goto out;
+
+	hashtb_start(stats->rtt, e);
+	r = hashtb_seek(e, name->buf + start, stop - start, 0);
+	if (r == HT_NEW_ENTRY) {
+		entry = e->data;
+		entry->uri = strdup(ndn_charbuf_as_string(uri));
+		if (!entry->uri) {
+			hashtb_delete(e);
+			entry = NULL;
+		}
+	}
+	hashtb_end(e);
+
+out:
+	ndn_charbuf_destroy(&prefix);
+	ndn_charbuf_destroy(&uri);
+
+	return entry ? &entry->hist : NULL;
+}
+
+PyObject *
+handle_stats_latency(struct handle_stats *stats)
+{
+	struct hashtb_enumerator ee, *e = &ee;
+	struct rtt_entry *entry;
+	PyObject *py_rtt, *py_o;
+	int r;
+
+	py_rtt = PyDict_New();
+	if (!py_rtt)
+		return NULL;
+
+	if (stats->rtt) {
+		for (hashtb_start(stats->rtt, e); e->data; hashtb_next(e)) {
+			entry = e->data;
+
+			py_o = histogram_to_python(&entry->hist);
+			if (!py_o)
+				break;
+
+			r = PyDict_SetItemString(py_rtt, entry->uri, py_o);
+			Py_DECREF(py_o);
+			if (r < 0)
+				break;
+		}
+		hashtb_end(e);
+
+		if (PyErr_Occurred()) {
+			Py_DECREF(py_rtt);
+			return NULL;
+		}
+	}
+
+	return Py_BuildValue("{s:N,s:N,s:N,s:K}",
+			"rtt", py_rtt,
+			"callback", histogram_to_python(&stats->callback_time),
+			"dispatch", histogram_to_python(&stats->dispatch_time),
+			"slow_upcalls", stats->slow_count);
+}
+
+void
+handle_stats_latency_reset(struct handle_stats *stats)
+{
+	struct hashtb_enumerator ee, *e = &ee;
+
+	histogram_reset(&stats->callback_time);
+	histogram_reset(&stats->dispatch_time);
+
+	if (stats->rtt) {
+		for (hashtb_start(stats->rtt, e); e->data; hashtb_next(e))
+			histogram_reset(&((struct rtt_entry *) e->data)->hist);
+		hashtb_end(e);
+	}
+
+	for (int i = 0; i < HANDLE_STATS_SLOW_UPCALLS; i++) {
+		free(stats->slow[i].name);
+		stats->slow[i].name = NULL;
+	}
+	stats->slow_count = 0;
+}
+
+/* slow upcalls still in the ring, oldest first */
+PyObject *
+handle_stats_slow_upcalls(const struct handle_stats *stats)
+{
+	const struct slow_upcall *slow;
+	unsigned long long i, first;
+	PyObject *py_list, *py_o;
+	int r;
+
+	py_list = PyList_New(0);
+	if (!py_list)
+		return NULL;
+
+	first = stats->slow_count > HANDLE_STATS_SLOW_UPCALLS ?
+			stats->slow_count - HANDLE_STATS_SLOW_UPCALLS : 0;
+
+	for (i = first; i < stats->slow_count; i++) {
+		slow = &stats->slow[i % HANDLE_STATS_SLOW_UPCALLS];
+
+		py_o = Py_BuildValue("{s:d,s:d,s:i,s:s,s:z}",
+				"time", slow->when,
+				"duration", slow->duration_us / 1e6,
+				"kind", slow->kind,
+				"type", slow->type,
+				"name", slow->name);
+		JUMP_IF_NULL(py_o, error);
+
+		r = PyList_Append(py_list, py_o);
+		Py_DECREF(py_o);
+		JUMP_IF_NEG(r, error);
+	}
+
+	return py_list;
+
+error:
+	Py_DECREF(py_list);
+	return NULL;
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2011, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ * Written by: Derek Kulinski <takeda@takeda.tk>
+ *             Jeff Burke <jburke@ucla.edu>
+ */
+
+#ifndef STATS_H
+#  define	STATS_H
+
+#include "histogram.h"
+
+#define HANDLE_STATS_RTT_PREFIXES 256   /* distinct RTT prefixes kept */
+#define HANDLE_STATS_SLOW_UPCALLS 64    /* slow upcalls remembered */
+#define HANDLE_STATS_TYPE_LEN 64
+
+/* an upcall which held the GIL longer than the slow threshold */
+struct slow_upcall {
+	double when;                    /* wall clock, like time.time() */
+	unsigned long long duration_us;
+	enum ndn_upcall_kind kind;
+	char type[HANDLE_STATS_TYPE_LEN]; /* closure class */
+	char *name;                     /* interest name URI, or NULL */
+};
+
+/*
+ * Per handle counters, kept as the context of the handle capsule. Closures
+ * created for a handle carry a pointer to them in their intdata field, so
+ * upcall handlers can find them without a lookup.
+ */
+struct handle_stats {
+	unsigned long long interests_expressed;
+	unsigned long long upcalls[NDN_UPCALL_CONTENT_RAW + 1];  /* by kind */
+	unsigned long long puts;
+	unsigned long long bytes_in;
+	unsigned long long bytes_out;
+	unsigned long long upcall_us, upcall_max_us;      /* holding the GIL */
+	unsigned long long gil_wait_us, gil_wait_max_us;
+
+	PyObject *py_report;            /* periodic callback, NULL if none */
+	long long report_period;        /* in ms */
+	long long next_report;          /* _pyndn_monotonic_ms() */
+
+	struct histogram callback_time; /* GIL held by an upcall */
+	struct histogram dispatch_time; /* socket readable to upcall */
+	long long ready;                /* set while run(0) dispatches */
+	struct hashtb *rtt;             /* name prefix -> struct rtt_entry */
+	struct ndn_indexbuf *rtt_comps; /* scratch for ndn_name_split() */
+	int rtt_components;             /* prefix length RTT is keyed by */
+
+	unsigned long long slow_threshold_us; /* 0 disables the tracer */
+	unsigned long long slow_count;
+	struct slow_upcall slow[HANDLE_STATS_SLOW_UPCALLS]; /* ring */
+
+	struct handle_timers *timers;   /* call_later() wheel, or NULL */
+};
+
+/*
+ * Closure capsules allocate this instead of a bare ndn_closure, so the RTT
+ * of an expressed interest can be measured when its Data comes back
+ */
+struct pyndn_closure {
+	struct ndn_closure closure;     /* has to be first */
+	struct histogram *rtt;          /* NULL for interest filters */
+	long long expressed;            /* _pyndn_monotonic_us(), 0 if done */
+};
+
+struct handle_stats *handle_stats_create(void);
+void handle_stats_destroy(struct handle_stats **stats);
+struct handle_stats *_pyndn_handle_get_stats(PyObject *py_handle);
+long long handle_stats_upcall_enter(struct ndn_closure *selfp,
+		enum ndn_upcall_kind upcall_kind, struct ndn_upcall_info *info,
+		PyGILState_STATE *gstate);
+void handle_stats_upcall_leave(struct handle_stats *stats, long long entered,
+		enum ndn_upcall_kind upcall_kind, struct ndn_upcall_info *info,
+		const char *type, PyGILState_STATE gstate);
+PyObject *handle_stats_snapshot(const struct handle_stats *stats);
+int handle_stats_set_report(struct handle_stats *stats, PyObject *py_report,
+		double period);
+void handle_stats_report(struct handle_stats *stats);
+struct histogram *handle_stats_rtt_histogram(struct handle_stats *stats,
+		const struct ndn_charbuf *name);
+PyObject *handle_stats_latency(struct handle_stats *stats);
+void handle_stats_latency_reset(struct handle_stats *stats);
+PyObject *handle_stats_slow_upcalls(const struct handle_stats *stats);
+
+static inline void
+handle_stats_expressed(struct handle_stats *stats)
+{
+	if (stats)
+		stats->interests_expressed++;
+}
+
+static inline void
+handle_stats_put(struct handle_stats *stats, size_t size)
+{
+	if (stats) {
+		stats->puts++;
+		stats->bytes_out += size;
+	}
+}
+
+#endif	/* STATS_H */
@@ -0,0 +1,278 @@
+/*
+ * Copyright (c) 2011, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ * Written by: Derek Kulinski <takeda@takeda.tk>
+ *             Jeff Burke <jburke@ucla.edu>
+ */
+
+/*
+ * timer_wheel.c - timers kept in a hierarchical timing wheel
+ *
+ * A timer expiring within TIMER_WHEEL_SLOTS ms goes into the level 0 slot
+ * of its exact tick, one expiring later into the slot of the first upper
+ * level whose range covers it. Whenever the tick counter crosses a multiple
+ * of a level's slot width, that level's current slot is emptied into the
+ * levels below (the same cascade the kernel timers used for years).
+ *
+ * A bitmap per level says which slots hold anything, so the next tick with
+ * work to do is found with a few rotates and ctz, and running the wheel
+ * after being idle skips straight to it instead of walking every tick.
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "timer_wheel.h"
+
+#define SLOT_MASK (TIMER_WHEEL_SLOTS - 1)
+#define LEVEL_SHIFT(level) (TIMER_WHEEL_BITS * (level))
+#define WHEEL_RANGE (1LL << LEVEL_SHIFT(TIMER_WHEEL_LEVELS))
+
+struct timer_wheel {
+	struct timer_entry *slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+	uint64_t occupied[TIMER_WHEEL_LEVELS]; /* bit per non-empty slot */
+	long long next;                 /* first tick not run yet */
+	size_t count;
+};
+
+static inline uint64_t
+rotate_right(uint64_t x, unsigned int n)
+{
+	n &= 63;
+	return n ? (x >> n) | (x << (64 - n)) : x;
+}
+
+static void
+slot_link(struct timer_wheel *w, struct timer_entry *e, int level, int slot)
+{
+	struct timer_entry **head = &w->slots[level][slot];
+
+	e->next = *head;
+	if (e->next)
+		e->next->pprev = &e->next;
+	*head = e;
+	e->pprev = head;
+	e->slot = level * TIMER_WHEEL_SLOTS + slot;
+
+	w->occupied[level] |= UINT64_C(1) << slot;
+}
+
+static void
+entry_unlink(struct timer_wheel *w, struct timer_entry *e)
+{
+	int level, slot;
+
+	*e->pprev = e->next;
+	if (e->next)
+		e->next->pprev = e->pprev;
+
+	if (e->slot >= 0) {
+		level = e->slot / TIMER_WHEEL_SLOTS;
+		slot = e->slot % TIMER_WHEEL_SLOTS;
+		if (!w->slots[level][slot])
+			w->occupied[level] &= ~(UINT64_C(1) << slot);
+	}
+
+	e->next = NULL;
+	e->pprev = NULL;
+}
+
+/* puts e into the slot for its expiry, relative to the next tick to run */
+static void
+place(struct timer_wheel *w, struct timer_entry *e)
+{
+	long long expires = e->expires, delta;
+	int level = 0;
+
+	delta = expires - w->next;
+	if (delta < 0) {
+		expires = w->next;
+		delta = 0;
+	} else if (delta >= WHEEL_RANGE) {
+		delta = WHEEL_RANGE - 1;
+		expires = w->next + delta;
+	}
+
+	while (delta >= 1LL << LEVEL_SHIFT(level + 1))
+		level++;
+
+	slot_link(w, e, level, (expires >> LEVEL_SHIFT(level)) & SLOT_MASK);
+}
+
+static void
+cascade(struct timer_wheel *w, int level, int slot)
+{
+	struct timer_entry *e, *next;
+
+	e = w->slots[level][slot];
+	w->slots[level][slot] = NULL;
+	w->occupied[level] &= ~(UINT64_C(1) << slot);
+
+	for (; e; e = next) {
+		next = e->next;
+		place(w, e);
+	}
+}
+
+struct timer_wheel *
+timer_wheel_create(long long now)
+{
+	struct timer_wheel *w;
+
+	w = calloc(1, sizeof(*w));
+	if (!w)
+		return NULL;
+
+	w->next = now;
+
+	return w;
+}
+
+/* pending timers get their action called with cancelled set */
+void
+timer_wheel_destroy(struct timer_wheel **wp)
+{
+	struct timer_wheel *w = *wp;
+	struct timer_entry *e;
+
+	if (!w)
+		return;
+
+	for (int level = 0; level < TIMER_WHEEL_LEVELS; level++)
+		for (int slot = 0; slot < TIMER_WHEEL_SLOTS; slot++)
+			while ((e = w->slots[level][slot])) {
+				entry_unlink(w, e);
+				e->wheel = NULL;
+				w->count--;
+				e->action(e, 1);
+			}
+
+	assert(!w->count);
+
+	free(w);
+	*wp = NULL;
+}
+
+size_t
+timer_wheel_count(const struct timer_wheel *w)
+{
+	return w->count;
+}
+
+void
+timer_wheel_add(struct timer_wheel *w, struct timer_entry *e,
+		long long expires)
+{
+	assert(e->action);
+
+	if (e->wheel)
+		timer_wheel_remove(e);
+
+	e->expires = expires;
+	e->wheel = w;
+	w->count++;
+
+	place(w, e);
+}
+
+void
+timer_wheel_remove(struct timer_entry *e)
+{
+	struct timer_wheel *w = e->wheel;
+
+	if (!w)
+		return;
+
+	entry_unlink(w, e);
+	e->wheel = NULL;
+	w->count--;
+}
+
+/*
+ * Tick the wheel has to be run at next, -1 when empty. It is exact for
+ * timers due within TIMER_WHEEL_SLOTS ms; for later ones it is when they
+ * are moved down a level, which is never after they expire.
+ */
+long long
+timer_wheel_next(const struct timer_wheel *w)
+{
+	long long best = -1, first, tick;
+	uint64_t pending;
+	int shift;
+
+	if (!w->count)
+		return -1;
+
+	pending = rotate_right(w->occupied[0], w->next & SLOT_MASK);
+	if (pending)
+		best = w->next + __builtin_ctzll(pending);
+
+	for (int level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+		shift = LEVEL_SHIFT(level);
+
+		/* first boundary of this level not crossed yet */
+		first = (w->next + (1LL << shift) - 1) >> shift;
+		pending = rotate_right(w->occupied[level], first & SLOT_MASK);
+		if (!pending)
+			continue;
+
+		tick = (first + __builtin_ctzll(pending)) << shift;
+		if (best < 0 || tick < best)
+			best = tick;
+	}
+
+	return best;
+}
+
+/*
+ * Fires every timer due at or before now, returns how many. Actions may
+ * add and remove timers, including ones due in the same tick.
+ */
+size_t
+timer_wheel_run(struct timer_wheel *w, long long now)
+{
+	struct timer_entry *work, *e;
+	long long tick;
+	size_t fired = 0;
+	int slot;
+
+	while (w->next <= now) {
+		tick = timer_wheel_next(w);
+		if (tick < 0 || tick > now) {
+			/* nothing happens in between */
+			w->next = now + 1;
+			break;
+		}
+		w->next = tick;
+
+		for (int level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+			if (tick & ((1LL << LEVEL_SHIFT(level)) - 1))
+				break;
+			cascade(w, level, (tick >> LEVEL_SHIFT(level)) & SLOT_MASK);
+		}
+
+		w->next = tick + 1;
+
+		slot = tick & SLOT_MASK;
+		work = w->slots[0][slot];
+		w->slots[0][slot] = NULL;
+		w->occupied[0] &= ~(UINT64_C(1) << slot);
+		if (!work)
+			continue;
+
+		work->pprev = &work;
+		for (e = work; e; e = e->next)
+			e->slot = -1;
+
+		while ((e = work)) {
+			entry_unlink(w, e);
+			e->wheel = NULL;
+			w->count--;
+			fired++;
+			e->action(e, 0);
+		}
+	}
+
+	return fired;
+}
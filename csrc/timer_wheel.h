@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2011, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ * Written by: Derek Kulinski <takeda@takeda.tk>
+ *             Jeff Burke <jburke@ucla.edu>
+ */
+
+#ifndef TIMER_WHEEL_H
+#  define	TIMER_WHEEL_H
+
+/*
+ * Hierarchical timer wheel with 1 ms ticks: TIMER_WHEEL_LEVELS levels of
+ * TIMER_WHEEL_SLOTS slots each, every level TIMER_WHEEL_SLOTS times coarser
+ * than the one below. Adding and removing a timer is O(1); timers on the
+ * upper levels are moved down when the level below wraps around. Timers
+ * further out than the whole wheel (about 4.6 hours) wait in its last slot
+ * and are placed again when they get there.
+ */
+#define TIMER_WHEEL_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_LEVELS 4
+
+struct timer_wheel;
+
+/*
+ * Embedded in whatever is timed. action is called once the timer expires,
+ * with cancelled set when the wheel is destroyed under it instead.
+ */
+struct timer_entry {
+	struct timer_entry *next, **pprev;
+	struct timer_wheel *wheel;      /* NULL when not pending */
+	long long expires;              /* in ms, same clock as the wheel */
+	int slot;                       /* -1 once taken out to fire */
+	void (*action)(struct timer_entry *e, int cancelled);
+};
+
+struct timer_wheel *timer_wheel_create(long long now);
+void timer_wheel_destroy(struct timer_wheel **w);
+size_t timer_wheel_count(const struct timer_wheel *w);
+void timer_wheel_add(struct timer_wheel *w, struct timer_entry *e,
+		long long expires);
+void timer_wheel_remove(struct timer_entry *e);
+long long timer_wheel_next(const struct timer_wheel *w);
+size_t timer_wheel_run(struct timer_wheel *w, long long now);
+
+#endif	/* TIMER_WHEEL_H */
@@ -14,6 +14,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <time.h>
 
 #include "pyndn.h"
 #include "util.h"
@@ -172,3 +173,28 @@ _pyndn_run_state_clear(void *handle)
 		return;
 	}
 }
+
+/*
+ * Milliseconds on a clock that doesn't jump with wall clock adjustments,
+ * for computing expiry times
+ */
+long long
+_pyndn_monotonic_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (long long) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* Same clock in microseconds, for measuring short intervals */
+long long
+_pyndn_monotonic_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (long long) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
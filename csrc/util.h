@@ -31,6 +31,8 @@ int _pyndn_close_file_handle(FILE *fh);
 void *_pyndn_run_state_add(struct ndn *handle);
 struct pyndn_run_state *_pyndn_run_state_find(struct ndn *handle);
 void _pyndn_run_state_clear(void *handle);
+long long _pyndn_monotonic_ms(void);
+long long _pyndn_monotonic_us(void);
 
 #  if DEBUG_MSG
 #    define debug(...) fprintf(stderr, __VA_ARGS__)
@@ -4,51 +4,20 @@
 # Written by: Derek Kulinski <takeda@takeda.tk>
 #
 
-import time
 import ndn
 
-class FlowController(ndn.Closure):
+class FlowController(object):
 	def __init__(self, prefix, handle):
 		self.prefix = ndn.Name(prefix)
 		self.handle = handle
-		self.content_objects = []
 
-		self.cleanup_time = 15 * 60 # keep responses for 15 min
-		handle.setInterestFilter(self.prefix, self)
+		# answered natively, keeps responses for 15 min
+		self.queue = ndn.ResponseQueue(handle, self.prefix, 15 * 60)
 
 	def put(self, co):
-		self.content_objects.append((time.time(), co))
-
-	def dispatch(self, interest, elem):
-		if time.time() - elem[0] > self.cleanup_time:
-			return False
-		elif elem[1].matchesInterest(interest):
-			self.handle.put(elem[1])
-			return False
-		return True
-
-	def upcall(self, kind, info):
-		if kind in [ndn.UPCALL_FINAL, ndn.UPCALL_CONSUMED_INTEREST]:
-			return ndn.RESULT_OK
-
-		if kind != ndn.UPCALL_INTEREST:
-			print("Got weird upcall kind: %d" % kind)
-			return ndn.RESULT_ERR
-
-		f = lambda elem: self.dispatch(info.Interest, elem)
-
-		new = []
-		consumed = False
-		for elem in self.content_objects:
-			if consumed or f(elem):
-				new.append(elem)
-				continue
-			consumed = True
-		self.content_objects = new
-
-		return ndn.RESULT_INTEREST_CONSUMED if consumed else ndn.RESULT_OK
-
-class VersionedPull(ndn.Closure):
+		self.queue.put(co)
+
+class VersionedPull(object):
 	def __init__(self, base_name, callback, handle=None, version=None, latest=True):
 		handle = handle or ndn.Face()
 
@@ -69,11 +38,9 @@ class VersionedPull(ndn.Closure):
 			self.start_with_latest = False
 
 		excl = ndn.ExclusionFilter()
-		excl.add_any()
-		excl.add_name(ndn.Name([self.latest_version]))
 		# expected result should be between those two names
-		excl.add_name(ndn.Name([self.last_version_marker]))
-		excl.add_any()
+		excl.exclude_before(self.latest_version)
+		excl.exclude_after(self.last_version_marker)
 
 		interest = ndn.Interest(name=self.base_name, exclude=excl, \
 			minSuffixComponents=3, maxSuffixComponents=3)
@@ -90,22 +57,28 @@ class VersionedPull(ndn.Closure):
 
 		return co
 
-	def requestNext(self, latest=False):
-		interest = self.build_interest(latest)
-		self.handle.expressInterest(interest.name, self, interest)
-
-	def upcall(self, kind, info):
-		if kind == ndn.UPCALL_FINAL:
-			return ndn.RESULT_OK
-
-		# update version
-		if kind in [ndn.UPCALL_CONTENT, ndn.UPCALL_CONTENT_UNVERIFIED]:
-			base_len = len(self.base_name)
-			self.latest_version = info.ContentObject.name[base_len]
+	def subscribe(self, in_flight=2, latest=False):
+		"""
+		Pushes every version after the latest one to the callback, the
+		interests are kept outstanding natively
+		"""
+		def on_data(base_name, co, kind):
+			self.latest_version = co.name[len(base_name)]
+			self.callback(kind, co)
+
+		after = None
+		if self.latest_version != self.first_version_marker:
+			after = self.latest_version
+		elif self.start_with_latest:
+			self.start_with_latest = False
+		else:
+			after = self.first_version_marker
 
-		self.callback(kind, info)
+		self.subscription = ndn.Subscription(self.handle, self.base_name,
+			on_data, in_flight, latest, after=after)
 
-		return ndn.RESULT_OK
+	def close(self):
+		self.subscription.close()
 
 if __name__ == '__main__':
 	from pyndn import _pyndn, Key, ContentObject
@@ -133,17 +106,16 @@ if __name__ == '__main__':
 		co.sign(key)
 		return co
 
-	def callback(kind, info):
-		print(info.ContentObject.content)
+	def callback(kind, co):
+		print(co.content)
 
 	fc = FlowController("/test", ndn.Face())
 	fc.put(publish('/test/1', 'one'))
 	fc.put(publish('/test/2', 'two'))
 	fc.put(publish('/test/3', 'three'))
 	vp = VersionedPull("/chat", callback)
+	vp.subscribe()
 	el = ndn.EventLoop(fc.handle, vp.handle)
 
 	while True:
-		vp.requestNext()
 		el.run_once()
-		time.sleep(1)
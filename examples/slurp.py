@@ -6,79 +6,45 @@
 
 import sys
 import ndn
+from ndn import Closure
 
-class Slurp(ndn.Closure):
-	def __init__(self, root, handle = None):
+class Slurp(object):
+	def __init__(self, root, handle = None, in_flight = 4):
 		self.root = ndn.Name(root)
-		self.exclusions = ndn.ExclusionFilter()
 		self.handle = handle or ndn.Face()
+		self.in_flight = in_flight
+		self.done = False
 
 	def start(self, timeout):
-		self.exclusions.reset()
-		self.express_my_interest()
-		self.handle.run(timeout)
+		self.handle.enumerateNamespace(self.root, self.on_name, self.on_done,
+			self.in_flight)
 
-	def express_my_interest(self):
-		templ = ndn.Interest(exclude = self.exclusions)
-		self.handle.expressInterest(self.root, self, templ)
+		while not self.done:
+			self.handle.run(timeout)
 
-	def upcall(self, kind, upcallInfo):
-		if kind == ndn.UPCALL_FINAL:
-			# any cleanup code here (so far I never had need for
-			# this call type)
-			return ndn.RESULT_OK
+	def on_name(self, name, data, kind):
+		if kind == Closure.UPCALL_CONTENT_BAD:
+			print("*** VERIFICATION FAILURE *** %s" % data.name)
 
-		if kind == ndn.UPCALL_INTEREST_TIMED_OUT:
-			print("Got timeout!")
-			return ndn.RESULT_OK
+		print("%s [%s]" % (name, \
+			"verified" if kind == Closure.UPCALL_CONTENT else "unverified"))
 
-		# make sure we're getting sane responses
-		if not kind in [ndn.UPCALL_CONTENT,
-						ndn.UPCALL_CONTENT_UNVERIFIED,
-						ndn.UPCALL_CONTENT_BAD]:
-			print("Received invalid kind type: %d" % kind)
-			sys.exit(100)
-
-		matched_comps = upcallInfo.matchedComps
-		response_name = upcallInfo.ContentObject.name
-		org_prefix = response_name[:matched_comps]
-
-		assert(org_prefix == self.root)
-
-		if matched_comps == len(response_name):
-			comp = ndn.Name([upcallInfo.ContentObject.digest()])
-			disp_name = ndn.Name(response_name)
-		else:
-			comp = response_name[matched_comps:matched_comps + 1]
-			disp_name = response_name[:matched_comps + 1]
-
-		if kind == ndn.UPCALL_CONTENT_BAD:
-			print("*** VERIFICATION FAILURE *** %s" % response_name)
-
-		print("%s [%s]" % (disp_name, \
-			"verified" if kind == ndn.UPCALL_CONTENT else "unverified"))
-
-		self.exclusions.add_name(comp)
-		self.express_my_interest()
-
-		# explore next level
-		if matched_comps + 1 < len(response_name):
-			new = Slurp(response_name[:matched_comps + 1], self.handle)
-			new.express_my_interest()
-
-		return ndn.RESULT_OK
+	def on_done(self, count):
+		print("Found %d names" % count)
+		self.done = True
 
 def usage():
-	print("Usage: %s <URI> <timeout>" % sys.argv[0])
+	print("Usage: %s <URI> <timeout> [interests in flight per level]" % sys.argv[0])
 	sys.exit(1)
 
 if __name__ == '__main__':
-	if (len(sys.argv) != 3):
+	if not len(sys.argv) in (3, 4):
 		usage()
 
 	root = sys.argv[1]
 	timeout = int(sys.argv[2])
+	in_flight = int(sys.argv[3]) if len(sys.argv) == 4 else 4
 
 	print("Scanning %s, timeout=%dms" % (root, timeout))
-	slurp = Slurp(root)
+	slurp = Slurp(root, in_flight = in_flight)
 	slurp.start(timeout)
@@ -0,0 +1,59 @@
+## -*- Mode: python; py-indent-offset: 4; indent-tabs-mode: nil; coding: utf-8; -*-
+#
+# Copyright (c) 2011-2013, Regents of the University of California
+# BSD license, See the COPYING file for more information
+# Written by: Derek Kulinski <takeda@takeda.tk>
+#             Jeff Burke <jburke@ucla.edu>
+#
+
+import _pyndn
+
+from Name import Name
+from Interest import Interest
+from Data import Data
+
+# File backed store of signed Data packets.
+#
+# Packets are appended to the file at path, <path>.idx keeps them sorted by
+# name. The index is written by flush() and when the archive is garbage
+# collected; packets appended after the last flush are indexed again the
+# next time the archive is opened, so a producer doesn't have to sign its
+# data again after a restart.
+class Archive (object):
+    def __init__ (self, path):
+        self.path = path
+        self.ndn_data = _pyndn.archive_open (path)
+
+    # data is a signed Data or its wire format
+    def append (self, data):
+        if isinstance (data, Data):
+            data = data.ndn_data
+        _pyndn.archive_append (self.ndn_data, data)
+
+    # Data satisfying the interest (or name), following its selectors
+    def get (self, interest):
+        if not isinstance (interest, Interest):
+            interest = Interest (name = Name (interest))
+        return _pyndn.archive_lookup (self.ndn_data, interest.ndn_data)
+
+    def flush (self):
+        _pyndn.archive_flush (self.ndn_data)
+
+    def stats (self):
+        return _pyndn.archive_info (self.ndn_data)
+
+    def __len__ (self):
+        return self.stats ()['count']
+
+    # Answers interests under prefix from the archive without calling into
+    # Python, until face.clearInterestFilter(prefix)
+    def serve (self, face, prefix):
+        if not isinstance (prefix, Name):
+            prefix = Name (prefix)
+
+        face._requireOwnHandle ("Archive.serve")
+        face._acquire_lock ("setInterestFilter")
+        try:
+            _pyndn.archive_serve (face.ndn_data, self.ndn_data, prefix.ndn_data)
+        finally:
+            face._release_lock ("setInterestFilter")
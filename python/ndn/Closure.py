@@ -90,51 +90,6 @@ class TrivialExpressClosure (Closure):
         # Always return RESULT_OK
         return RESULT_OK
 
-class VersionResolverClosure (Closure):
-    """
-    Need to be debugged
-    """
-
-    __slots__ = ["face", "onData", "onTimeout", "foundVersion"]
-
-    def __init__ (self, face, onData, onTimeout):
-        super (VersionResolverClosure, self).__init__ ()
-        
-        self.face = face
-        self.onData = onData
-        self.onTimeout = onTimeout
-        self.foundVersion = None
-
-    def upcall(self, kind, upcallInfo):
-        if (kind == UPCALL_CONTENT or
-            kind == UPCALL_CONTENT_UNVERIFIED or
-            kind == UPCALL_CONTENT_UNVERIFIED or
-            kind == UPCALL_CONTENT_KEYMISSING or
-            kind == UPCALL_CONTENT_RAW):
-            self._foundVersion = upcallInfo.Data
-
-            template = upcallInfo.Interest
-            template.exclude = Interest.ExclusionFilter ()
-            template.exclude.add_any ()
-
-            name = upcallInfo.Data.name
-            if len(upcallInfo.Interest.name) == len(name):
-                 return self.onData (upcallInfo.Interest, self._foundVersion)
-
-            comp = upcallInfo.Data.name[len(self._baseName)]
-            template.exclude.add_name (Name.Name ().append (comp))
-
-            self.face.expressInterest (upcallInfo.Interest.name, self, template)
-            return RESULT_OK
-
-        elif (kind == UPCALL_INTEREST_TIMED_OUT):
-            if self._foundVersion:
-                self.onData (upcallInfo.Interest, self._foundVersion)
-            else:
-                if self.onTimeout:
-                    self.onTimeout (upcallInfo.Interest)
-        return RESULT_OK
-
 class TrivialFilterClosure (Closure):
     __slots__ = ["_baseName", "_onInterest"];
 
@@ -14,6 +14,11 @@ from Name import Name
 from SignedInfo import SignedInfo
 from Signature import Signature
 
+# Values for Data.digestAlgorithm selecting a signature without a key pair,
+# for traffic that stays on the host or a trusted segment
+DIGEST_SHA256 = "2.16.840.1.101.3.4.2.1"   # integrity only, no key
+HMAC_SHA256 = "1.2.840.113549.2.9"         # secret shared with consumers
+
 class Data (object):
     def __init__ (self, name = None, content = None, signed_info = None):
         if isinstance (name, Name):
@@ -24,6 +29,9 @@ class Data (object):
         self.content = content
         self.signedInfo = signed_info or SignedInfo ()
 
+        # None signs with a Key, DIGEST_SHA256 or HMAC_SHA256 otherwise
+        self.digestAlgorithm = None
+
         # generated
         self.signature = None
 
@@ -32,16 +40,43 @@ class Data (object):
     # an NDN Face is not required to create the content object
     # thus there is no access to the ndn library keystore.
     #
-    def sign(self, key):
+    # With digestAlgorithm set to HMAC_SHA256 key is the shared secret
+    # (bytes), with DIGEST_SHA256 it's not used and may be None.
+    #
+    # With cache set, signing the same name, content and SignedInfo fields
+    # with the same key again returns the packet encoded the first time,
+    # timestamp included
+    def sign(self, key, cache = False):
         self.ndn_data = _pyndn.encode_Data (self, 
                                                    self.name.ndn_data,
                                                    self.content, 
-                                                   self.signedInfo.ndn_data, key)
+                                                   self.signedInfo.ndn_data, key,
+                                                   cache)
+
+    # Statistics of the signing cache; when budget (in bytes) is given it's
+    # set first, 0 disables the cache
+    @staticmethod
+    def signingCache (budget = None):
+        return _pyndn.signing_cache (budget)
         
     @staticmethod
     def fromWire (wire):
         return _pyndn.Data_obj_from_ndn_buffer (wire)
 
+    # Offsets into the wire buffer and the small header fields, without
+    # creating Name, SignedInfo or Signature objects (see _pyndn.DataHeader)
+    @staticmethod
+    def peek (wire):
+        return _pyndn.peek_data (wire)
+
+    # Decodes a buffer of concatenated Data packets, e.g. a log or repo
+    # file. Returns a list of Data (or of DataHeader with offsets into wire
+    # when objects is False) and how many bytes were used; a partial packet
+    # at the end is left for the next call.
+    @staticmethod
+    def fromWireStream (wire, objects = True, releaseGil = False):
+        return _pyndn.decode_data_stream (wire, objects, releaseGil)
+
     def toWire (self):
         """
         Convert Data packet to wire format
@@ -52,6 +87,7 @@ class Data (object):
 
     def __setattr__(self, name, value):
         if name != "ndn_data":
+            self._decode_lazy ()
             object.__setattr__ (self, 'ndn_data', None)
 
         if name == 'content':
@@ -79,13 +115,41 @@ class Data (object):
 
         return object.__getattribute__(self, name)
 
+    # Data decoded from the wire (Data_obj_from_ndn) doesn't carry
+    # signedInfo and signature until they're read, they are decoded from
+    # the offsets kept with ndn_data
+    def __getattr__(self, name):
+        if name == "signedInfo":
+            value = _pyndn.Data_signed_info (self.ndn_data)
+        elif name == "signature":
+            value = _pyndn.Data_signature (self.ndn_data)
+        else:
+            raise AttributeError (name)
+
+        object.__setattr__ (self, name, value)
+        return Const (value) if name == "signedInfo" else value
+
+    # the wire is about to be dropped, keep what can still be decoded from it
+    def _decode_lazy(self):
+        attrs = object.__getattribute__ (self, '__dict__')
+        if not attrs.get ('ndn_data'):
+            return
+
+        for name in ("signedInfo", "signature"):
+            if name not in attrs:
+                self.__getattr__ (name)
+
     def digest(self):
         return _pyndn.digest_contentobject(self.ndn_data)
 
     def verify_content(self, handle):
         return _pyndn.verify_content(handle.ndn_data, self.ndn_data)
 
+    # key is a Key, or the HMAC secret (None for DIGEST_SHA256) when the
+    # Data was signed without a key pair
     def verify_signature(self, key):
+        if key is None or isinstance (key, bytes):
+            return _pyndn.verify_symmetric(self.ndn_data, key)
         return _pyndn.verify_signature(self.ndn_data, key.ndn_data_public)
 
     def matchesInterest(self, interest):
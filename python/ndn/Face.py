@@ -10,26 +10,178 @@
 import _pyndn
 
 import Closure
-import Interest
 from Name import Name
+from Timer import Timer
+from Future import Future
 
+import os
 import threading
 
+class _Attachment (object):
+    """
+    Ties upcalls to a logical face, they are dropped once it disconnects
+    """
+    __slots__ = ["active"]
+
+    def __init__ (self):
+        self.active = True
+
+class _LogicalClosure (Closure.Closure):
+    __slots__ = ["_attachment", "_closure"]
+
+    def __init__ (self, attachment, closure):
+        super (_LogicalClosure, self).__init__ ()
+        self._attachment = attachment
+        self._closure = closure
+
+    def upcall (self, kind, upcallInfo):
+        if not self._attachment.active and kind != Closure.UPCALL_FINAL:
+            return Closure.RESULT_OK
+        return self._closure.upcall (kind, upcallInfo)
+
+class _FilterDemux (Closure.Closure):
+    """
+    The one filter a shared connection has for a prefix, handing interests
+    to the logical faces which set it, in order, until one consumes them
+    """
+    __slots__ = ["handlers"]
+
+    def __init__ (self):
+        super (_FilterDemux, self).__init__ ()
+        self.handlers = []   # (attachment, closure)
+
+    def upcall (self, kind, upcallInfo):
+        result = Closure.RESULT_OK
+        for attachment, closure in list (self.handlers):
+            if not attachment.active and kind != Closure.UPCALL_FINAL:
+                continue
+            result = closure.upcall (kind, upcallInfo)
+            if kind == Closure.UPCALL_INTEREST and result == Closure.RESULT_INTEREST_CONSUMED:
+                return result
+        if kind == Closure.UPCALL_INTEREST:
+            return Closure.RESULT_OK
+        return result
+
+class _Connection (object):
+    """
+    Daemon connection shared by the logical faces of a process
+    """
+
+    _pool = {}   # pid -> _Connection, a forked child gets its own
+    _pool_lock = threading.Lock ()
+
+    def __init__ (self):
+        self.ndn_data = _pyndn.create ()
+        _pyndn.connect (self.ndn_data)
+        self.lock = threading.Lock ()
+        self.faces = 0
+        self.filters = {}   # name URI -> _FilterDemux
+
+    @classmethod
+    def attach (cls):
+        cls._pool_lock.acquire ()
+        try:
+            connection = cls._pool.get (os.getpid ())
+            if connection is None:
+                connection = cls._pool[os.getpid ()] = _Connection ()
+            connection.faces += 1
+            return connection
+        finally:
+            cls._pool_lock.release ()
+
+    def detach (self, attachment):
+        attachment.active = False
+        for uri in self.filters.keys ():
+            self.clearInterestFilter (attachment, uri)
+
+        _Connection._pool_lock.acquire ()
+        try:
+            self.faces -= 1
+            if self.faces:
+                return
+            if _Connection._pool.get (os.getpid ()) is self:
+                del _Connection._pool[os.getpid ()]
+        finally:
+            _Connection._pool_lock.release ()
+
+        _pyndn.disconnect (self.ndn_data)
+
+    def setInterestFilter (self, attachment, name, closure, flags):
+        uri = str (name)
+        demux = self.filters.get (uri)
+        if demux is None:
+            demux = _FilterDemux ()
+            if flags is None:
+                _pyndn.set_interest_filter (self.ndn_data, name.ndn_data, demux)
+            else:
+                _pyndn.set_interest_filter (self.ndn_data, name.ndn_data, demux, flags)
+            self.filters[uri] = demux
+
+        # setting it again replaces this face's handler, as on a plain face
+        for i, (owner, _) in enumerate (demux.handlers):
+            if owner is attachment:
+                demux.handlers[i] = (attachment, closure)
+                break
+        else:
+            demux.handlers.append ((attachment, closure))
+        return 0
+
+    def clearInterestFilter (self, attachment, uri):
+        demux = self.filters.get (uri)
+        if demux is None:
+            return 0
+
+        demux.handlers = [h for h in demux.handlers if h[0] is not attachment]
+        if demux.handlers:
+            return 0
+
+        del self.filters[uri]
+        return _pyndn.clear_interest_filter (self.ndn_data, Name (uri).ndn_data)
+
 class Face (object):
     """
     Class that provides interface to connect to the underlying NDN daemon
+
+    A shared face is a logical one: all shared faces of a process use a
+    single connection, interest filters set on the same prefix by several
+    of them are demultiplexed in order and upcalls of interests it
+    expressed are dropped once it disconnects.  Statistics and timers are
+    per connection.  Native helpers registering with the library directly
+    (ResponseQueue, Subscription, Archive.serve, RepoUpload,
+    expressInterestForLatest, enumerateNamespace) need a face of their own.
     """
     
-    def __init__(self):
-        self._handle_lock = threading.Lock()
-        self.ndn_data = _pyndn.create()
+    def __init__(self, shared = False):
+        self._connection = None
+        self._attachment = None
+        if shared:
+            self._shared = True
+        else:
+            self._shared = False
+            self._handle_lock = threading.Lock()
+            self.ndn_data = _pyndn.create()
         self.connect ()
 
     def connect (self):
-        _pyndn.connect(self.ndn_data)
+        if not self._shared:
+            _pyndn.connect(self.ndn_data)
+        elif self._connection is None:
+            self._connection = _Connection.attach ()
+            self._attachment = _Attachment ()
+            self._handle_lock = self._connection.lock
+            self.ndn_data = self._connection.ndn_data
 
     def disconnect (self):
-        _pyndn.disconnect(self.ndn_data)
+        if not self._shared:
+            _pyndn.disconnect(self.ndn_data)
+        elif self._connection is not None:
+            self._acquire_lock ("disconnect")
+            try:
+                self._connection.detach (self._attachment)
+            finally:
+                self._release_lock ("disconnect")
+            self._connection = None
+            self.ndn_data = None
 
     def defer_verification (self, deferVerification = True):
                 _pyndn.defer_verification(self.ndn_data, 1 if deferVerification else 0)
@@ -46,6 +198,12 @@ class Face (object):
             self._handle_lock.release()
 #            print("%s: lock released" % tag)
 
+    def _requireOwnHandle (self, what):
+        # the library would hand such registrations the whole connection,
+        # past the demultiplexing and beyond disconnect ()
+        if self._shared:
+            raise ValueError ("%s needs a Face of its own, not a shared one" % what)
+
     def fileno(self):
         return _pyndn.get_connection_fd(self.ndn_data)
 
@@ -71,6 +229,8 @@ class Face (object):
     # Application-focused methods
     #
     def _expressInterest(self, name, closure, template = None):
+        if self._attachment is not None:
+            closure = _LogicalClosure (self._attachment, closure)
         self._acquire_lock("expressInterest")
         try:
             return _pyndn.express_interest(self, name, closure, template)
@@ -84,17 +244,93 @@ class Face (object):
                                Closure.TrivialExpressClosure (onData, onTimeout), 
                                template)
 
-    def expressInterestForLatest (self, name, onData, onTimeout = None, timeoutms = 1.0):
+    def expressInterestForLatest (self, name, onData, onTimeout = None, timeoutms = 1.0, cacheTtl = 0):
+        """
+        Find the latest version under name and deliver it with a single
+        onData (baseName, interest, data, kind) call
+
+        The walk over versions is done natively, by excluding every version
+        seen so far until an interest times out.  The result is cached for
+        cacheTtl seconds (0, the default, disables caching); a cache hit is
+        delivered from the loop all the same, with the interest the walk
+        would have started with.  If nothing is found, onTimeout
+        (baseName, interest) is called, returning Closure.RESULT_REEXPRESS
+        repeats the last probe.
+
+        Despite its name, timeoutms is the interest lifetime in seconds
+        """
+        if not isinstance (name, Name):
+            name = Name (name)
+
+        self._requireOwnHandle ("expressInterestForLatest")
+        self._acquire_lock ("expressInterestForLatest")
+        try:
+            cached = _pyndn.express_interest_for_latest (self, name, onData, onTimeout,
+                                                         timeoutms, cacheTtl)
+        finally:
+            self._release_lock ("expressInterestForLatest")
+
+        if cached:
+            data, kind, interest = cached
+            self.callLater (0, onData, name, interest, data, kind)
+
+    @staticmethod
+    def clearVersionCache (name = None):
+        """
+        Forget the cached latest version of name (or of every name)
+        """
+        if name is not None and not isinstance (name, Name):
+            name = Name (name)
+        _pyndn.clear_version_cache (name)
+
+    def enumerateNamespace (self, name, onName, onDone = None, inFlight = 4, interestLifetime = 1.0):
+        """
+        Walk the namespace under name breadth first
+
+        onName (name, data, kind) is called for every distinct name found,
+        with a Data packet that proved its existence; returning False stops
+        the walk from descending below that name.  At most inFlight interests
+        are outstanding per level.  onDone (count) is called when every
+        branch timed out.
+        """
         if not isinstance (name, Name):
             name = Name (name)
-        self.expressInterest (name,
-                              Closure.VersionResolverClosure (self, onData, onTimeout), 
-                              Interest.Interest (interestLifetime = timeoutms, 
-                                                 childSelector = Interest.CHILD_SELECTOR_LEFT))
+
+        self._requireOwnHandle ("enumerateNamespace")
+        self._acquire_lock ("enumerateNamespace")
+        try:
+            _pyndn.enumerate_namespace (self, name, onName, onDone, inFlight, interestLifetime)
+        finally:
+            self._release_lock ("enumerateNamespace")
+
+    def callLater (self, delay, callback, *args):
+        """
+        Call callback (*args) once, delay seconds from now, from the loop
+        running this face
+        """
+        self._acquire_lock ("callLater")
+        try:
+            return Timer (_pyndn.call_later (self, delay, callback, args))
+        finally:
+            self._release_lock ("callLater")
+
+    def callEvery (self, period, callback, *args):
+        """
+        Call callback (*args) every period seconds from the loop running
+        this face, until it returns False or the timer is cancelled.
+        Periods missed while the loop was busy are skipped
+        """
+        self._acquire_lock ("callEvery")
+        try:
+            return Timer (_pyndn.call_every (self, period, callback, args))
+        finally:
+            self._release_lock ("callEvery")
 
     def _setInterestFilter(self, name, closure, flags = None):
         self._acquire_lock("setInterestFilter")
         try:
+            if self._shared:
+                return self._connection.setInterestFilter (self._attachment, name, closure, flags)
             if flags is None:
                 return _pyndn.set_interest_filter(self.ndn_data, name.ndn_data, closure)
             else:
@@ -116,7 +352,9 @@ class Face (object):
 
         self._acquire_lock("setInterestFilter")
         try:
-                        return _pyndn.clear_interest_filter(self.ndn_data, name.ndn_data)
+            if self._shared:
+                return self._connection.clearInterestFilter (self._attachment, str (name))
+            return _pyndn.clear_interest_filter(self.ndn_data, name.ndn_data)
         finally:
             self._release_lock("setInterestFilter")
 
@@ -133,6 +371,18 @@ class Face (object):
         finally:
             self._release_lock("get")
 
+    def getAsync (self, name, template = None):
+        """
+        Express an interest for name and return a Future for its Data,
+        many of them can be waited on together with Future.wait ()
+        """
+        if not isinstance (name, Name):
+            name = Name (name)
+
+        future = Future (self)
+        self._expressInterest (name, future._closure (), template)
+        return future
+
     def put(self, contentObject):
         self._acquire_lock("put")
         try:
@@ -141,3 +391,26 @@ class Face (object):
             self._release_lock("put")
 
 
+    # Counters kept by the C handlers, see csrc/stats.h
+    def stats(self):
+        return _pyndn.stats(self.ndn_data)
+
+    # callback(stats) is called from the event loop every period seconds
+    def setStatsCallback(self, callback, period = 10.0):
+        _pyndn.set_stats_callback(self.ndn_data, callback, period)
+
+    # Histograms (in seconds) of interest RTT by name prefix, time upcalls
+    # hold the GIL and socket readiness to upcall dispatch
+    def latency(self, reset = False):
+        return _pyndn.latency(self.ndn_data, reset)
+
+    # RTT is keyed by the first rttPrefixComponents of expressed names;
+    # upcalls running longer than slowThreshold seconds are traced, 0
+    # disables the tracer
+    def setLatencyOptions(self, rttPrefixComponents = 2, slowThreshold = 0.1):
+        _pyndn.set_latency_options(self.ndn_data, rttPrefixComponents, slowThreshold)
+
+    # Most recent upcalls over the slow threshold, oldest first, as
+    # dictionaries with time, duration, kind, type (closure class) and name
+    def slowUpcalls(self):
+        return _pyndn.slow_upcalls(self.ndn_data)
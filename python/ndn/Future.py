@@ -0,0 +1,139 @@
+## -*- Mode: python; py-indent-offset: 4; indent-tabs-mode: nil; coding: utf-8; -*-
+#
+# Copyright (c) 2011, Regents of the University of California
+# BSD license, See the COPYING file for more information
+# Written by: Derek Kulinski <takeda@takeda.tk>
+#             Jeff Burke <jburke@ucla.edu>
+#
+
+import _pyndn
+
+import Closure
+
+import threading
+import time
+
+class _FutureClosure (Closure.Closure):
+    __slots__ = ["_future"]
+
+    def __init__ (self, future):
+        super (_FutureClosure, self).__init__ ()
+        self._future = future
+
+    def upcall (self, kind, upcallInfo):
+        if kind in (Closure.UPCALL_CONTENT,
+                    Closure.UPCALL_CONTENT_UNVERIFIED,
+                    Closure.UPCALL_CONTENT_KEYMISSING,
+                    Closure.UPCALL_CONTENT_RAW):
+            self._future._complete (kind, upcallInfo.Interest, upcallInfo.Data)
+        elif kind in (Closure.UPCALL_CONTENT_BAD,
+                      Closure.UPCALL_INTEREST_TIMED_OUT):
+            self._future._complete (kind, upcallInfo.Interest, None)
+
+        return Closure.RESULT_OK
+
+class Future (object):
+    """
+    Result of Face.getAsync (), completed from the face's upcalls
+
+    result () is the Data, or None when the interest timed out or the
+    Data failed verification (kind tells which).  Waiting runs the face
+    itself unless another thread already does; from inside an upcall use
+    addDoneCallback () instead.
+    """
+
+    def __init__ (self, face):
+        self._face = face
+        self._event = threading.Event ()
+        self._lock = threading.Lock ()   # guards _callbacks and the result
+        self._callbacks = []
+        self._runner = False   # wait () is running the face for us
+        self.kind = None
+        self.interest = None
+        self.data = None
+
+    def _closure (self):
+        return _FutureClosure (self)
+
+    def _complete (self, kind, interest, data):
+        self._lock.acquire ()
+        try:
+            if self._callbacks is None:
+                return
+
+            self.kind = kind
+            self.interest = interest
+            self.data = data
+            callbacks, self._callbacks = self._callbacks, None
+        finally:
+            self._lock.release ()
+
+        self._event.set ()
+
+        # let wait () see it now rather than at the end of its slice
+        if self._runner:
+            _pyndn.set_run_timeout (self._face.ndn_data, 0)
+
+        # outside the lock, a callback may well add another one
+        for callback in callbacks:
+            callback (self)
+
+    def done (self):
+        return self._event.is_set ()
+
+    def addDoneCallback (self, callback):
+        """
+        Call callback (future) once the result is known, right away if it
+        already is
+        """
+        self._lock.acquire ()
+        try:
+            if self._callbacks is not None:
+                self._callbacks.append (callback)
+                return
+        finally:
+            self._lock.release ()
+
+        callback (self)
+
+    def result (self, timeout = None):
+        """
+        Data, or None; also None if timeout seconds pass without a result
+        """
+        Future.wait ([self], timeout)
+        return self.data
+
+    @staticmethod
+    def wait (futures, timeout = None):
+        """
+        Wait until all futures are done or timeout seconds pass, returns
+        the list of those still pending
+        """
+        deadline = None if timeout is None else time.time () + timeout
+        pending = [f for f in futures if not f.done ()]
+
+        while pending:
+            remaining = 1.0
+            if deadline is not None:
+                remaining = min (remaining, deadline - time.time ())
+                if remaining <= 0:
+                    break
+
+            face = pending[0]._face
+            if not _pyndn.is_run_executing (face.ndn_data) and \
+                    face._handle_lock.acquire (False):
+                ours = [f for f in pending if f._face.ndn_data is face.ndn_data]
+                for future in ours:
+                    future._runner = True
+                try:
+                    _pyndn.run (face.ndn_data, int (remaining * 1000))
+                finally:
+                    for future in ours:
+                        future._runner = False
+                    face._handle_lock.release ()
+            else:
+                pending[0]._event.wait (remaining)
+
+            pending = [f for f in pending if not f.done ()]
+
+        return pending
@@ -33,6 +33,7 @@ class Interest(object):
         self.scope = scope
         self.interestLifetime = interestLifetime
         self.nonce = nonce
+        self._excludeVersion = None
 
     # @staticmethod
     # def fromWire (wire):
@@ -43,16 +44,32 @@ class Interest(object):
     def toWire (self):
         return _pyndn.dump_charbuf (self.ndn_data)
 
+    def compile (self):
+        """
+        Return read-only InterestTemplate with selectors of this interest
+
+        Name and nonce are not part of the template, they are supplied each
+        time the template is used in Face.expressInterest ()
+        """
+        return InterestTemplate (self)
+
     def __setattr__(self, name, value):
-        if name != "ndn_data":
+        if name != "ndn_data" and name != "_excludeVersion":
             object.__setattr__ (self, 'ndn_data', None)
 
         object.__setattr__ (self, name, value)
 
     def __getattribute__(self, name):
         if name == "ndn_data":
+            # exclude can be modified in place, re-encode if it changed since
+            exclude = object.__getattribute__ (self, 'exclude')
+            excludeVersion = exclude._version if exclude is not None else None
+            if excludeVersion != object.__getattribute__ (self, '_excludeVersion'):
+                object.__setattr__ (self, 'ndn_data', None)
+
             if not object.__getattribute__ (self, 'ndn_data'):
                 object.__setattr__ (self, 'ndn_data', _pyndn.Interest_obj_to_ndn (self))
+                object.__setattr__ (self, '_excludeVersion', excludeVersion)
         elif name == "name":
             return Const (object.__getattribute__ (self, name))
         # elif name == "exclude":
@@ -119,6 +136,26 @@ class Interest(object):
 
         return True
 
+class InterestTemplate (object):
+    """
+    Selectors of an Interest (lifetime, scope, childSelector, exclude, ...),
+    encoded once, so the same template can be used to express any number of
+    interests without re-encoding it
+    """
+    __slots__ = ['ndn_data']
+
+    def __init__ (self, interest):
+        object.__setattr__ (self, 'ndn_data', _pyndn.compile_interest_template (interest))
+
+    def __setattr__ (self, name, value):
+        raise TypeError ("InterestTemplate cannot be modified, compile a new one instead")
+
+    def toWire (self):
+        return _pyndn.dump_charbuf (self.ndn_data)
+
+    def __repr__ (self):
+        return "ndn.InterestTemplate(%r)" % _pyndn.Interest_obj_from_ndn (self.ndn_data)
+
 class AOKType(utils.Flag):
     _prefix = "ndn"
 
@@ -133,53 +170,124 @@ AOK_DEFAULT = AOK_CS | AOK_NEW
 CHILD_SELECTOR_LEFT = 0
 CHILD_SELECTOR_RIGHT = 1
 
-#
-#    //  IMPORTANT:  Exclusion component list must be sorted following "Canonical NDNx ordering"
-#    //              http://www.ndnx.org/releases/latest/doc/technical/CanonicalOrder.html
-#    //              in which shortest components go first.
-#
+class _Any (object):
+    """
+    Marks a range of excluded components in ExclusionFilter.components
+    """
+    def __repr__ (self):
+        return "<any>"
+
+    __str__ = __repr__
+
+class ExclusionFilter (object):
+    """
+    Set of name components excluded by an Interest
+
+    Components are kept in the "Canonical NDNx ordering" (shorter components
+    go first, components of the same length are compared byte by byte), so
+    they can be added in any order.  Bloom filters will be deprecated, so
+    they are not supported.
+    """
+    __slots__ = ['ndn_data', '_version']
+
+    ANY = _Any ()
+
+    def __init__ (self, names = None):
+        object.__setattr__ (self, 'ndn_data', _pyndn.exclusion_filter_new ())
+        object.__setattr__ (self, '_version', 0)
+
+        if names:
+            self.add_names (names)
+
+    def __setattr__ (self, name, value):
+        if name != "ndn_data":
+            raise AttributeError ("ExclusionFilter can only be modified with its methods")
+        object.__setattr__ (self, 'ndn_data', value)
+        self._modified ()
+
+    def _modified (self):
+        object.__setattr__ (self, '_version', self._version + 1)
+
+    def reset (self):
+        _pyndn.exclusion_filter_reset (self.ndn_data)
+        self._modified ()
+
+    def add_component (self, component):
+        """
+        Exclude a single name component (bytes)
+        """
+        self._modified ()
+        return _pyndn.exclusion_filter_add (self.ndn_data, component)
+
+    def add_name (self, name):
+        """
+        Exclude every component of the name
+
+        Exclusions work on a single level, so /forty/two excludes /forty and
+        /two
+        """
+        if not isinstance (name, Name):
+            name = Name (name)
+
+        for component in name.components:
+            self.add_component (component)
+
+    def add_names (self, names):
+        for name in names:
+            self.add_name (name)
+
+    def add_any (self):
+        """
+        Exclude everything after the last component (or everything at all,
+        if nothing has been added yet; use exclude_before () to exclude only
+        what sorts before a component)
+        """
+        self._modified ()
+        _pyndn.exclusion_filter_add_any (self.ndn_data)
+
+    def exclude_before (self, component):
+        """
+        Exclude the component and everything that sorts before it
+        """
+        self._modified ()
+        _pyndn.exclusion_filter_exclude_before (self.ndn_data, component)
+
+    def exclude_after (self, component):
+        """
+        Exclude the component and everything that sorts after it
+        """
+        self._modified ()
+        _pyndn.exclusion_filter_exclude_after (self.ndn_data, component)
+
+    def matches (self, component):
+        """
+        Check whether the component would be excluded
+        """
+        return _pyndn.exclusion_filter_matches (self.ndn_data, component)
+
+    @property
+    def components (self):
+        return [self.ANY if c is None else c
+                for c in _pyndn.exclusion_filter_components (self.ndn_data)]
+
+    @staticmethod
+    def fromWire (wire):
+        return _pyndn.ExclusionFilter_obj_from_ndn (bytes (wire))
+
+    def toWire (self):
+        return _pyndn.ExclusionFilter_to_ndn (self.ndn_data)
+
+    def __len__ (self):
+        return len (self.components)
+
+    def __eq__ (self, other):
+        return isinstance (other, ExclusionFilter) and self.toWire () == other.toWire ()
+
+    def __ne__ (self, other):
+        return not self.__eq__ (other)
+
+    def __str__ (self):
+        return str ([str (c) if c is self.ANY else str (Name ([c])) for c in self.components])
 
-# # Bloom filters will be deprecated, so we do not support them.
-# class ExclusionFilter(object):
-#     def __init__(self):
-#         self.components = []
-
-#         # py-ndn
-#         self.ndn_data_dirty = False
-#         self.ndn_data = None  # backing charbuf
-
-#     def reset(self):
-#         self.components = []
-
-#     def add_names(self, names):
-#         self.ndn_data_dirty = True
-#         self.components.extend(sorted(names))
-
-#     def add_name(self, name):
-#         if not type(name) is Name.Name:
-#             raise TypeError("Name type required")
-
-#         self.ndn_data_dirty = True
-#         self.components.append(name)
-
-#     def add_any(self):
-#         self.components.append(Name.Name(name_type = Name.NAME_ANY))
-
-#     def __setattr__(self, name, value):
-#         if name != "ndn_data_dirty":
-#             self.ndn_data_dirty = True
-#         object.__setattr__(self, name, value)
-
-#     def __getattribute__(self, name):
-#         if name == "ndn_data":
-#             if object.__getattribute__(self, 'ndn_data_dirty'):
-#                 self.ndn_data = _pyndn.ExclusionFilter_names_to_ndn(
-#                     self.components)
-#                 self.ndn_data_dirty = False
-#         return object.__getattribute__(self, name)
-
-#     def __str__(self):
-#         comps = []
-#         for n in self.components:
-#             comps.append(str(n))
-#         return str(comps)
+    def __repr__ (self):
+        return "ndn.ExclusionFilter(%s)" % self
@@ -29,13 +29,23 @@ class Key (object):
         key.fromPEM (filename, private, public, password)
         return key
 
+    # The keystore is read once and again only after the file changes
     @staticmethod
     def getDefault ():
         return _pyndn.get_default_key()
 
+    @staticmethod
+    def clearCache ():
+        _pyndn.clear_key_cache()
+
     def generateRSA(self, numbits):
         _pyndn.generate_RSA_key(self, numbits)
 
+    # ECDSA key, signs faster than RSA and gives much smaller signatures.
+    # The curve is an OpenSSL short name, prime256v1 is NIST P-256
+    def generateEC(self, curve = "prime256v1"):
+        _pyndn.generate_EC_key(self, curve)
+
     def privateToDER(self):
         if not self.ndn_data_private:
             raise _pyndn.NDNKeyError("Key is not private")
@@ -9,109 +9,136 @@
 # Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
 #
 
-from Face import *
-from Interest import *
-from Name import *
+from Face import Face
+from EventLoop import EventLoop
+from Name import Name
 import Closure
-import datetime
 import threading
-import time
-from apscheduler.scheduler import Scheduler
 import logging
 
 _LOG = logging.getLogger ("ndn.LocalPrefixDiscovery")
 
 class LocalPrefixDiscovery:
+    """
+    Keeps track of the routable prefix announced under /local/ndn/prefix
+
+    The prefix is asked for every periodicity seconds from a timer on the
+    face, and subscribers are called with (oldPrefix, newPrefix) only when
+    it changes.  An empty Name means no prefix is known.  Without a face
+    of its own, one is created and run from a single thread.
+    """
+
 #private:
-    __slots__ = ["_subscribers", "_currentPrefix", "_needStopDiscovery", 
-                 "_scheduler", "_timeouts", "_face", "_evenLoop", "_eventLoopThread",
-                 "_periodicity"]
-    
+    __slots__ = ["_subscribers", "_currentPrefix", "_running", "_timer",
+                 "_timeouts", "_face", "_ownFace", "_eventLoop",
+                 "_eventLoopThread", "_periodicity"]
+
+    _prefixName = Name ("/local/ndn/prefix")
+    _retries = 3
+
 # public:
-    def __init__ (self, periodicity = 30): # 30 seconds
+    def __init__ (self, periodicity = 30, face = None): # 30 seconds
         self._periodicity = periodicity
         self._subscribers = {}
         self._currentPrefix = Name ()
-        self._needStopDiscovery = True
-        self._scheduler = Scheduler ()
-        self._scheduler.start ()
+        self._running = False
+        self._timer = None
         self._timeouts = 0
-        self._face = Face ()
-        self._eventLoop = Face.EventLoop (self._face)
+        self._ownFace = face is None
+        self._face = face
+        self._eventLoop = None
+        self._eventLoopThread = None
+
+    @property
+    def prefix (self):
+        """
+        Last prefix discovered, an empty Name if there is none
+        """
+        return self._currentPrefix
 
     def subscribe (self, tag, callback):
         self._subscribers[tag] = callback
-        if (len (self._subscribers.values ()) == 1):
+        if len (self._subscribers) == 1:
             self._start ()
 
     def unsubscribe (self, tag):
         del self._subscribers[tag]
-        if (len (self._subscribers.values ()) == 0):
+        if len (self._subscribers) == 0:
             self._stop ()
 
     def shutdown (self):
+        self._subscribers = {}
         self._stop ()
-        self._scheduler.shutdown ()
 
 #private:
     def _start (self):
-        self._needStopDiscovery = False
-        self._eventLoopThread = threading.Thread (target = self._pyndn_loop_ignoring_errors)
-        self._eventLoopThread.start ()
-
-        nextDiscovery = datetime.datetime.now () + datetime.timedelta (seconds = 1)
-        self._scheduler.add_date_job(self._requestLocalPrefix, nextDiscovery)
+        if self._running:
+            return
+        self._running = True
+
+        if self._ownFace:
+            self._face = Face ()
+            self._eventLoop = EventLoop (self._face)
+            self._eventLoopThread = threading.Thread (target = self._eventLoop.run)
+            self._eventLoopThread.daemon = True
+            self._eventLoopThread.start ()
+            self._eventLoop.execute (self._scheduleRequest)
+        else:
+            self._scheduleRequest (0)
 
     def _stop (self):
-        self._needStopDiscovery = True
-        self._eventLoop.stop ()
-        self._eventLoopThread.join ()        
-
-    def _pyndn_loop_ignoring_errors (self):
-        while not self._needStopDiscovery:
-            try:
-                self._eventLoop.run ()
-            except:
-                if not self._needStopDiscovery:
-                    self._face.disconnect ()
-                    time.sleep (self._periodicity)
-                    self._face.connect ()
+        if not self._running:
+            return
+        self._running = False
+
+        if self._ownFace:
+            self._eventLoop.stop ()
+            self._eventLoopThread.join ()
+            self._eventLoop = None
+            self._eventLoopThread = None
+
+        if self._timer is not None:
+            self._timer.cancel ()
+            self._timer = None
+
+        if self._ownFace:
+            self._face = None
+
+    def _scheduleRequest (self, delay = 0):
+        if self._running:
+            self._timer = self._face.callLater (delay, self._requestLocalPrefix)
 
     def _requestLocalPrefix (self):
+        self._timer = None
         self._timeouts = 0
-        self._face.expressInterestForLatest (Name ("/local/ndn/prefix"),
-                                             self._onLocalPrefix, self._onTimeout)
+        # a cached answer would hide a prefix change
+        self._face.expressInterestForLatest (self._prefixName,
+                                             self._onLocalPrefix, self._onTimeout,
+                                             cacheTtl = 0)
+
+    def _update (self, name):
+        if name != self._currentPrefix:
+            oldPrefix = self._currentPrefix
+            self._currentPrefix = name
+            for subscriber in self._subscribers.values ():
+                subscriber (oldPrefix, name)
 
     def _onLocalPrefix (self, baseName, interest, data, kind):
         try:
-            name = Name (str (data.content).strip(' \t\n\r'))
-        except:
-            pass
-
-        if (name != self._currentPrefix):
-            for subscriber in self._subscribers.values ():
-                subscriber (self._currentPrefix, name)
-            self._currentPrefix = name
-
-        if not self._needStopDiscovery:
-            nextDiscovery = datetime.datetime.now () + datetime.timedelta (seconds = self._periodicity)
-            self._scheduler.add_date_job(self._requestLocalPrefix, nextDiscovery)
+            name = Name (str (data.content).strip (' \t\n\r'))
+        except Exception as e:
+            _LOG.warn ("Ignoring local prefix announcement: %s" % e)
+        else:
+            self._update (name)
 
+        self._scheduleRequest (self._periodicity)
         return Closure.RESULT_OK
 
     def _onTimeout (self, baseName, interest):
-        if self._timeouts < 3:
-            self._timeouts = self._timeouts + 1
+        if self._running and self._timeouts < self._retries:
+            self._timeouts += 1
             return Closure.RESULT_REEXPRESS
-        else:
-            # do stuff
-            name = Name ()
-            if (name != self._currentPrefix):
-                for subscriber in self._subscribers.values ():
-                    subscriber (self._currentPrefix, name)
-                self._currentPrefix = name
-            
-            if not self._needStopDiscovery:
-                nextDiscovery = datetime.datetime.now () + datetime.timedelta (seconds = self._periodicity)
-                self._scheduler.add_date_job(self._requestLocalPrefix, nextDiscovery)
-            return Closure.RESULT_OK
+
+        self._update (Name ())
+        self._scheduleRequest (self._periodicity)
+        return Closure.RESULT_OK
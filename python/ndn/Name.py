@@ -49,6 +49,18 @@ class Name (object):
         name.components = _pyndn.name_comps_from_ndn_buffer (bytes (wire))
         return name
 
+    @staticmethod
+    def _fromNdnData (ndn_data):
+        """
+        Create Name object backed by ndn_data only, which may be rewritten
+        in place (see NameCrypto.authenticate_command_into); components are
+        decoded from it whenever they are read
+        """
+        name = Name ()
+        object.__setattr__ (name, 'components', None)
+        object.__setattr__ (name, 'ndn_data', ndn_data)
+        return name
+
     def toWire (self):
         """
         Convert to wire representation
@@ -69,6 +81,12 @@ class Name (object):
             raise TypeError ("Only 'components' can be set explicitly updated")
 
     def __getattribute__(self, name):
+        if name == "components":
+            components = object.__getattribute__ (self, 'components')
+            if components is None:
+                return _pyndn.name_comps_from_ndn (object.__getattribute__ (self, 'ndn_data'))
+            return components
+
         if name == "ndn_data":
             if not object.__getattribute__ (self, 'ndn_data'):
                 object.__setattr__ (self, 'ndn_data', _pyndn.name_comps_to_ndn (self.components))
@@ -141,11 +159,17 @@ class Name (object):
         else:
             raise ValueError("Unknown __getitem__ type: %s" % type(key))
 
+    # assigned back, so ndn_data is rebuilt (and a name backed by ndn_data
+    # alone gets components of its own)
     def __setitem__(self, key, value):
-        self.components[key] = value
+        components = self.components
+        components[key] = value
+        self.components = components
 
     def __delitem__(self, key):
-        del self.components[key]
+        components = self.components
+        del components[key]
+        self.components = components
 
     def __len__(self):
         return len(self.components)
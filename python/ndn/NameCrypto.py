@@ -17,13 +17,35 @@ def generate_application_key(fixture_key, app_name):
 
 def authenticate_command(state, name, app_name, app_key):
 	signed_name = _pyndn.nc_authenticate_command(state, name.ndn_data, app_name, app_key)
-	return Name(ndn_data = signed_name)
+	return Name(_pyndn.name_comps_from_ndn(signed_name))
+
+# Name authenticate_command_into() writes to, reused for every command
+def new_command_buffer():
+	return Name._fromNdnData(_pyndn.name_comps_to_ndn([]))
+
+# Like authenticate_command(), without allocating; out, from
+# new_command_buffer(), is rewritten in place and returned, and can be
+# passed to Face.expressInterest() as it is.
+# Threads may share state but each needs its own out
+def authenticate_command_into(state, name, app_name, app_key, out):
+	_pyndn.nc_authenticate_command_into(state, name.ndn_data, app_name, app_key, out.ndn_data)
+	return out
 
 def authenticate_command_sig(state, name, app_name, key):
 	signed_name = _pyndn.nc_authenticate_command_sig(state, name.ndn_data, app_name, key.ndn_data_private)
-	return Name(ndn_data = signed_name)
+	return Name(_pyndn.name_comps_from_ndn(signed_name))
 
 def verify_command(state, name, max_time, **args):
 	if args.has_key('pub_key'): # TODO: use magic bytes to detect signature type, instead of asking caller to explicitly specify key type
 		args['pub_key'] = args['pub_key'].ndn_data_public
 	return _pyndn.nc_verify_command(state, name.ndn_data, max_time, **args)
+
+# window is how many of the latest sequence numbers are remembered per
+# application; commands arriving out of order within it are accepted
+def new_verifier(max_time, fixture_key = None, pub_key = None, window = 64):
+	if pub_key is not None:
+		pub_key = pub_key.ndn_data_public
+	return _pyndn.nc_new_verifier(max_time, fixture_key, pub_key, window)
+
+def verify_commands(verifier, names):
+	return _pyndn.nc_verify_batch(verifier, [name.ndn_data for name in names])
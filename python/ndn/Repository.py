@@ -1,60 +1,52 @@
-import Closure, Interest, Name
+import _pyndn
+import Name
 
-class RepoUpload(Closure.Closure):
-	def __init__(self, handle, name, content):
-		self.handle = handle
-		self.name = Name.Name(name)
-		self.content_objects = content
-
-	def start(self):
-		self.handle.setInterestFilter(self.name, self)
-
-		interest = Interest.Interest(
-			name = Name.Name(self.name))
-		interest.name += '\xC1.R.sw'
-		interest.name.appendNonce()
-
-		print("Expressing interest: ndn:%s" % interest.name)
-
-		self.handle.expressInterest(interest.name, self, interest)
-		self.handle.run(-1)
-
-	def dispatch_content(self, interest, elem):
-		if elem.matchesInterest(interest):
-			print("serving: %s" % elem.name)
-			self.handle.put(elem)
-			return True
-		return False
-
-	def handle_interest(self, matched_comps, interest):
-		f = lambda elem: self.dispatch_content(interest, elem)
+class RepoUpload(object):
+	"""
+	Uploads Data packets to a repository under name
 
-		print("Received interest for: %s" % interest.name)
-
-		consumed = False
-		for i, elem in enumerate(self.content_objects):
-			if f(elem):
-				self.content_objects.pop(i)
-				consumed = True
-				break
-
-		if len(self.content_objects) == 0:
-			self.handle.setRunTimeout(0)
-
-		return consumed
-
-	def upcall(self, kind, info):
-		if kind == Closure.UPCALL_FINAL:
-			return Closure.RESULT_OK
-
-		if kind == Closure.UPCALL_INTEREST:
-			if self.handle_interest(info.matchedComps, info.Interest):
-				return Closure.RESULT_INTEREST_CONSUMED
-			else:
-				return Closure.RESULT_OK
-
-		print("- - - - -")
-		print("kind: %d" % kind)
-		print("name: %s" % info.Interest.name)
-		return Closure.RESULT_OK
+	content may be any iterable of signed Data packets, including a
+	generator; at most window of them are pulled ahead of the repo's
+	interests.  Pending packets are indexed by name natively, so each
+	interest from the repo is answered with a binary search.
+	"""
 
+	def __init__(self, handle, name, content, window = 64, onDone = None):
+		self.handle = handle
+		self.name = Name.Name(name)
+		self.content = content
+		self.window = window
+		self.onDone = onDone
+		self.session = None
+
+	def start(self, run = True):
+		# the session holds on to this callback, so it must not reference
+		# self (there is nothing to break such a cycle)
+		handle, onDone = self.handle, self.onDone
+		def done(session):
+			if onDone:
+				onDone()
+			if run:
+				handle.setRunTimeout(0)
+
+		handle._requireOwnHandle("RepoUpload")
+		handle._acquire_lock("repoUpload")
+		try:
+			self.session = _pyndn.repo_upload_start(handle, self.name,
+				self.content, self.window, done)
+		finally:
+			handle._release_lock("repoUpload")
+
+		# an empty source finishes inside repo_upload_start(), before
+		# run() could be stopped
+		if run and not _pyndn.repo_upload_stats(self.session)["finished"]:
+			handle.run(-1)
+
+	def stats(self):
+		"""
+		Progress of the upload: served segments and bytes, what is still
+		pending, interests received and not matched, and rates
+		"""
+		if not self.session:
+			return None
+		return _pyndn.repo_upload_stats(self.session)
@@ -0,0 +1,57 @@
+## -*- Mode: python; py-indent-offset: 4; indent-tabs-mode: nil; coding: utf-8; -*-
+#
+# Copyright (c) 2011-2013, Regents of the University of California
+# BSD license, See the COPYING file for more information
+# Written by: Derek Kulinski <takeda@takeda.tk>
+#             Jeff Burke <jburke@ucla.edu>
+#
+
+import _pyndn
+import Name
+
+class ResponseQueue (object):
+    """
+    Data published ahead of the interests asking for it
+
+    The queue answers interests under prefix natively from the handle's
+    run loop, no Python code runs per interest.  Every Data packet is
+    served once, or dropped when its lifetime (seconds) is over.
+    """
+
+    def __init__ (self, handle, prefix, lifetime = 15 * 60):
+        self.handle = handle
+        self.prefix = Name.Name (prefix)
+
+        handle._requireOwnHandle ("ResponseQueue")
+        handle._acquire_lock ("responseQueue")
+        try:
+            self.session = _pyndn.response_queue_create (handle, self.prefix,
+                                                         lifetime)
+        finally:
+            handle._release_lock ("responseQueue")
+
+    def put (self, data, lifetime = -1):
+        """
+        Queues data until an interest asks for it, returns the queue depth
+        """
+        return _pyndn.response_queue_put (self.session, data, lifetime)
+
+    def __len__ (self):
+        return self.stats ()['pending']
+
+    def stats (self):
+        """
+        Pending Data packets and bytes, what was queued, served and expired,
+        interests received and not matched
+        """
+        return _pyndn.response_queue_stats (self.session)
+
+    def close (self):
+        """
+        Stops answering interests and drops what is pending
+        """
+        self.handle._acquire_lock ("responseQueue")
+        try:
+            _pyndn.response_queue_close (self.session)
+        finally:
+            self.handle._release_lock ("responseQueue")
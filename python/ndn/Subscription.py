@@ -0,0 +1,59 @@
+## -*- Mode: python; py-indent-offset: 4; indent-tabs-mode: nil; coding: utf-8; -*-
+#
+# Copyright (c) 2011-2013, Regents of the University of California
+# BSD license, See the COPYING file for more information
+# Written by: Derek Kulinski <takeda@takeda.tk>
+#             Jeff Burke <jburke@ucla.edu>
+#
+
+import _pyndn
+import Name
+
+class Subscription (object):
+    """
+    Every new version published under prefix, as it appears
+
+    inFlight interests for a version after the newest one seen are kept
+    outstanding; they are expressed again natively as soon as they come
+    back, and onData (prefix, data, kind) is only called for versions
+    not delivered before.  The subscription starts at the newest version,
+    or right after the version component given in after.  With latest set
+    versions published in between are skipped when a newer one exists.
+    """
+
+    def __init__ (self, handle, prefix, onData, inFlight = 2, latest = False,
+                  interestLifetime = 4.0, after = None):
+        self.handle = handle
+        self.prefix = Name.Name (prefix)
+
+        handle._requireOwnHandle ("Subscription")
+        handle._acquire_lock ("subscribe")
+        try:
+            self.session = _pyndn.subscribe (handle, self.prefix, onData,
+                                             inFlight, latest, interestLifetime, after)
+        finally:
+            handle._release_lock ("subscribe")
+
+    @property
+    def version (self):
+        """
+        Version component of the newest Data delivered, or None
+        """
+        return self.stats ()['version']
+
+    def stats (self):
+        """
+        Newest version, interests in flight and expressed, versions
+        delivered, duplicates dropped and timeouts
+        """
+        return _pyndn.subscription_stats (self.session)
+
+    def close (self):
+        """
+        Stops expressing interests, the ones out are left to expire
+        """
+        self.handle._acquire_lock ("subscribe")
+        try:
+            _pyndn.subscription_close (self.session)
+        finally:
+            self.handle._release_lock ("subscribe")
@@ -0,0 +1,34 @@
+## -*- Mode: python; py-indent-offset: 4; indent-tabs-mode: nil; coding: utf-8; -*-
+#
+# Copyright (c) 2011, Regents of the University of California
+# BSD license, See the COPYING file for more information
+# Written by: Derek Kulinski <takeda@takeda.tk>
+#             Jeff Burke <jburke@ucla.edu>
+#
+
+import _pyndn
+
+class Timer (object):
+    """
+    Callback scheduled with Face.callLater () or Face.callEvery ()
+
+    It runs from whatever runs the face (Face.run () or an EventLoop),
+    there is no thread behind it.
+    """
+
+    def __init__ (self, ndn_data):
+        self.ndn_data = ndn_data
+
+    def cancel (self):
+        _pyndn.timer_cancel (self.ndn_data)
+
+    @property
+    def pending (self):
+        return self.info ()['pending']
+
+    def info (self):
+        """
+        Whether it is pending, seconds remaining, period and how many
+        times it was called
+        """
+        return _pyndn.timer_info (self.ndn_data)
@@ -6,16 +6,21 @@
 #             Jeff Burke <jburke@ucla.edu>
 #
 
-__all__ = ['Face', 'Name', 'Interest', 'Data', 'Key']
+__all__ = ['Face', 'Name', 'Interest', 'Data', 'Key', 'Archive', 'ResponseQueue', 'Subscription', 'Timer', 'Future']
 
 VERSION = 0.4
 
 try:
     from Face import Face
     from Name import Name
-    from Interest import Interest
-    from Data import Data
+    from Interest import Interest, ExclusionFilter
+    from Data import Data, DIGEST_SHA256, HMAC_SHA256
     from Key import Key
+    from Archive import Archive
+    from ResponseQueue import ResponseQueue
+    from Subscription import Subscription
+    from Timer import Timer
+    from Future import Future
 
     from EventLoop import EventLoop
     from KeyLocator import KeyLocator
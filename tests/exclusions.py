@@ -1,22 +1,27 @@
-import pyndn
-from pyndn import _pyndn
+import ndn
 
-e = pyndn.ExclusionFilter()
+e = ndn.ExclusionFilter()
+e.add_names([ndn.Name('/one'), ndn.Name('/two'), ndn.Name('/three'), ndn.Name('/four')])
+e.exclude_before(b'one')
 e.add_any()
-e.add_names([pyndn.Name('/one'), pyndn.Name('/two'), pyndn.Name('/three'), pyndn.Name('/four')])
-e.add_any()
-e.add_name(pyndn.Name('/forty/two'))
+e.add_name(ndn.Name('/forty/two'))
 
 str(e)
-d = _pyndn.ExclusionFilter_obj_from_ndn(e.ndn_data)
+d = ndn.ExclusionFilter.fromWire(e.toWire())
 str(d)
 
 # I believe separation of /forty/two into /forty and /two is a correct behavior
 # since it doesn't make sense to have more than one level in exclusions
-result = ['<any>', '/one', '/two', '/four', '/three', '<any>', '/forty', '/two']
+#
+# Components are kept in the canonical order (shorter first), so /forty lands
+# before /three and the duplicated /two is only stored once
+result = ['<any>', '/one', '/two', '/four', '/forty', '/three', '<any>']
 
+assert len(d.components) == len(result)
 for a,b in zip(d.components, result):
-	if str(a) == b:
+	if a is ndn.ExclusionFilter.ANY and b == '<any>':
+		continue
+	elif str(ndn.Name([a])) == b:
 		continue
 	else:
 		raise AssertionError("%s != %s" % (str(a), b))
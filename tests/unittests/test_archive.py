@@ -0,0 +1,125 @@
+# -*- Mode:python; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+
+import os
+import shutil
+import struct
+import tempfile
+import unittest
+import ndn
+from ndn import Archive, Data, Interest, Key, KeyLocator, Name, SignedInfo
+
+class Basic(unittest.TestCase):
+
+    def setUp (self):
+        self.dir = tempfile.mkdtemp ()
+        self.path = os.path.join (self.dir, "archive")
+
+        self.key = Key ()
+        self.key.generateRSA (1024)
+
+    def tearDown (self):
+        shutil.rmtree (self.dir)
+
+    def data (self, name, content):
+        si = SignedInfo (self.key.publicKeyID, KeyLocator (self.key))
+        data = Data (Name (name), content, si)
+        data.sign (self.key)
+        return data
+
+    def fill (self, archive):
+        for version in ["%01", "%03", "%02"]:
+            archive.append (self.data ("/archive/test/" + version, version))
+
+    def test_lookup (self):
+        archive = Archive (self.path)
+        self.fill (archive)
+
+        self.assertEqual (len (archive), 3)
+        self.assertEqual (archive.get ("/archive/test").content, b"%01")
+        self.assertEqual (archive.get (Interest (name = Name ("/archive/test"),
+                                                 childSelector = 1)).content, b"%03")
+        self.assertEqual (archive.get ("/archive/test/%02").content, b"%02")
+        self.assertEqual (archive.get ("/archive/other"), None)
+
+    def test_append_many (self):
+        # no lookup in between, every append has to map what it wrote
+        archive = Archive (self.path)
+        for i in range (200):
+            archive.append (self.data ("/archive/many/%03d" % i, b"x" * 8000))
+
+        self.assertEqual (len (archive), 200)
+        self.assertEqual (archive.get ("/archive/many/199").content, b"x" * 8000)
+
+    def test_reopen (self):
+        archive = Archive (self.path)
+        self.fill (archive)
+        archive.flush ()
+        archive.append (self.data ("/archive/test/%04", b"%04"))
+        del archive
+
+        archive = Archive (self.path)
+        self.assertEqual (len (archive), 4)
+        self.assertEqual (archive.get (Interest (name = Name ("/archive/test"),
+                                                 childSelector = 1)).content, b"%04")
+
+    def test_recover (self):
+        archive = Archive (self.path)
+        self.fill (archive)
+        archive.flush ()
+        del archive
+
+        # unindexed packet followed by a partial one
+        wire = self.data ("/archive/test/%05", b"%05").toWire ()
+        with open (self.path, "ab") as f:
+            f.write (wire + wire[:20])
+
+        archive = Archive (self.path)
+        self.assertEqual (len (archive), 4)
+        self.assertEqual (archive.stats ()['bytes'], os.path.getsize (self.path))
+        self.assertEqual (archive.get ("/archive/test/%05").content, b"%05")
+
+    def test_invalid (self):
+        archive = Archive (self.path)
+        self.assertRaises (ndn._pyndn.NDNDataError, archive.append, b"garbage")
+        self.assertEqual (len (archive), 0)
+
+    def test_damaged_index (self):
+        archive = Archive (self.path)
+        self.fill (archive)
+        archive.flush ()
+        del archive
+
+        # point the first entry (after the 32 byte header) past the data
+        with open (self.path + ".idx", "r+b") as f:
+            f.seek (32)
+            f.write (struct.pack ("=Q", 1 << 40))
+
+        archive = Archive (self.path)
+        self.assertEqual (len (archive), 3)
+        self.assertEqual (archive.get ("/archive/test/%03").content, b"%03")
+
+    def test_unsorted_index (self):
+        archive = Archive (self.path)
+        self.fill (archive)
+        archive.flush ()
+        del archive
+
+        # swap the first two entries
+        with open (self.path + ".idx", "r+b") as f:
+            f.seek (32)
+            entries = f.read (32)
+            f.seek (32)
+            f.write (entries[16:] + entries[:16])
+
+        archive = Archive (self.path)
+        self.assertEqual (len (archive), 3)
+        self.assertEqual (archive.get ("/archive/test").content, b"%01")
+
+    def test_long_name (self):
+        archive = Archive (self.path)
+        self.assertRaises (ValueError, archive.append,
+                           self.data (Name (["x" * 70000]), b"x"))
+        self.assertEqual (len (archive), 0)
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,41 @@
+# -*- Mode:python; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+
+import unittest
+import ndn
+from ndn import Data, Key, KeyLocator, Name, SignedInfo
+
+class Basic(unittest.TestCase):
+
+    def setUp (self):
+        self.key = Key ()
+        self.key.generateRSA (1024)
+
+        si = SignedInfo (self.key.publicKeyID, KeyLocator (self.key),
+                         freshness = 10, final_block = b'\x00\x05')
+        data = Data (Name ("/hello/world"), b"payload", si)
+        data.sign (self.key)
+        self.wire = data.toWire ()
+
+    def test_lazy (self):
+        data = Data.fromWire (self.wire)
+
+        self.assertFalse ("signedInfo" in data.__dict__)
+        self.assertFalse ("signature" in data.__dict__)
+
+        self.assertEqual (data.signedInfo.freshnessSeconds, 10)
+        self.assertEqual (data.signedInfo.finalBlockID, b'\x00\x05')
+        self.assertEqual (data.signedInfo.publisherPublicKeyDigest,
+                          self.key.publicKeyID)
+        self.assertNotEqual (data.signature, None)
+        self.assertTrue (data.verify_signature (self.key))
+
+    def test_modified (self):
+        data = Data.fromWire (self.wire)
+        data.content = b"other"
+
+        # decoded before the wire was dropped
+        self.assertEqual (data.signedInfo.freshnessSeconds, 10)
+        self.assertNotEqual (data.signature, None)
+
+if __name__ == '__main__':
+    unittest.main()
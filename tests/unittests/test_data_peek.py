@@ -0,0 +1,66 @@
+# -*- Mode:python; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+
+import unittest
+import ndn
+from ndn import _pyndn, Data, Key, KeyLocator, Name, SignedInfo
+
+class Basic(unittest.TestCase):
+
+    def setUp (self):
+        self.key = Key ()
+        self.key.generateRSA (1024)
+
+    def encode (self, **kwargs):
+        si = SignedInfo (self.key.publicKeyID, KeyLocator (self.key), **kwargs)
+        data = Data (Name ("/hello/world/%00%01"), b"payload", si)
+        data.sign (self.key)
+        return data.toWire ()
+
+    def test_fields (self):
+        wire = self.encode (freshness = 5, final_block = b'\x00\x03')
+        header = Data.peek (wire)
+
+        self.assertEqual (header.size, len (wire))
+        self.assertEqual (header.name_components, 3)
+        self.assertEqual (Name.fromWire (wire[header.name_start:header.name_end]),
+                          Name ("/hello/world/%00%01"))
+        self.assertEqual (wire[header.content_start:header.content_end], b"payload")
+        self.assertEqual (header.type, ndn.CONTENT_DATA)
+        self.assertEqual (header.freshness, 5)
+        self.assertEqual (header.final_block_id, b'\x00\x03')
+
+    def test_optional (self):
+        header = Data.peek (bytearray (self.encode ()))
+
+        self.assertEqual (header.freshness, None)
+        self.assertEqual (header.final_block_id, None)
+
+    def test_readonly (self):
+        header = Data.peek (self.encode ())
+        self.assertRaises (AttributeError, setattr, header, "size", 0)
+
+    def test_invalid (self):
+        self.assertRaises (_pyndn.NDNDataError, Data.peek, b"garbage")
+        self.assertRaises (TypeError, Data.peek, 42)
+
+    def test_stream (self):
+        first = self.encode (freshness = 1)
+        second = self.encode (freshness = 2)
+        wire = first + second + second[:10]
+
+        datas, used = Data.fromWireStream (wire)
+        self.assertEqual (used, len (first) + len (second))
+        self.assertEqual ([d.signedInfo.freshnessSeconds for d in datas], [1, 2])
+        self.assertEqual (datas[1].content, b"payload")
+
+        headers, used = Data.fromWireStream (wire, objects = False, releaseGil = True)
+        self.assertEqual (used, len (first) + len (second))
+        self.assertEqual (headers[1].name_start - len (first), headers[0].name_start)
+        self.assertEqual (wire[headers[1].content_start:headers[1].content_end], b"payload")
+
+    def test_stream_invalid (self):
+        self.assertEqual (Data.fromWireStream (b""), ([], 0))
+        self.assertRaises (_pyndn.NDNDataError, Data.fromWireStream, b"\xff" * 16)
+
+if __name__ == '__main__':
+    unittest.main()
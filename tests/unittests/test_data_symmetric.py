@@ -0,0 +1,114 @@
+# -*- Mode:python; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+
+import unittest
+import ndn
+from ndn import Data, Name, SignedInfo
+
+# ndnb token header, value and type as in ndn_charbuf_append_tt ()
+def tt (value, kind):
+    head = bytearray ([0x80 | ((value & 0xf) << 3) | kind])
+    value >>= 4
+    while value:
+        head.insert (0, value & 0x7f)
+        value >>= 7
+    return bytes (head)
+
+NDN_DTAG, NDN_BLOB, NDN_UDATA = 2, 5, 6
+NDN_DTAG_DigestAlgorithm = 55
+
+class Basic(unittest.TestCase):
+
+    def make (self, alg, key):
+        data = Data (Name ("/local/sensor"), b"21.5",
+                     SignedInfo (b'\x00' * 32, freshness = 1))
+        data.digestAlgorithm = alg
+        data.sign (key)
+        return Data.fromWire (data.toWire ())
+
+    def test_digest (self):
+        data = self.make (ndn.DIGEST_SHA256, None)
+
+        self.assertEqual (data.digestAlgorithm, ndn.DIGEST_SHA256)
+        self.assertEqual (data.content, b"21.5")
+        self.assertTrue (data.verify_signature (None))
+
+    def test_hmac (self):
+        data = self.make (ndn.HMAC_SHA256, b"secret")
+
+        self.assertEqual (data.digestAlgorithm, ndn.HMAC_SHA256)
+        self.assertTrue (data.verify_signature (b"secret"))
+        self.assertFalse (data.verify_signature (b"other"))
+
+    def test_wire (self):
+        # DigestAlgorithm is UDATA, the way ndn_parse_ContentObject () wants it
+        for alg, key in ((ndn.DIGEST_SHA256, None), (ndn.HMAC_SHA256, b"secret")):
+            wire = self.make (alg, key).toWire ()
+            field = tt (NDN_DTAG_DigestAlgorithm, NDN_DTAG) + \
+                tt (len (alg), NDN_UDATA) + alg.encode ("ascii")
+
+            self.assertTrue (field in wire)
+            self.assertFalse (tt (len (alg), NDN_BLOB) + alg.encode ("ascii") in wire)
+
+            data = Data.fromWire (wire)
+            self.assertEqual (data.digestAlgorithm, alg)
+            self.assertEqual (data.signature.digestAlgorithm, alg)
+            self.assertEqual (type (data.signature.digestAlgorithm),
+                              type (data.digestAlgorithm))
+
+    def test_tampered (self):
+        wire = bytearray (self.make (ndn.HMAC_SHA256, b"secret").toWire ())
+        i = wire.find (b"21.5")
+        wire[i] = ord (b"3")
+
+        data = Data.fromWire (bytes (wire))
+        self.assertFalse (data.verify_signature (b"secret"))
+
+    def test_resign (self):
+        data = self.make (ndn.HMAC_SHA256, b"secret")
+        data.content = b"22.0"
+        data.sign (b"secret")
+
+        self.assertTrue (Data.fromWire (data.toWire ()).verify_signature (b"secret"))
+
+    def test_key_pair (self):
+        key = ndn.Key ()
+        key.generateRSA (1024)
+        signed = Data (Name ("/a"), b"x", SignedInfo (key.publicKeyID, ndn.KeyLocator (key)))
+        signed.sign (key)
+        self.assertRaises (ndn._pyndn.NDNSignatureError,
+                           Data.fromWire (signed.toWire ()).verify_signature, b"secret")
+
+    def test_key_pair_naming_sha256 (self):
+        # a public key signature may name SHA-256 as its digest as well
+        key = ndn.Key ()
+        key.generateRSA (1024)
+        signed = Data (Name ("/a"), b"x", SignedInfo (key.publicKeyID, ndn.KeyLocator (key)))
+        signed.sign (key)
+
+        wire = signed.toWire ()
+        head = tt (64, NDN_DTAG) + tt (37, NDN_DTAG)   # ContentObject, Signature
+        self.assertTrue (wire.startswith (head))
+        alg = ndn.DIGEST_SHA256.encode ("ascii")
+        wire = head + tt (NDN_DTAG_DigestAlgorithm, NDN_DTAG) + \
+            tt (len (alg), NDN_UDATA) + alg + b"\x00" + wire[len (head):]
+
+        data = Data.fromWire (wire)
+        self.assertEqual (data.signature.digestAlgorithm, ndn.DIGEST_SHA256)
+        self.assertEqual (data.digestAlgorithm, None)
+        self.assertTrue (data.verify_signature (key))
+        self.assertRaises (ndn._pyndn.NDNSignatureError, data.verify_signature, None)
+
+    def test_key_locator (self):
+        key = ndn.Key ()
+        key.generateRSA (1024)
+        data = Data (Name ("/a"), b"x", SignedInfo (key.publicKeyID, ndn.KeyLocator (key)))
+        data.digestAlgorithm = ndn.DIGEST_SHA256
+        self.assertRaises (ValueError, data.sign, None)
+
+    def test_unsupported (self):
+        data = Data (Name ("/a"), b"x", SignedInfo (b'\x00' * 32))
+        data.digestAlgorithm = "1.2.3"
+        self.assertRaises (NotImplementedError, data.sign, None)
+
+if __name__ == '__main__':
+    unittest.main()
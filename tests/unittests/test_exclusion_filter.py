@@ -0,0 +1,57 @@
+# -*- Mode:python; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+
+import unittest
+import ndn
+from ndn import _pyndn, Interest, Name, ExclusionFilter
+
+class Basic(unittest.TestCase):
+
+    def test_canonical_order (self):
+        e = ExclusionFilter ()
+        e.add_names ([Name ("/three"), Name ("/one"), Name ("/four"), Name ("/one")])
+
+        self.assertEqual (e.components, [b'one', b'four', b'three'])
+
+    def test_matches (self):
+        e = ExclusionFilter ()
+        e.add_component (b'b')
+        e.exclude_after (b'x')
+
+        self.assertTrue (e.matches (b'b'))
+        self.assertFalse (e.matches (b'c'))
+        self.assertTrue (e.matches (b'y'))
+        self.assertTrue (e.matches (b'long'))
+
+        e.exclude_before (b'c')
+        self.assertTrue (e.matches (b'a'))
+        self.assertEqual (e.components, [ExclusionFilter.ANY, b'c', b'x', ExclusionFilter.ANY])
+
+    def test_exclude_everything (self):
+        e = ExclusionFilter ()
+        e.add_any ()
+        self.assertTrue (e.matches (b'anything'))
+
+        # adding components can't narrow it down
+        e.add_component (b'b')
+        e.add_component (b'a')
+        e.add_component (b'c')
+        for component in [b'', b'a', b'aa', b'b', b'bb', b'c', b'long']:
+            self.assertTrue (e.matches (component))
+        self.assertEqual (e.components, [ExclusionFilter.ANY, b'a', ExclusionFilter.ANY,
+                                         b'b', ExclusionFilter.ANY, b'c', ExclusionFilter.ANY])
+
+    def test_interest_round_trip (self):
+        e = ExclusionFilter ()
+        e.exclude_before (b'two')
+
+        i = Interest (name = Name ("/a"), exclude = e)
+        i2 = _pyndn.Interest_obj_from_ndn (i.ndn_data)
+        self.assertEqual (i2.exclude, e)
+
+        # in place modification has to be picked up by the cached encoding
+        e.add_component (b'three')
+        i2 = _pyndn.Interest_obj_from_ndn (i.ndn_data)
+        self.assertEqual (i2.exclude.components, [ExclusionFilter.ANY, b'two', b'three'])
+
+if __name__ == '__main__':
+    unittest.main()
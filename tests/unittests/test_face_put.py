@@ -0,0 +1,29 @@
+# -*- Mode:python; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+
+import unittest
+import ndn
+from ndn import Face, Data, Name, Key, KeyLocator, SignedInfo
+
+class Basic(unittest.TestCase):
+
+    def test_put_stats (self):
+        face = Face ()
+        key = Key.getDefault ()
+        data = Data (Name ("/test/face/put"), b"x",
+                     SignedInfo (key.publicKeyID, KeyLocator (key)))
+        data.sign (key)
+
+        before = face.stats ()
+        face.put (data)
+        after = face.stats ()
+
+        self.assertEqual (after["puts"], before["puts"] + 1)
+        self.assertEqual (after["bytes_out"],
+                          before["bytes_out"] + len (data.toWire ()))
+
+    def test_not_a_face (self):
+        self.assertRaises (TypeError, ndn._pyndn.put, object (), None)
+        self.assertRaises (TypeError, ndn._pyndn.get, object (), Name ("/a"))
+
+if __name__ == '__main__':
+    unittest.main()
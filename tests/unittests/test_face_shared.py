@@ -0,0 +1,82 @@
+# -*- Mode:python; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+
+import unittest
+from ndn import Closure, Face, Archive, ResponseQueue, Subscription
+from ndn.Face import _Attachment, _FilterDemux, _LogicalClosure
+
+class Recorder(Closure.Closure):
+    def __init__ (self, log, tag, result = Closure.RESULT_OK):
+        super (Recorder, self).__init__ ()
+        self.log = log
+        self.tag = tag
+        self.result = result
+
+    def upcall (self, kind, upcallInfo):
+        self.log.append ((self.tag, kind))
+        return self.result
+
+class Basic(unittest.TestCase):
+
+    def test_filter_demux (self):
+        log = []
+        a, b, c = _Attachment (), _Attachment (), _Attachment ()
+        demux = _FilterDemux ()
+        demux.handlers.append ((a, Recorder (log, 'a')))
+        demux.handlers.append ((b, Recorder (log, 'b', Closure.RESULT_INTEREST_CONSUMED)))
+        demux.handlers.append ((c, Recorder (log, 'c')))
+
+        r = demux.upcall (Closure.UPCALL_INTEREST, None)
+        self.assertEqual (r, Closure.RESULT_INTEREST_CONSUMED)
+        self.assertEqual (log, [('a', Closure.UPCALL_INTEREST), ('b', Closure.UPCALL_INTEREST)])
+
+        # a disconnected face no longer sees interests
+        del log[:]
+        b.active = False
+        r = demux.upcall (Closure.UPCALL_INTEREST, None)
+        self.assertEqual (r, Closure.RESULT_OK)
+        self.assertEqual (log, [('a', Closure.UPCALL_INTEREST), ('c', Closure.UPCALL_INTEREST)])
+
+        # but everyone gets FINAL
+        del log[:]
+        demux.upcall (Closure.UPCALL_FINAL, None)
+        self.assertEqual ([tag for tag, kind in log], ['a', 'b', 'c'])
+
+    def test_logical_closure (self):
+        log = []
+        attachment = _Attachment ()
+        closure = _LogicalClosure (attachment, Recorder (log, 'x', Closure.RESULT_REEXPRESS))
+
+        self.assertEqual (closure.upcall (Closure.UPCALL_INTEREST_TIMED_OUT, None), Closure.RESULT_REEXPRESS)
+
+        attachment.active = False
+        self.assertEqual (closure.upcall (Closure.UPCALL_CONTENT, None), Closure.RESULT_OK)
+        closure.upcall (Closure.UPCALL_FINAL, None)
+        self.assertEqual (log, [('x', Closure.UPCALL_INTEREST_TIMED_OUT), ('x', Closure.UPCALL_FINAL)])
+
+    def test_native_helpers_refused (self):
+        # no daemon needed, refused before anything is registered
+        face = Face.__new__ (Face)
+        face._shared = True
+
+        self.assertRaises (ValueError, face.expressInterestForLatest, "/a", None)
+        self.assertRaises (ValueError, face.enumerateNamespace, "/a", None)
+        self.assertRaises (ValueError, ResponseQueue, face, "/a")
+        self.assertRaises (ValueError, Subscription, face, "/a", None)
+        self.assertRaises (ValueError, Archive.__new__ (Archive).serve, face, "/a")
+
+    # through a daemon
+    def test_disconnect (self):
+        a, b = Face (shared = True), Face (shared = True)
+        self.assertTrue (a.ndn_data is b.ndn_data)
+
+        a.disconnect ()
+        self.assertEqual (a.ndn_data, None)
+        self.assertTrue (b.ndn_data is not None)
+
+        a.connect ()
+        self.assertTrue (a.ndn_data is b.ndn_data)
+        a.disconnect ()
+        b.disconnect ()
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,110 @@
+# -*- Mode:python; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+
+import threading
+import unittest
+from ndn import Closure, Future, Face, EventLoop, Data, Name, Interest, Key, KeyLocator, SignedInfo
+
+class Basic(unittest.TestCase):
+
+    def test_complete (self):
+        future = Future (None)
+        closure = future._closure ()
+        seen = []
+        future.addDoneCallback (seen.append)
+        self.assertFalse (future.done ())
+
+        info = Closure.UpcallInfo ()
+        info.Interest = 'interest'
+        info.Data = 'data'
+        self.assertEqual (closure.upcall (Closure.UPCALL_CONTENT, info), Closure.RESULT_OK)
+
+        self.assertTrue (future.done ())
+        self.assertEqual (seen, [future])
+        self.assertEqual (future.result (), 'data')
+        self.assertEqual (future.kind, Closure.UPCALL_CONTENT)
+        self.assertEqual (Future.wait ([future], 0), [])
+
+        # later upcalls don't change the result
+        closure.upcall (Closure.UPCALL_INTEREST_TIMED_OUT, info)
+        self.assertEqual (future.result (), 'data')
+
+        # callbacks added afterwards run right away
+        future.addDoneCallback (seen.append)
+        self.assertEqual (seen, [future, future])
+
+    def test_timeout (self):
+        future = Future (None)
+        info = Closure.UpcallInfo ()
+        future._closure ().upcall (Closure.UPCALL_INTEREST_TIMED_OUT, info)
+
+        self.assertTrue (future.done ())
+        self.assertEqual (future.result (), None)
+        self.assertEqual (future.kind, Closure.UPCALL_INTEREST_TIMED_OUT)
+
+    def test_callbacks_race (self):
+        # callbacks added from other threads while the result comes in run
+        # exactly once, either from _complete () or from addDoneCallback ()
+        for attempt in range (20):
+            future = Future (None)
+            seen = []
+            start = threading.Event ()
+
+            def add (n):
+                start.wait ()
+                for i in range (n, n + 50):
+                    future.addDoneCallback (lambda f, i = i: seen.append (i))
+
+            threads = [threading.Thread (target = add, args = (n * 50,)) for n in range (4)]
+            for thread in threads:
+                thread.start ()
+            start.set ()
+            future._complete (Closure.UPCALL_CONTENT, None, 'data')
+            for thread in threads:
+                thread.join ()
+
+            self.assertEqual (sorted (seen), list (range (200)))
+
+    # through a daemon: getAsync () expresses the interest on the face and
+    # the future is completed from the face's own upcall
+    def test_get_async (self):
+        key = Key.getDefault ()
+        name = Name ("/test/future/get-async")
+
+        producer = Face ()
+        def onInterest (baseName, interest):
+            data = Data (interest.name, b"answer",
+                         SignedInfo (key.publicKeyID, KeyLocator (key)))
+            data.sign (key)
+            producer.put (data)
+        producer.setInterestFilter (name, onInterest)
+
+        loop = EventLoop (producer)
+        thread = threading.Thread (target = loop.run)
+        thread.daemon = True
+        thread.start ()
+
+        try:
+            consumer = Face ()
+            futures = [consumer.getAsync (name.append ("%d" % i)) for i in range (3)]
+            self.assertEqual (Future.wait (futures, 5), [])
+
+            for i, future in enumerate (futures):
+                self.assertEqual (future.kind, Closure.UPCALL_CONTENT)
+                self.assertEqual (future.result ().content, b"answer")
+                self.assertEqual (future.result ().name, name.append ("%d" % i))
+
+            self.assertEqual (consumer.stats ()["content"], 3)
+        finally:
+            loop.stop ()
+            thread.join ()
+
+    def test_get_async_timeout (self):
+        face = Face ()
+        future = face.getAsync (Name ("/test/future/nobody-answers"),
+                                Interest (interestLifetime = 0.2))
+
+        self.assertEqual (future.result (5), None)
+        self.assertEqual (future.kind, Closure.UPCALL_INTEREST_TIMED_OUT)
+
+if __name__ == '__main__':
+    unittest.main()
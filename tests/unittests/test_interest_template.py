@@ -0,0 +1,30 @@
+# -*- Mode:python; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+
+import unittest
+import ndn
+from ndn import _pyndn, Interest, Name
+
+class Basic(unittest.TestCase):
+
+    def test_compile (self):
+        i = Interest (name = Name ("/hello/world"),
+                      childSelector = 1,
+                      scope = 2,
+                      interestLifetime = 30.0,
+                      nonce = b'abababa')
+
+        t = i.compile ()
+        i2 = _pyndn.Interest_obj_from_ndn (t.ndn_data)
+
+        self.assertEqual (len (i2.name), 0)
+        self.assertEqual (i2.nonce, None)
+        self.assertEqual (i2.childSelector, i.childSelector)
+        self.assertEqual (i2.scope, i.scope)
+        self.assertEqual (i2.interestLifetime, i.interestLifetime)
+
+    def test_readonly (self):
+        t = Interest (scope = 1).compile ()
+        self.assertRaises (TypeError, setattr, t, "ndn_data", None)
+
+if __name__ == '__main__':
+    unittest.main()
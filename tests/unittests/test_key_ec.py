@@ -0,0 +1,58 @@
+# -*- Mode:python; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+
+import unittest
+import ndn
+from ndn import Data, Key, KeyLocator, Name, SignedInfo
+
+class Basic(unittest.TestCase):
+
+    def setUp (self):
+        self.key = Key ()
+        self.key.generateEC ()
+
+    def sign (self, key):
+        data = Data (Name ("/ec/test"), b"payload",
+                     SignedInfo (key.publicKeyID, KeyLocator (key)))
+        data.sign (key)
+        return Data.fromWire (data.toWire ())
+
+    def test_generate (self):
+        self.assertEqual (self.key.type, "EC")
+        self.assertEqual (len (self.key.publicKeyID), 32)
+
+    def test_sign (self):
+        data = self.sign (self.key)
+        self.assertTrue (data.verify_signature (self.key))
+
+        other = Key ()
+        other.generateEC ()
+        self.assertFalse (data.verify_signature (other))
+
+    def test_smaller (self):
+        rsa = Key ()
+        rsa.generateRSA (2048)
+
+        self.assertTrue (len (self.sign (self.key).signature.signatureBits) <
+                         len (self.sign (rsa).signature.signatureBits))
+
+    def test_der (self):
+        key = Key.createFromDER (private = self.key.privateToDER ())
+        self.assertEqual (key.publicKeyID, self.key.publicKeyID)
+        self.assertTrue (self.sign (key).verify_signature (self.key))
+
+        public = Key.createFromDER (public = self.key.publicToDER ())
+        self.assertEqual (public.publicKeyID, self.key.publicKeyID)
+        self.assertTrue (self.sign (self.key).verify_signature (public))
+
+    def test_pem (self):
+        key = Key.createFromPEM (private = self.key.privateToPEM ())
+        self.assertEqual (key.publicKeyID, self.key.publicKeyID)
+
+        public = Key.createFromPEM (public = self.key.publicToPEM ())
+        self.assertTrue (self.sign (key).verify_signature (public))
+
+    def test_bad_curve (self):
+        self.assertRaises (ValueError, Key ().generateEC, "no-such-curve")
+
+if __name__ == '__main__':
+    unittest.main()
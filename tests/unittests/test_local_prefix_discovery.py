@@ -0,0 +1,103 @@
+# -*- Mode:python; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+
+import unittest
+from ndn import Closure, Name, LocalPrefixDiscovery
+
+class FakeTimer(object):
+    def __init__ (self, delay, callback):
+        self.delay = delay
+        self.callback = callback
+        self.cancelled = False
+
+    def cancel (self):
+        self.cancelled = True
+
+class FakeFace(object):
+    """
+    Just what LocalPrefixDiscovery uses, with the timers and requests
+    kept for the test to fire
+    """
+    def __init__ (self):
+        self.timers = []
+        self.requests = []
+
+    def callLater (self, delay, callback, *args):
+        timer = FakeTimer (delay, lambda: callback (*args))
+        self.timers.append (timer)
+        return timer
+
+    def expressInterestForLatest (self, name, onData, onTimeout, **kwargs):
+        self.requests.append ((name, onData, onTimeout))
+
+    def fire (self):
+        timer = self.timers.pop (0)
+        while timer.cancelled:
+            timer = self.timers.pop (0)
+        timer.callback ()
+        return timer
+
+class Announcement(object):
+    def __init__ (self, content):
+        self.content = content
+
+class Basic(unittest.TestCase):
+
+    def setUp (self):
+        self.face = FakeFace ()
+        self.discovery = LocalPrefixDiscovery (periodicity = 30, face = self.face)
+        self.changes = []
+        self.discovery.subscribe ("test", lambda old, new: self.changes.append ((old, new)))
+
+    def answer (self, content):
+        name, onData, onTimeout = self.face.requests.pop (0)
+        self.assertEqual (name, Name ("/local/ndn/prefix"))
+        return onData (name, None, Announcement (content), Closure.UPCALL_CONTENT)
+
+    def timeout (self):
+        name, onData, onTimeout = self.face.requests[0]
+        return onTimeout (name, None)
+
+    def test_prefix_changes (self):
+        # the first request goes out right away
+        self.assertEqual (self.face.fire ().delay, 0)
+        self.answer ("/ucla/cs\n")
+        self.assertEqual (self.changes, [(Name (), Name ("/ucla/cs"))])
+        self.assertEqual (self.discovery.prefix, Name ("/ucla/cs"))
+
+        # asked again every periodicity seconds, subscribers only hear of changes
+        self.assertEqual (self.face.fire ().delay, 30)
+        self.answer ("/ucla/cs")
+        self.assertEqual (len (self.changes), 1)
+
+        self.face.fire ()
+        self.answer ("/ucla/ee")
+        self.assertEqual (self.changes[-1], (Name ("/ucla/cs"), Name ("/ucla/ee")))
+
+    def test_timeouts (self):
+        self.face.fire ()
+        self.answer ("/ucla/cs")
+        self.face.fire ()
+
+        # retried a few times before the prefix is given up
+        for i in range (LocalPrefixDiscovery._retries):
+            self.assertEqual (self.timeout (), Closure.RESULT_REEXPRESS)
+        self.assertEqual (self.timeout (), Closure.RESULT_OK)
+
+        self.assertEqual (self.changes[-1], (Name ("/ucla/cs"), Name ()))
+        self.assertEqual (self.discovery.prefix, Name ())
+        self.assertEqual (self.face.timers[-1].delay, 30)
+
+    def test_unsubscribe (self):
+        timer = self.face.timers[0]
+        self.discovery.unsubscribe ("test")
+        self.assertTrue (timer.cancelled)
+
+        # a request still out when stopped doesn't schedule another one
+        self.discovery.subscribe ("test", lambda old, new: None)
+        self.face.fire ()
+        self.discovery.shutdown ()
+        self.answer ("/ucla/cs")
+        self.assertEqual (self.face.timers, [])
+
+if __name__ == '__main__':
+    unittest.main()
@@ -1,6 +1,7 @@
 # -*- Mode:python; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
 
 import unittest
+import threading
 import ndn
 from ndn import Name, NameCrypto, Key, KeyLocator, Face
 
@@ -69,5 +70,109 @@ class Basic(unittest.TestCase):
         # ret = NameCrypto.verify_command(state3, name_from_js2, window, pub_key=keyLoc2.key)
         # self.assertTrue (ret)
 
+    def test_verify_batch (self):
+        secret = '1234567812345678'
+        app_key = NameCrypto.generate_application_key (secret, 'cuerda')
+
+        state = NameCrypto.new_state ()
+        name = Name ('/ndn/ucla.edu/apps/cuerda')
+        names = [NameCrypto.authenticate_command (state, name, 'cuerda', app_key)
+                 for i in range (5)]
+
+        verifier = NameCrypto.new_verifier (0, fixture_key = secret)
+        self.assertEqual (NameCrypto.verify_commands (verifier, names), [True] * 5)
+
+        # replayed commands are refused
+        self.assertEqual (NameCrypto.verify_commands (verifier, names[-1:]), [-6])
+
+        other = NameCrypto.new_verifier (0, fixture_key = 'another secret')
+        self.assertEqual (NameCrypto.verify_commands (other, names[:1]), [-2])
+        self.assertEqual (NameCrypto.verify_commands (other, [name]), [-1])
+
+    def test_verify_window (self):
+        secret = '1234567812345678'
+        apps = ['cuerda', 'luz']
+        name = Name ('/ndn/ucla.edu/apps/cuerda')
+
+        names = {}
+        for app in apps:
+            state = NameCrypto.new_state ()
+            app_key = NameCrypto.generate_application_key (secret, app)
+            names[app] = [NameCrypto.authenticate_command (state, name, app, app_key)
+                          for i in range (6)]
+
+        verifier = NameCrypto.new_verifier (0, fixture_key = secret, window = 4)
+
+        # reordered commands are fine, every app has its own window
+        for app in apps:
+            batch = [names[app][i] for i in (1, 3, 0, 2)]
+            self.assertEqual (NameCrypto.verify_commands (verifier, batch), [True] * 4)
+
+        # seen already, then too old for the window
+        batch = [names['luz'][2], names['luz'][5], names['luz'][1]]
+        self.assertEqual (NameCrypto.verify_commands (verifier, batch), [-6, True, -6])
+        self.assertEqual (NameCrypto.verify_commands (verifier, names['cuerda'][4:]), [True] * 2)
+
+        strict = NameCrypto.new_verifier (0, fixture_key = secret, window = 1)
+        batch = [names['luz'][1], names['luz'][0]]
+        self.assertEqual (NameCrypto.verify_commands (strict, batch), [True, -6])
+
+        self.assertRaises (ValueError, NameCrypto.new_verifier, 0, secret, None, 0)
+
+    def test_authenticate_into (self):
+        secret = '1234567812345678'
+        app_key = NameCrypto.generate_application_key (secret, 'cuerda')
+        name = Name ('/ndn/ucla.edu/apps/cuerda')
+
+        state = NameCrypto.new_state ()
+        out = NameCrypto.new_command_buffer ()
+        verifier = NameCrypto.new_verifier (0, fixture_key = secret)
+
+        # a Name, so Face takes it as it is
+        self.assertEqual (type (out), Name)
+
+        seen = []
+        for i in range (3):
+            signed = NameCrypto.authenticate_command_into (state, name, 'cuerda', app_key, out)
+            self.assertTrue (signed is out)
+            self.assertEqual (len (out), len (name) + 1)
+            self.assertTrue (name.isPrefixOf (out))
+            self.assertEqual (Name.fromWire (out.toWire ()), out)
+            self.assertEqual (NameCrypto.verify_commands (verifier, [out]), [True])
+            seen.append (str (out))
+
+        # rewritten every time
+        self.assertEqual (len (set (seen)), 3)
+
+        # a copy keeps its components
+        copied = Name (out)
+        NameCrypto.authenticate_command_into (state, name, 'cuerda', app_key, out)
+        self.assertNotEqual (copied, out)
+
+        self.assertRaises (ValueError, NameCrypto.authenticate_command_into,
+                           state, name, 'cuerda', app_key, name.ndn_data)
+
+    def test_shared_state (self):
+        secret = '1234567812345678'
+        app_key = NameCrypto.generate_application_key (secret, 'cuerda')
+        name = Name ('/ndn/ucla.edu/apps/cuerda')
+        state = NameCrypto.new_state ()
+        signed = []
+
+        def sender ():
+            names = [NameCrypto.authenticate_command (state, name, 'cuerda', app_key)
+                     for i in range (50)]
+            signed.extend (names)
+
+        threads = [threading.Thread (target = sender) for i in range (4)]
+        for t in threads:
+            t.start ()
+        for t in threads:
+            t.join ()
+
+        # every command got its own sequence number
+        verifier = NameCrypto.new_verifier (0, fixture_key = secret, window = 1024)
+        self.assertEqual (NameCrypto.verify_commands (verifier, signed), [True] * 200)
+
 if __name__ == '__main__':
     unittest.main()
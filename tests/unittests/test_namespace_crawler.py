@@ -0,0 +1,87 @@
+# -*- Mode:python; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+
+import random
+import time
+import unittest
+from ndn import Face, Data, Name, Key, KeyLocator, SignedInfo
+
+class Publisher(object):
+    def __init__ (self, prefix, suffixes):
+        self.face = Face ()
+        key = Key.getDefault ()
+        self.data = []
+        for suffix in suffixes:
+            data = Data (Name (str (prefix) + suffix), b"x",
+                         SignedInfo (key.publicKeyID, KeyLocator (key)))
+            data.sign (key)
+            self.data.append (data)
+        self.face.setInterestFilter (prefix, self.onInterest)
+
+    def onInterest (self, baseName, interest):
+        depth = len (interest.name)
+        for data in self.data:
+            if len (data.name) > depth and interest.name.isPrefixOf (data.name) and \
+                    (interest.exclude is None or not interest.exclude.matches (data.name[depth])):
+                self.face.put (data)
+                return
+
+class Basic(unittest.TestCase):
+
+    def setUp (self):
+        self.prefix = Name ("/test/crawler/%d" % random.getrandbits (32))
+        self.publisher = Publisher (self.prefix, ["/a/1", "/a/2", "/b", "/c/x/y"])
+        self.face = Face ()
+        self.found = []
+        self.done = []
+
+    def crawl (self, onName):
+        self.face.enumerateNamespace (self.prefix, onName, self.done.append,
+                                      inFlight = 2, interestLifetime = 0.3)
+
+        deadline = time.time () + 10
+        while not self.done and time.time () < deadline:
+            self.face.run (20)
+            self.publisher.face.run (20)
+
+        self.assertEqual (len (self.done), 1)
+
+    def names (self, *suffixes):
+        return [Name (str (self.prefix) + suffix) for suffix in suffixes]
+
+    def test_every_name (self):
+        proofs = []
+        def onName (name, data, kind):
+            self.found.append (name)
+            proofs.append (data.name)
+
+        self.crawl (onName)
+
+        # the Data handed over lies under the name it proves
+        for name, proof in zip (self.found, proofs):
+            self.assertTrue (name.isPrefixOf (proof))
+
+        # every name once, and never before the name above it
+        self.assertEqual (sorted (self.found),
+                          sorted (self.names ("/a", "/b", "/c", "/a/1", "/a/2", "/c/x", "/c/x/y")))
+        for i, name in enumerate (self.found):
+            if len (name) > len (self.prefix) + 1:
+                self.assertTrue (name[:-1] in self.found[:i])
+        self.assertEqual (self.done, [7])
+
+    def test_prune (self):
+        def onName (name, data, kind):
+            self.found.append (name)
+            return name != self.names ("/a")[0]
+
+        self.crawl (onName)
+
+        self.assertFalse (self.names ("/a/1")[0] in self.found)
+        self.assertEqual (sorted (self.found), sorted (self.names ("/a", "/b", "/c", "/c/x", "/c/x/y")))
+        self.assertEqual (self.done, [5])
+
+    def test_in_flight (self):
+        self.assertRaises (ValueError, self.face.enumerateNamespace, self.prefix,
+                           lambda name, data, kind: None, None, 0)
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,81 @@
+# -*- Mode:python; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+
+import threading
+import random
+import time
+import unittest
+from ndn import Closure, Face, EventLoop, Future, ResponseQueue, Data, Name, Key, KeyLocator, SignedInfo
+
+class Basic(unittest.TestCase):
+
+    def setUp (self):
+        self.prefix = Name ("/test/response-queue/%d" % random.getrandbits (32))
+        self.face = Face ()
+        self.queue = ResponseQueue (self.face, self.prefix)
+        self.key = Key.getDefault ()
+
+    def tearDown (self):
+        self.queue.close ()
+
+    def data (self, suffix, content = b"x"):
+        data = Data (self.prefix.append (suffix), content,
+                     SignedInfo (self.key.publicKeyID, KeyLocator (self.key)))
+        data.sign (self.key)
+        return data
+
+    def test_put (self):
+        self.assertEqual (self.queue.put (self.data ("a")), 1)
+        self.assertEqual (self.queue.put (self.data ("b")), 2)
+        self.assertEqual (len (self.queue), 2)
+
+        stats = self.queue.stats ()
+        self.assertEqual (stats["queued"], 2)
+        self.assertEqual (stats["served"], 0)
+        self.assertFalse (stats["closed"])
+
+        self.assertRaises (TypeError, self.queue.put, b"not a Data")
+
+    def test_serve_once (self):
+        self.queue.put (self.data ("a", b"first"))
+        self.queue.put (self.data ("b", b"second"))
+
+        loop = EventLoop (self.face)
+        thread = threading.Thread (target = loop.run)
+        thread.daemon = True
+        thread.start ()
+
+        try:
+            consumer = Face ()
+            future = consumer.getAsync (self.prefix.append ("a"))
+            self.assertEqual (Future.wait ([future], 5), [])
+            self.assertEqual (future.kind, Closure.UPCALL_CONTENT)
+            self.assertEqual (future.result ().content, b"first")
+        finally:
+            loop.stop ()
+            thread.join ()
+
+        # what was served is gone, the rest still waits
+        stats = self.queue.stats ()
+        self.assertEqual (stats["served"], 1)
+        self.assertEqual (stats["pending"], 1)
+        self.assertEqual (stats["bytes"], len (future.result ().toWire ()))
+
+    def test_lifetime (self):
+        self.queue.put (self.data ("short"), 0.05)
+        self.queue.put (self.data ("long"))
+        time.sleep (0.1)
+
+        stats = self.queue.stats ()
+        self.assertEqual (stats["expired"], 1)
+        self.assertEqual (stats["pending"], 1)
+
+    def test_close (self):
+        self.queue.put (self.data ("a"))
+        self.queue.close ()
+
+        self.assertEqual (len (self.queue), 0)
+        self.assertTrue (self.queue.stats ()["closed"])
+        self.assertRaises (ValueError, self.queue.put, self.data ("b"))
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,85 @@
+# -*- Mode:python; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+
+import time
+import unittest
+import ndn
+from ndn import Data, Key, KeyLocator, Name, SignedInfo
+
+class Basic(unittest.TestCase):
+
+    def setUp (self):
+        self.key = Key ()
+        self.key.generateRSA (1024)
+        Data.signingCache (1 << 20)
+
+    def tearDown (self):
+        Data.signingCache (4 << 20)
+
+    def make (self, content, freshness = 10, cache = True):
+        si = SignedInfo (self.key.publicKeyID, KeyLocator (self.key),
+                         freshness = freshness)
+        data = Data (Name ("/sensor/value"), content, si)
+        data.sign (self.key, cache = cache)
+        return data
+
+    def test_hit (self):
+        before = Data.signingCache ()
+
+        first = self.make (b"21.5")
+        second = self.make (b"21.5")
+
+        after = Data.signingCache ()
+        self.assertEqual (after["hits"] - before["hits"], 1)
+        self.assertEqual (first.toWire (), second.toWire ())
+        self.assertTrue (Data.fromWire (second.toWire ()).verify_signature (self.key))
+
+    def test_miss (self):
+        before = Data.signingCache ()
+
+        first = self.make (b"21.5")
+        self.make (b"21.6")
+        self.make (b"21.5", freshness = 20)
+
+        other = Key ()
+        other.generateRSA (1024)
+        first.sign (other, cache = True)
+
+        after = Data.signingCache ()
+        self.assertEqual (after["hits"], before["hits"])
+        self.assertEqual (after["misses"] - before["misses"], 4)
+
+    def test_bypass (self):
+        data = self.make (b"21.5")
+        before = Data.signingCache ()
+
+        data.sign (self.key, cache = False)
+        data.sign (self.key)
+
+        after = Data.signingCache ()
+        self.assertEqual (after["hits"], before["hits"])
+        self.assertEqual (after["misses"], before["misses"])
+
+    def test_off_by_default (self):
+        first = self.make (b"21.5", cache = False)
+        time.sleep (0.01)
+        second = self.make (b"21.5", cache = False)
+
+        # both signed now, each with the timestamp of its own SignedInfo
+        self.assertNotEqual (first.toWire (), second.toWire ())
+        self.assertNotEqual (Data.fromWire (first.toWire ()).signedInfo.timeStamp,
+                             Data.fromWire (second.toWire ()).signedInfo.timeStamp)
+
+    def test_budget (self):
+        self.make (b"21.5")
+        self.assertTrue (Data.signingCache ()["entries"] > 0)
+
+        stats = Data.signingCache (0)
+        self.assertEqual (stats["entries"], 0)
+        self.assertEqual (stats["bytes"], 0)
+
+        before = Data.signingCache ()
+        self.make (b"21.5")
+        self.assertEqual (Data.signingCache ()["hits"], before["hits"])
+
+if __name__ == '__main__':
+    unittest.main()
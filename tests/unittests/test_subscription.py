@@ -0,0 +1,86 @@
+# -*- Mode:python; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+
+import random
+import time
+import unittest
+from ndn import Face, Subscription, Data, Name, Key, KeyLocator, SignedInfo
+
+class Publisher(object):
+    def __init__ (self, prefix):
+        self.face = Face ()
+        self.key = Key.getDefault ()
+        self.prefix = prefix
+        self.data = []
+        self.face.setInterestFilter (prefix, self.onInterest)
+
+    def publish (self, version):
+        data = Data (self.prefix.appendVersion (version), b"x",
+                     SignedInfo (self.key.publicKeyID, KeyLocator (self.key)))
+        data.sign (self.key)
+        self.data.append (data)
+
+    def onInterest (self, baseName, interest):
+        versions = [data for data in self.data
+                    if interest.exclude is None or
+                    not interest.exclude.matches (data.name[len (baseName)])]
+        if versions:
+            self.face.put (versions[-1] if interest.childSelector == 1 else versions[0])
+
+class Basic(unittest.TestCase):
+
+    def setUp (self):
+        self.prefix = Name ("/test/subscription/%d" % random.getrandbits (32))
+        self.publisher = Publisher (self.prefix)
+        self.face = Face ()
+        self.received = []
+
+    def onData (self, prefix, data, kind):
+        self.assertEqual (prefix, self.prefix)
+        self.received.append (data.name)
+
+    def runUntil (self, count):
+        deadline = time.time () + 10
+        while len (self.received) < count and time.time () < deadline:
+            self.face.run (20)
+            self.publisher.face.run (20)
+
+    def test_versions_in_order (self):
+        self.publisher.publish (b'\x01')
+        self.publisher.publish (b'\x02')
+
+        sub = Subscription (self.face, self.prefix, self.onData, interestLifetime = 0.5)
+        try:
+            # starts at the newest version
+            self.runUntil (1)
+            self.assertEqual (self.received, [self.publisher.data[1].name])
+            self.assertEqual (sub.version, self.publisher.data[1].name[len (self.prefix)])
+
+            # then every later one, in order and only once
+            self.publisher.publish (b'\x03')
+            self.publisher.publish (b'\x04')
+            self.runUntil (3)
+            self.assertEqual (self.received, [data.name for data in self.publisher.data[1:]])
+
+            stats = sub.stats ()
+            self.assertEqual (stats["delivered"], 3)
+            self.assertTrue (stats["in_flight"] > 0)
+        finally:
+            sub.close ()
+
+        self.assertTrue (sub.stats ()["closed"])
+
+    def test_after (self):
+        for version in [b'\x01', b'\x02', b'\x03']:
+            self.publisher.publish (version)
+
+        after = self.publisher.data[0].name[len (self.prefix)]
+        sub = Subscription (self.face, self.prefix, self.onData, interestLifetime = 0.5,
+                            after = after)
+        try:
+            self.runUntil (2)
+            self.assertEqual (self.received, [data.name for data in self.publisher.data[1:]])
+        finally:
+            sub.close ()
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,70 @@
+# -*- Mode:python; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+
+import time
+import unittest
+from ndn import Face
+
+class Basic(unittest.TestCase):
+
+    def setUp (self):
+        self.face = Face ()
+        self.log = []
+
+    def runUntil (self, done, timeout = 5):
+        deadline = time.time () + timeout
+        while not done () and time.time () < deadline:
+            self.face.run (10)
+
+    def record (self, tag, due):
+        # the wheel ticks in milliseconds, allow for rounding
+        self.log.append ((tag, time.time () >= due - 0.002))
+
+    def test_call_later_order (self):
+        now = time.time ()
+        # 0.3 s is past the first level of the wheel, it has to cascade
+        for delay in [0.05, 0.3, 0.01, 0.03]:
+            self.face.callLater (delay, self.record, delay, now + delay)
+
+        self.runUntil (lambda: len (self.log) == 4)
+        self.assertEqual (self.log, [(0.01, True), (0.03, True), (0.05, True), (0.3, True)])
+
+    def test_cancel (self):
+        kept = self.face.callLater (0.02, self.record, "kept", 0)
+        dropped = self.face.callLater (0.01, self.record, "dropped", 0)
+        self.assertTrue (dropped.pending)
+        dropped.cancel ()
+        self.assertFalse (dropped.pending)
+
+        self.runUntil (lambda: not kept.pending)
+        self.face.run (50)
+        self.assertEqual (self.log, [("kept", True)])
+        self.assertEqual (kept.info ()["fired"], 1)
+        self.assertEqual (dropped.info ()["fired"], 0)
+
+    def test_info (self):
+        timer = self.face.callLater (10, self.record, "never", 0)
+        info = timer.info ()
+        self.assertTrue (info["pending"])
+        self.assertTrue (0 < info["remaining"] <= 10)
+        self.assertEqual (info["fired"], 0)
+        timer.cancel ()
+
+    def test_call_every (self):
+        count = []
+        def tick ():
+            count.append (time.time ())
+            return len (count) < 3
+
+        timer = self.face.callEvery (0.02, tick)
+        self.assertEqual (timer.info ()["period"], 0.02)
+
+        self.runUntil (lambda: not timer.pending)
+        self.face.run (100)
+
+        # stopped by returning False, not called again afterwards
+        self.assertEqual (len (count), 3)
+        self.assertEqual (timer.info ()["fired"], 3)
+        self.assertTrue (count[-1] - count[0] >= 0.04 - 0.005)
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,118 @@
+# -*- Mode:python; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+
+import unittest
+import random
+import time
+from ndn import Face, Data, Interest, Name, Key, KeyLocator, SignedInfo
+
+class Producer(object):
+    def __init__ (self, prefix, versions):
+        self.face = Face ()
+        self.key = Key.getDefault ()
+        self.prefix = prefix
+        self.data = []
+        self.interests = 0
+        for version in versions:
+            self.publish (version)
+        self.face.setInterestFilter (prefix, self.onInterest)
+
+    def publish (self, version):
+        data = Data (self.prefix.appendVersion (version), b"x",
+                     SignedInfo (self.key.publicKeyID, KeyLocator (self.key)))
+        data.sign (self.key)
+        self.data.append (data)
+
+    def onInterest (self, baseName, interest):
+        self.interests += 1
+        for data in reversed (self.data):
+            component = data.name[len (baseName)]
+            if interest.exclude is None or not interest.exclude.matches (component):
+                self.face.put (data)
+                return
+
+class Basic(unittest.TestCase):
+
+    def setUp (self):
+        self.prefix = Name ("/test/latest/%d" % random.getrandbits (32))
+        self.face = Face ()
+        self.log = []
+
+    def tearDown (self):
+        Face.clearVersionCache ()
+
+    def onData (self, name, interest, data, kind):
+        self.log.append (("data", name, interest, data))
+
+    def onTimeout (self, name, interest):
+        self.log.append (("timeout", name, interest))
+
+    def resolve (self, producer = None, **kwargs):
+        del self.log[:]
+        self.face.expressInterestForLatest (self.prefix, self.onData, self.onTimeout,
+                                            timeoutms = 0.2, **kwargs)
+        # never delivered from within the call, cache hit or not
+        self.assertEqual (self.log, [])
+
+        deadline = time.time () + 5
+        while not self.log and time.time () < deadline:
+            self.face.run (20)
+            if producer:
+                producer.face.run (20)
+
+        self.assertEqual (len (self.log), 1)
+        return self.log[0]
+
+    def test_latest (self):
+        producer = Producer (self.prefix, [b'\x01', b'\x02', b'\x03'])
+
+        what, name, interest, data = self.resolve (producer)
+        self.assertEqual (what, "data")
+        self.assertEqual (name, self.prefix)
+        self.assertEqual (data.name, producer.data[-1].name)
+        self.assertTrue (isinstance (interest, Interest))
+
+    def test_nothing_found (self):
+        what, name, interest = self.resolve ()
+        self.assertEqual (what, "timeout")
+        self.assertEqual (name, self.prefix)
+
+    def test_not_cached_by_default (self):
+        producer = Producer (self.prefix, [b'\x01'])
+        self.resolve (producer)
+
+        asked = producer.interests
+        what, name, interest, data = self.resolve (producer)
+        self.assertEqual (data.name, producer.data[-1].name)
+        self.assertTrue (producer.interests > asked)
+
+    def test_cache_hit (self):
+        producer = Producer (self.prefix, [b'\x01', b'\x02'])
+        self.resolve (producer, cacheTtl = 10)
+
+        asked = producer.interests
+        what, name, interest, data = self.resolve (producer, cacheTtl = 10)
+        self.assertEqual (what, "data")
+        self.assertEqual (data.name, producer.data[-1].name)
+        self.assertEqual (producer.interests, asked)
+
+        # the interest the walk would have started with
+        self.assertEqual (interest.name, self.prefix)
+        self.assertEqual (interest.childSelector, 1)
+        self.assertEqual (interest.exclude, None)
+
+        # dropping the entry makes the next request walk again
+        Face.clearVersionCache (self.prefix)
+        self.resolve (producer, cacheTtl = 10)
+        self.assertTrue (producer.interests > asked)
+
+    def test_stale_entry (self):
+        producer = Producer (self.prefix, [b'\x01'])
+        self.resolve (producer, cacheTtl = 0.05)
+        time.sleep (0.1)
+
+        producer.publish (b'\x02')
+        what, name, interest, data = self.resolve (producer, cacheTtl = 0.05)
+        self.assertEqual (data.name, producer.data[-1].name)
+
+if __name__ == '__main__':
+    unittest.main()